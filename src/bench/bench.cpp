@@ -0,0 +1,359 @@
+#include <external/FastNoiseLite.h>
+#include <render/vertex_cache.h>
+#include <render/frustum_cull.h>
+#include <terrain/terrain_generator.h>
+#include <terrain/mpmc_ring.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/*
+    ---------------
+    bench
+    ---------------
+    Headless timings of the CPU hot paths: no window, no GL context. Every
+    benchmark is run once to warm up and then `samples` times; the JSON on
+    stdout (or --out) lists, per benchmark, the sample statistics in a fixed
+    key order and number format so runs can be diffed and tracked over time.
+
+    Usage: bench [--samples N] [--threads 1,2,4] [--pipeline-radius R] [--out file.json]
+*/
+
+struct BenchResult {
+    std::string name;
+    std::string unit;
+    std::vector<double> samples;
+};
+
+struct BenchChunkResult {
+    int chunkX;
+    int chunkZ;
+    size_t vertexBytes;
+    size_t objects;
+};
+
+static std::vector<BenchResult> benchResults;
+static int benchSamples = 21;
+static int pipelineRadius = 4;
+
+// Chunk coordinates vary per sample, so no two samples read the same noise
+static int sampleChunkX(int sample) { return sample * 7 - 40; }
+static int sampleChunkZ(int sample) { return sample * 3 + 11; }
+
+/*
+    ---------------------------
+    runBenchmark
+    ---------------------------
+    Calls body(sample) once untimed and then benchSamples times. body returns
+    the number of operations it performed; a sample is the elapsed time
+    divided by it, in `scale` units per second (1e3 for ms, 1e9 for ns).
+*/
+
+void runBenchmark(const std::string& name, const std::string& unit, double scale, const std::function<double(int)>& body)
+{
+    body(-1);
+
+    BenchResult result;
+    result.name = name;
+    result.unit = unit;
+    for (int sample = 0; sample < benchSamples; ++sample) {
+        auto start = std::chrono::steady_clock::now();
+        double operations = body(sample);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.samples.push_back(seconds * scale / operations);
+    }
+
+    fprintf(stderr, "%-36s done\n", name.c_str());
+    benchResults.push_back(result);
+}
+
+/*
+    ---------------------------
+    runChunkPipeline
+    ---------------------------
+    The chunk workers' CPU work end to end: `threads` workers pop chunk
+    requests from one MpmcRing, build every LOD (regular or RTIN), the height
+    tile and the scattered objects, and push the results to a second ring that
+    this thread drains, as pollLoadedChunks does. Returns the chunk count.
+*/
+
+double runChunkPipeline(int threads, int sample, bool rtin)
+{
+    MpmcRing<glm::ivec2> requests(256);
+    MpmcRing<BenchChunkResult> results(256);
+    std::atomic<bool> requestsDone(false);
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.push_back(std::thread([&] {
+            while (true) {
+                glm::ivec2 chunk;
+                if (!requests.TryPop(chunk)) {
+                    if (requestsDone) return;
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                std::vector<ChunkData> lods = rtin ? buildRtinChunkLODs(chunk.x, chunk.y, nullptr)
+                                                   : buildChunkLODs(chunk.x, chunk.y);
+                HeightTile tile = buildChunkHeightTile(lods[0]);
+                std::vector<glm::mat4> turbines, solarPanels;
+                scatterChunkObjects(chunk.x, chunk.y, tile, turbines, solarPanels);
+
+                BenchChunkResult result = { chunk.x, chunk.y, 0, turbines.size() + solarPanels.size() };
+                for (const ChunkData& lod : lods) {
+                    result.vertexBytes += lod.vertices.size() * sizeof(TerrainVertex) + lod.indices.size() * sizeof(unsigned short);
+                }
+                while (!results.TryPush(std::move(result))) {
+                    std::this_thread::yield();
+                }
+            }
+        }));
+    }
+
+    const int side = 2 * pipelineRadius + 1;
+    const int chunkCount = side * side;
+    const int originX = sampleChunkX(sample);
+    const int originZ = sampleChunkZ(sample);
+
+    int requested = 0, received = 0;
+    while (received < chunkCount) {
+        while (requested < chunkCount) {
+            glm::ivec2 chunk(originX + requested % side, originZ + requested / side);
+            if (!requests.TryPush(std::move(chunk))) break;
+            requested++;
+        }
+        if (requested == chunkCount) requestsDone = true;
+
+        BenchChunkResult result;
+        if (results.TryPop(result)) {
+            received++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return chunkCount;
+}
+
+/*
+    ---------------------------
+    percentile
+    ---------------------------
+    Nearest-rank percentile of sorted samples; q = 0.5 averages the middle two
+    of an even count, which is the usual median.
+*/
+
+double percentile(const std::vector<double>& sorted, double q)
+{
+    if (q == 0.5 && sorted.size() % 2 == 0) {
+        return 0.5 * (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]);
+    }
+    size_t rank = static_cast<size_t>(std::ceil(q * sorted.size()));
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+void writeResults(FILE* out, unsigned int hardwareThreads)
+{
+    fprintf(out, "{\n");
+    fprintf(out, "  \"schema\": 1,\n");
+    fprintf(out, "  \"samples\": %d,\n", benchSamples);
+    fprintf(out, "  \"hardware_threads\": %u,\n", hardwareThreads);
+    fprintf(out, "  \"pipeline_chunks\": %d,\n", (2 * pipelineRadius + 1) * (2 * pipelineRadius + 1));
+    fprintf(out, "  \"benchmarks\": [\n");
+    for (size_t i = 0; i < benchResults.size(); ++i) {
+        std::vector<double> sorted = benchResults[i].samples;
+        std::sort(sorted.begin(), sorted.end());
+        double mean = 0.0;
+        for (double sample : sorted) mean += sample;
+        mean /= sorted.size();
+
+        fprintf(out, "    { \"name\": \"%s\", \"unit\": \"%s\", \"min\": %.4f, \"median\": %.4f, "
+                     "\"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f, \"mean\": %.4f }%s\n",
+                benchResults[i].name.c_str(), benchResults[i].unit.c_str(),
+                sorted.front(), percentile(sorted, 0.5), percentile(sorted, 0.9), percentile(sorted, 0.99),
+                sorted.back(), mean, i + 1 < benchResults.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n");
+    fprintf(out, "}\n");
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> threadCounts;
+    const char* outPath = nullptr;
+
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--samples") == 0) {
+            benchSamples = std::max(1, std::atoi(argv[i + 1]));
+        }
+        if (std::strcmp(argv[i], "--pipeline-radius") == 0) {
+            pipelineRadius = std::max(0, std::atoi(argv[i + 1]));
+        }
+        if (std::strcmp(argv[i], "--out") == 0) {
+            outPath = argv[i + 1];
+        }
+        if (std::strcmp(argv[i], "--threads") == 0) {
+            for (const char* list = argv[i + 1]; *list; ) {
+                threadCounts.push_back(std::max(1, std::atoi(list)));
+                const char* comma = std::strchr(list, ',');
+                if (!comma) break;
+                list = comma + 1;
+            }
+        }
+    }
+
+    // 1, 2, 4, ... and every hardware thread
+    if (threadCounts.empty()) {
+        for (unsigned int threads = 1; threads < hardwareThreads; threads *= 2) {
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(hardwareThreads);
+    }
+
+    for (int lod = 0; lod < NUM_TERRAIN_LODS; ++lod) {
+        unsigned int gridSize = TERRAIN_LOD_GRID_SIZES[lod];
+        float gridScale = GRID_SCALE * (static_cast<float>(GRID_SIZE) / gridSize);
+        runBenchmark("generate_terrain/lod" + std::to_string(lod), "ms", 1e3, [=](int sample) {
+            std::vector<unsigned int> indices;
+            std::vector<Vertex> vertices = generateTerrain(gridSize, gridScale, HEIGHT_SCALE, indices,
+                                                           sampleChunkX(sample), sampleChunkZ(sample));
+            return vertices.empty() ? 0.0 : 1.0;
+        });
+    }
+
+    const int POINT_QUERIES = 1 << 14;
+    float heightSink = 0.0f;
+    runBenchmark("get_terrain_height", "ns", 1e9, [&](int sample) {
+        for (int i = 0; i < POINT_QUERIES; ++i) {
+            heightSink += getTerrainHeight((i % 128) * 0.73f + sample * 100.0f, (i / 128) * 0.61f - sample * 50.0f);
+        }
+        return static_cast<double>(POINT_QUERIES);
+    });
+
+    FastNoiseLite noise;
+    configureTerrainNoise(noise);
+    const int NOISE_SAMPLES = 1 << 16;
+    float noiseSink = 0.0f;
+    runBenchmark("noise_sample/runtime", "ns", 1e9, [&](int sample) {
+        for (int i = 0; i < NOISE_SAMPLES; ++i) {
+            noiseSink += noise.GetNoise((i % 256) * 0.37f + sample, (i / 256) * 0.29f - sample);
+        }
+        return static_cast<double>(NOISE_SAMPLES);
+    });
+    runBenchmark("noise_sample/fixed", "ns", 1e9, [&](int sample) {
+        for (int i = 0; i < NOISE_SAMPLES; ++i) {
+            noiseSink += noise.GetNoiseFixed<TERRAIN_NOISE_TYPE, TERRAIN_FRACTAL_TYPE, TERRAIN_NOISE_OCTAVES>(
+                (i % 256) * 0.37f + sample, (i / 256) * 0.29f - sample);
+        }
+        return static_cast<double>(NOISE_SAMPLES);
+    });
+
+    // One padded LOD0 row block per call, as sampleTerrainHeights evaluates it
+    const int GRID = 104;
+    std::vector<float> axisX(GRID), axisZ(GRID), grid(GRID * GRID);
+    runBenchmark("noise_sample/grid_fixed", "ns", 1e9, [&](int sample) {
+        for (int i = 0; i < GRID; ++i) {
+            axisX[i] = i * TERRAIN_NOISE_SCALES[0] + sample;
+            axisZ[i] = i * TERRAIN_NOISE_SCALES[0] - sample;
+        }
+        noise.GetNoiseGridFixed<TERRAIN_NOISE_TYPE, TERRAIN_FRACTAL_TYPE, TERRAIN_NOISE_OCTAVES>(
+            axisX.data(), GRID, axisZ.data(), GRID, grid.data(), 1, GRID);
+        noiseSink += grid[sample & 63];
+        return static_cast<double>(GRID * GRID);
+    });
+
+    // What createTerrainIndexBuffers does per LOD, minus the upload
+    for (int lod = 0; lod < NUM_TERRAIN_LODS; ++lod) {
+        unsigned int gridSize = TERRAIN_LOD_GRID_SIZES[lod];
+        runBenchmark("index_build/lod" + std::to_string(lod), "ms", 1e3, [=](int) {
+            std::vector<unsigned int> indices = buildTerrainIndices(gridSize);
+            OptimizeVertexCache(indices, (gridSize + 1) * (gridSize + 1));
+            return indices.empty() ? 0.0 : 1.0;
+        });
+    }
+
+    // One frame of cullScene's tests over CULL_OBJECTS bounds spread across
+    // the chunk window, seen by the app's camera; a sample is one full pass
+    const int CULL_OBJECTS = 10000;
+    const float cullExtent = 21 * GRID_SIZE * GRID_SCALE;
+    CullSphereList cullSpheres;
+    CullBoxList cullBoxes;
+    for (int i = 0; i < CULL_OBJECTS; ++i) {
+        float x = (i % 100) * cullExtent / 100.0f - cullExtent * 0.5f;
+        float z = (i / 100) * cullExtent / 100.0f - cullExtent * 0.5f;
+        float y = getTerrainHeight(x, z);
+        cullSpheres.x.push_back(x);
+        cullSpheres.y.push_back(y);
+        cullSpheres.z.push_back(z);
+        cullSpheres.radius.push_back(60.0f);
+        cullBoxes.minX.push_back(x);
+        cullBoxes.minY.push_back(TERRAIN_HEIGHT_MIN);
+        cullBoxes.minZ.push_back(z);
+        cullBoxes.maxX.push_back(x + GRID_SIZE * GRID_SCALE);
+        cullBoxes.maxY.push_back(y);
+        cullBoxes.maxZ.push_back(z + GRID_SIZE * GRID_SCALE);
+    }
+    std::vector<unsigned int> visible;
+    size_t visibleSink = 0;
+    auto cullFrustum = [](int sample) {
+        float yaw = sample * 0.3f;
+        glm::vec3 eye(0.0f, 50.0f, 0.0f);
+        glm::mat4 view = glm::lookAt(eye, eye + glm::vec3(std::cos(yaw), -0.1f, std::sin(yaw)), glm::vec3(0, 1, 0));
+        return ExtractFrustum(glm::perspective(glm::radians(45.0f), 1024.0f / 768.0f, 0.1f, 3000.0f) * view);
+    };
+    runBenchmark("frustum_cull/spheres_10k", "ms", 1e3, [&](int sample) {
+        visible.clear();
+        CullSpheres(cullFrustum(sample), cullSpheres, visible);
+        visibleSink += visible.size();
+        return 1.0;
+    });
+    runBenchmark("frustum_cull/boxes_10k", "ms", 1e3, [&](int sample) {
+        visible.clear();
+        CullBoxes(cullFrustum(sample), cullBoxes, visible);
+        visibleSink += visible.size();
+        return 1.0;
+    });
+
+    for (int threads : threadCounts) {
+        runBenchmark("chunk_pipeline/threads_" + std::to_string(threads), "ms/chunk", 1e3, [=](int sample) {
+            return runChunkPipeline(threads, sample, false);
+        });
+    }
+
+    // --rtin-error 0.5, the adaptive meshes' usual tolerance
+    rtinMaxError = 0.5f;
+    for (int threads : threadCounts) {
+        runBenchmark("chunk_pipeline_rtin/threads_" + std::to_string(threads), "ms/chunk", 1e3, [=](int sample) {
+            return runChunkPipeline(threads, sample, true);
+        });
+    }
+    rtinMaxError = 0.0f;
+
+    // Keeps the sampled values alive without affecting the output
+    if (heightSink == 1.0f && noiseSink == 1.0f && visibleSink == 1) fprintf(stderr, " ");
+
+    FILE* out = outPath ? fopen(outPath, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Could not open %s for writing\n", outPath);
+        return 1;
+    }
+    writeResults(out, hardwareThreads);
+    if (out != stdout) fclose(out);
+
+    return 0;
+}
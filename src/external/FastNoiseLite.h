@@ -52,6 +52,23 @@
 
 #include <cmath>
 
+// Batch API: SSE2 lanes are used wherever the target guarantees SSE2, AVX2 lanes
+// are selected at runtime on CPUs that report support for them
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FNL_SIMD_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define FNL_SIMD_AVX2
+#define FNL_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#define FNL_SIMD_AVX2
+#define FNL_TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+#endif
+
 class FastNoiseLite
 {
 public:
@@ -108,6 +125,14 @@ public:
         DomainWarpType_BasicGrid
     };
 
+    enum SimdLevel
+    {
+        SimdLevel_Auto,
+        SimdLevel_Scalar,
+        SimdLevel_SSE2,
+        SimdLevel_AVX2
+    };
+
     /// <summary>
     /// Create new FastNoise object with optional seed
     /// </summary>
@@ -135,6 +160,8 @@ public:
         mDomainWarpType = DomainWarpType_OpenSimplex2;
         mWarpTransformType3D = TransformType3D_DefaultOpenSimplex2;
         mDomainWarpAmp = 1.0f;
+
+        mSimdLevel = SimdLevel_Auto;
     }
 
     /// <summary>
@@ -286,6 +313,28 @@ public:
     void SetDomainWarpAmp(float domainWarpAmp) { mDomainWarpAmp = domainWarpAmp; }
 
 
+    /// <summary>
+    /// Sets the widest instruction set used by GetNoiseBatch(...) and GetNoiseGrid(...)
+    /// </summary>
+    /// <remarks>
+    /// Default: Auto (widest level supported by the running CPU)
+    /// Note: Levels the CPU does not support fall back to the next narrower one
+    /// </remarks>
+    void SetSimdLevel(SimdLevel simdLevel) { mSimdLevel = simdLevel; }
+
+    /// <summary>
+    /// Instruction set GetNoiseBatch(...) will use with the current settings
+    /// </summary>
+    SimdLevel GetActiveSimdLevel() const
+    {
+        SimdLevel supported = DetectSimdLevel();
+
+        if (mSimdLevel == SimdLevel_Auto || mSimdLevel > supported)
+            return supported;
+        return mSimdLevel;
+    }
+
+
     /// <summary>
     /// 2D noise at given position using current settings
     /// </summary>
@@ -339,6 +388,118 @@ public:
     }
 
 
+    /// <summary>
+    /// 2D noise for count positions using current settings
+    /// </summary>
+    /// <remarks>
+    /// Writes GetNoise(x[i], y[i]) to out[i * outStride].
+    /// OpenSimplex2 with FBm or no fractal is evaluated 4 or 8 positions at a time,
+    /// every other setting falls back to GetNoise(...) per position.
+    /// Results are bit-identical to the scalar path as long as the compiler
+    /// does not contract float multiply-adds (no -ffp-contract=fast with FMA targets)
+    /// </remarks>
+    void GetNoiseBatch(const float* x, const float* y, float* out, int count, int outStride = 1) const
+    {
+        int i = GenBatch2D(x, y, false, out, count, outStride);
+
+        for (; i < count; i++)
+        {
+            out[i * outStride] = GetNoise(x[i], y[i]);
+        }
+    }
+
+    /// <summary>
+    /// 2D noise for a countX * countY block of positions using current settings
+    /// </summary>
+    /// <remarks>
+    /// Writes GetNoise(x[col], y[row]) to out[row * rowStride + col * colStride].
+    /// Same vectorisation and bit-exactness rules as GetNoiseBatch(...)
+    /// </remarks>
+    void GetNoiseGrid(const float* x, int countX, const float* y, int countY, float* out, int colStride, int rowStride) const
+    {
+        for (int row = 0; row < countY; row++)
+        {
+            float* outRow = out + row * rowStride;
+            int col = GenBatch2D(x, y + row, true, outRow, countX, colStride);
+
+            for (; col < countX; col++)
+            {
+                outRow[col * colStride] = GetNoise(x[col], y[row]);
+            }
+        }
+    }
+
+
+    /// <summary>
+    /// 2D noise at given position, specialised at compile time
+    /// </summary>
+    /// <remarks>
+    /// Noise type, fractal type and octave count are template arguments instead of
+    /// runtime settings, so there is no dispatch per octave and the octave loop has a
+    /// constant trip count the compiler can unroll. Seed, frequency, lacunarity, gain,
+    /// weighted strength and ping pong strength still come from the instance.
+    /// Matches GetNoise(...) bit for bit when the runtime settings agree with the
+    /// template arguments; GetNoise(...) remains the generic path.
+    /// Example: GetNoiseFixed&lt;NoiseType_OpenSimplex2, FractalType_FBm, 6&gt;(x, y)
+    /// </remarks>
+    template <NoiseType Noise, FractalType Fractal, int Octaves, typename FNfloat>
+    float GetNoiseFixed(FNfloat x, FNfloat y) const
+    {
+        Arguments_must_be_floating_point_values<FNfloat>();
+
+        TransformNoiseCoordinateFixed<Noise>(x, y);
+
+        switch (Fractal)
+        {
+        default:
+            return GenNoiseSingleFixed<Noise>(mSeed, x, y);
+        case FractalType_FBm:
+        case FractalType_Ridged:
+        case FractalType_PingPong:
+            return GenFractalFixed<Noise, Fractal, Octaves>(x, y);
+        }
+    }
+
+    /// <summary>
+    /// GetNoiseBatch(...) specialised at compile time
+    /// </summary>
+    /// <remarks>
+    /// Same template arguments and rules as GetNoiseFixed(...); the SIMD lanes
+    /// unroll the octave loop too
+    /// </remarks>
+    template <NoiseType Noise, FractalType Fractal, int Octaves>
+    void GetNoiseBatchFixed(const float* x, const float* y, float* out, int count, int outStride = 1) const
+    {
+        int i = GenBatch2DFixed<Noise, Fractal, Octaves>(x, y, false, out, count, outStride);
+
+        for (; i < count; i++)
+        {
+            out[i * outStride] = GetNoiseFixed<Noise, Fractal, Octaves>(x[i], y[i]);
+        }
+    }
+
+    /// <summary>
+    /// GetNoiseGrid(...) specialised at compile time
+    /// </summary>
+    /// <remarks>
+    /// Same template arguments and rules as GetNoiseFixed(...)
+    /// </remarks>
+    template <NoiseType Noise, FractalType Fractal, int Octaves>
+    void GetNoiseGridFixed(const float* x, int countX, const float* y, int countY, float* out, int colStride, int rowStride) const
+    {
+        for (int row = 0; row < countY; row++)
+        {
+            float* outRow = out + row * rowStride;
+            int col = GenBatch2DFixed<Noise, Fractal, Octaves>(x, y + row, true, outRow, countX, colStride);
+
+            for (; col < countX; col++)
+            {
+                outRow[col * colStride] = GetNoiseFixed<Noise, Fractal, Octaves>(x[col], y[row]);
+            }
+        }
+    }
+
+
     /// <summary>
     /// 2D warps the input position using current domain warp settings
     /// </summary>
@@ -428,6 +589,8 @@ private:
     TransformType3D mWarpTransformType3D;
     float mDomainWarpAmp;
 
+    SimdLevel mSimdLevel;
+
 
     template <typename T>
     struct Lookup
@@ -683,6 +846,102 @@ private:
         }
     }
 
+    // Compile-time noise selection for GetNoiseFixed(...): the switches fold away
+
+    template <NoiseType Noise, typename FNfloat>
+    float GenNoiseSingleFixed(int seed, FNfloat x, FNfloat y) const
+    {
+        switch (Noise)
+        {
+        case NoiseType_OpenSimplex2:
+            return SingleSimplex(seed, x, y);
+        case NoiseType_OpenSimplex2S:
+            return SingleOpenSimplex2S(seed, x, y);
+        case NoiseType_Cellular:
+            return SingleCellular(seed, x, y);
+        case NoiseType_Perlin:
+            return SinglePerlin(seed, x, y);
+        case NoiseType_ValueCubic:
+            return SingleValueCubic(seed, x, y);
+        case NoiseType_Value:
+            return SingleValue(seed, x, y);
+        default:
+            return 0;
+        }
+    }
+
+    template <NoiseType Noise, typename FNfloat>
+    void TransformNoiseCoordinateFixed(FNfloat& x, FNfloat& y) const
+    {
+        x *= mFrequency;
+        y *= mFrequency;
+
+        if (Noise == NoiseType_OpenSimplex2 || Noise == NoiseType_OpenSimplex2S)
+        {
+            const FNfloat SQRT3 = (FNfloat)1.7320508075688772935274463415059;
+            const FNfloat F2 = 0.5f * (SQRT3 - 1);
+            FNfloat t = (x + y) * F2;
+            x += t;
+            y += t;
+        }
+    }
+
+    // Same sequence as CalculateFractalBounding(), reusing its result when the octave counts agree
+    template <int Octaves>
+    float FractalBoundingFixed() const
+    {
+        if (Octaves == mOctaves)
+            return mFractalBounding;
+
+        float gain = FastAbs(mGain);
+        float amp = gain;
+        float ampFractal = 1.0f;
+        for (int i = 1; i < Octaves; i++)
+        {
+            ampFractal += amp;
+            amp *= gain;
+        }
+        return 1 / ampFractal;
+    }
+
+    // GenFractalFBm / GenFractalRidged / GenFractalPingPong with a constant octave count
+    template <NoiseType Noise, FractalType Fractal, int Octaves, typename FNfloat>
+    float GenFractalFixed(FNfloat x, FNfloat y) const
+    {
+        int seed = mSeed;
+        float sum = 0;
+        float amp = FractalBoundingFixed<Octaves>();
+
+        for (int i = 0; i < Octaves; i++)
+        {
+            float single = GenNoiseSingleFixed<Noise>(seed++, x, y);
+
+            if (Fractal == FractalType_FBm)
+            {
+                sum += single * amp;
+                amp *= Lerp(1.0f, FastMin(single + 1, 2) * 0.5f, mWeightedStrength);
+            }
+            else if (Fractal == FractalType_Ridged)
+            {
+                float noise = FastAbs(single);
+                sum += (noise * -2 + 1) * amp;
+                amp *= Lerp(1.0f, 1 - noise, mWeightedStrength);
+            }
+            else
+            {
+                float noise = PingPong((single + 1) * mPingPongStrength);
+                sum += (noise - 0.5f) * 2 * amp;
+                amp *= Lerp(1.0f, noise, mWeightedStrength);
+            }
+
+            x *= mLacunarity;
+            y *= mLacunarity;
+            amp *= mGain;
+        }
+
+        return sum;
+    }
+
     template <typename FNfloat>
     void TransformNoiseCoordinate(FNfloat& x, FNfloat& y, FNfloat& z) const
     {
@@ -2442,6 +2701,389 @@ private:
         yr += vy * warpAmp;
         zr += vz * warpAmp;
     }
+
+
+    // Batch 2D OpenSimplex2 (SSE2 / AVX2)
+    //
+    // Each lane replays the exact float operation sequence of TransformNoiseCoordinate,
+    // GenFractalFBm and SingleSimplex, so results match GetNoise(...) bit for bit.
+    // Branches in SingleSimplex become masks; all three corners are always evaluated.
+
+    static SimdLevel DetectSimdLevel()
+    {
+#if defined(FNL_SIMD_AVX2) && (defined(__GNUC__) || defined(__clang__))
+        static const SimdLevel level = __builtin_cpu_supports("avx2") ? SimdLevel_AVX2 : SimdLevel_SSE2;
+        return level;
+#elif defined(FNL_SIMD_AVX2) && defined(_MSC_VER)
+        static const SimdLevel level = DetectSimdLevelCpuid();
+        return level;
+#elif defined(FNL_SIMD_SSE2)
+        return SimdLevel_SSE2;
+#else
+        return SimdLevel_Scalar;
+#endif
+    }
+
+#if defined(FNL_SIMD_AVX2) && defined(_MSC_VER) && !defined(__clang__)
+    static SimdLevel DetectSimdLevelCpuid()
+    {
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return SimdLevel_SSE2;
+
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+            return SimdLevel_SSE2;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) ? SimdLevel_AVX2 : SimdLevel_SSE2;
+    }
+#endif
+
+    // Returns how many positions were written, the caller finishes the tail with GetNoise(...)
+    int GenBatch2D(const float* x, const float* y, bool yUniform, float* out, int count, int outStride) const
+    {
+        if (mNoiseType != NoiseType_OpenSimplex2 ||
+            mFractalType == FractalType_Ridged || mFractalType == FractalType_PingPong)
+            return 0;
+
+        const bool fbm = mFractalType == FractalType_FBm;
+
+        switch (GetActiveSimdLevel())
+        {
+#ifdef FNL_SIMD_AVX2
+        case SimdLevel_AVX2:
+            return GenBatchSimplexAVX2<0>(x, y, yUniform, fbm, out, count, outStride);
+#endif
+#ifdef FNL_SIMD_SSE2
+        case SimdLevel_SSE2:
+            return GenBatchSimplexSSE2<0>(x, y, yUniform, fbm, out, count, outStride);
+#endif
+        default:
+            return 0;
+        }
+    }
+
+    // GenBatch2D(...) for GetNoiseBatchFixed / GetNoiseGridFixed: the kernels see a constant octave count
+    template <NoiseType Noise, FractalType Fractal, int Octaves>
+    int GenBatch2DFixed(const float* x, const float* y, bool yUniform, float* out, int count, int outStride) const
+    {
+        if (Noise != NoiseType_OpenSimplex2 ||
+            Fractal == FractalType_Ridged || Fractal == FractalType_PingPong)
+            return 0;
+
+        const bool fbm = Fractal == FractalType_FBm;
+
+        switch (GetActiveSimdLevel())
+        {
+#ifdef FNL_SIMD_AVX2
+        case SimdLevel_AVX2:
+            return GenBatchSimplexAVX2<Octaves>(x, y, yUniform, fbm, out, count, outStride);
+#endif
+#ifdef FNL_SIMD_SSE2
+        case SimdLevel_SSE2:
+            return GenBatchSimplexSSE2<Octaves>(x, y, yUniform, fbm, out, count, outStride);
+#endif
+        default:
+            return 0;
+        }
+    }
+
+    struct SimplexBatchConstants
+    {
+        float F2, G2, G2m1, G2x2m1, C1, C2;
+
+        SimplexBatchConstants()
+        {
+            // Same literals and casts as TransformNoiseCoordinate<float> / SingleSimplex
+            const float SQRT3T = (float)1.7320508075688772935274463415059;
+            F2 = 0.5f * (SQRT3T - 1);
+
+            const float SQRT3 = 1.7320508075688772935274463415059f;
+            const float G2c = (3 - SQRT3) / 6;
+            G2 = (float)G2c;
+            G2m1 = (float)G2c - 1;
+            G2x2m1 = 2 * (float)G2c - 1;
+            C1 = (float)(2 * (1 - 2 * G2c) * (1 / G2c - 2));
+            C2 = (float)(-2 * (1 - 2 * G2c) * (1 - 2 * G2c));
+        }
+    };
+
+#ifdef FNL_SIMD_SSE2
+    static __m128i MulLoSSE2(__m128i a, __m128i b)
+    {
+        __m128i even = _mm_mul_epu32(a, b);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+
+    static __m128 GradCoordSSE2(__m128i seed, __m128i xPrimed, __m128i yPrimed, __m128 xd, __m128 yd)
+    {
+        __m128i hash = _mm_xor_si128(_mm_xor_si128(seed, xPrimed), yPrimed);
+        hash = MulLoSSE2(hash, _mm_set1_epi32(0x27d4eb2d));
+        hash = _mm_xor_si128(hash, _mm_srai_epi32(hash, 15));
+        hash = _mm_and_si128(hash, _mm_set1_epi32(127 << 1));
+
+        alignas(16) int idx[4];
+        _mm_store_si128((__m128i*)idx, hash);
+
+        const float* g = Lookup<float>::Gradients2D;
+        __m128 xg = _mm_setr_ps(g[idx[0]], g[idx[1]], g[idx[2]], g[idx[3]]);
+        __m128 yg = _mm_setr_ps(g[idx[0] | 1], g[idx[1] | 1], g[idx[2] | 1], g[idx[3] | 1]);
+
+        return _mm_add_ps(_mm_mul_ps(xd, xg), _mm_mul_ps(yd, yg));
+    }
+
+    static __m128 SingleSimplexSSE2(const SimplexBatchConstants& k, __m128i seed, __m128 x, __m128 y)
+    {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128i primeX = _mm_set1_epi32(PrimeX);
+        const __m128i primeY = _mm_set1_epi32(PrimeY);
+
+        // FastFloor: (int)f, minus one when !(f >= 0)
+        __m128i i = _mm_add_epi32(_mm_cvttps_epi32(x), _mm_castps_si128(_mm_cmpnge_ps(x, zero)));
+        __m128i j = _mm_add_epi32(_mm_cvttps_epi32(y), _mm_castps_si128(_mm_cmpnge_ps(y, zero)));
+        __m128 xi = _mm_sub_ps(x, _mm_cvtepi32_ps(i));
+        __m128 yi = _mm_sub_ps(y, _mm_cvtepi32_ps(j));
+
+        __m128 t = _mm_mul_ps(_mm_add_ps(xi, yi), _mm_set1_ps(k.G2));
+        __m128 x0 = _mm_sub_ps(xi, t);
+        __m128 y0 = _mm_sub_ps(yi, t);
+
+        i = MulLoSSE2(i, primeX);
+        j = MulLoSSE2(j, primeY);
+
+        __m128 a = _mm_sub_ps(_mm_sub_ps(half, _mm_mul_ps(x0, x0)), _mm_mul_ps(y0, y0));
+        __m128 aa = _mm_mul_ps(a, a);
+        __m128 n0 = _mm_mul_ps(_mm_mul_ps(aa, aa), GradCoordSSE2(seed, i, j, x0, y0));
+        n0 = _mm_andnot_ps(_mm_cmple_ps(a, zero), n0);
+
+        __m128 c = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(k.C1), t), _mm_add_ps(_mm_set1_ps(k.C2), a));
+        __m128 x2 = _mm_add_ps(x0, _mm_set1_ps(k.G2x2m1));
+        __m128 y2 = _mm_add_ps(y0, _mm_set1_ps(k.G2x2m1));
+        __m128 cc = _mm_mul_ps(c, c);
+        __m128 n2 = _mm_mul_ps(_mm_mul_ps(cc, cc),
+                               GradCoordSSE2(seed, _mm_add_epi32(i, primeX), _mm_add_epi32(j, primeY), x2, y2));
+        n2 = _mm_andnot_ps(_mm_cmple_ps(c, zero), n2);
+
+        // y0 > x0 picks the (0,1) corner, otherwise (1,0)
+        __m128 upper = _mm_cmpgt_ps(y0, x0);
+        __m128i upperI = _mm_castps_si128(upper);
+        __m128 g2 = _mm_set1_ps(k.G2);
+        __m128 g2m1 = _mm_set1_ps(k.G2m1);
+        __m128 x1 = _mm_add_ps(x0, _mm_or_ps(_mm_and_ps(upper, g2), _mm_andnot_ps(upper, g2m1)));
+        __m128 y1 = _mm_add_ps(y0, _mm_or_ps(_mm_and_ps(upper, g2m1), _mm_andnot_ps(upper, g2)));
+        __m128i i1 = _mm_add_epi32(i, _mm_andnot_si128(upperI, primeX));
+        __m128i j1 = _mm_add_epi32(j, _mm_and_si128(upperI, primeY));
+
+        __m128 b = _mm_sub_ps(_mm_sub_ps(half, _mm_mul_ps(x1, x1)), _mm_mul_ps(y1, y1));
+        __m128 bb = _mm_mul_ps(b, b);
+        __m128 n1 = _mm_mul_ps(_mm_mul_ps(bb, bb), GradCoordSSE2(seed, i1, j1, x1, y1));
+        n1 = _mm_andnot_ps(_mm_cmple_ps(b, zero), n1);
+
+        return _mm_mul_ps(_mm_add_ps(_mm_add_ps(n0, n1), n2), _mm_set1_ps(99.83685446303647f));
+    }
+
+    // Octaves > 0 fixes the octave count at compile time, 0 reads mOctaves
+    template <int Octaves>
+    int GenBatchSimplexSSE2(const float* xIn, const float* yIn, bool yUniform, bool fbm, float* out, int count, int outStride) const
+    {
+        static const SimplexBatchConstants k;
+        const __m128 freq = _mm_set1_ps(mFrequency);
+        const __m128 f2 = _mm_set1_ps(k.F2);
+        const int octaves = Octaves > 0 ? Octaves : mOctaves;
+        const float bounding = Octaves > 0 ? FractalBoundingFixed<Octaves>() : mFractalBounding;
+
+        int n = 0;
+        for (; n + 4 <= count; n += 4)
+        {
+            __m128 x = _mm_mul_ps(_mm_loadu_ps(xIn + n), freq);
+            __m128 y = _mm_mul_ps(yUniform ? _mm_set1_ps(*yIn) : _mm_loadu_ps(yIn + n), freq);
+
+            __m128 t = _mm_mul_ps(_mm_add_ps(x, y), f2);
+            x = _mm_add_ps(x, t);
+            y = _mm_add_ps(y, t);
+
+            __m128 result;
+            if (!fbm)
+            {
+                result = SingleSimplexSSE2(k, _mm_set1_epi32(mSeed), x, y);
+            }
+            else
+            {
+                const __m128 one = _mm_set1_ps(1.0f);
+                __m128 sum = _mm_setzero_ps();
+                __m128 amp = _mm_set1_ps(bounding);
+                int seed = mSeed;
+
+                for (int o = 0; o < octaves; o++)
+                {
+                    __m128 noise = SingleSimplexSSE2(k, _mm_set1_epi32(seed++), x, y);
+                    sum = _mm_add_ps(sum, _mm_mul_ps(noise, amp));
+
+                    __m128 weight = _mm_mul_ps(_mm_min_ps(_mm_add_ps(noise, one), _mm_set1_ps(2.0f)), _mm_set1_ps(0.5f));
+                    amp = _mm_mul_ps(amp, _mm_add_ps(one, _mm_mul_ps(_mm_set1_ps(mWeightedStrength), _mm_sub_ps(weight, one))));
+
+                    x = _mm_mul_ps(x, _mm_set1_ps(mLacunarity));
+                    y = _mm_mul_ps(y, _mm_set1_ps(mLacunarity));
+                    amp = _mm_mul_ps(amp, _mm_set1_ps(mGain));
+                }
+                result = sum;
+            }
+
+            if (outStride == 1)
+            {
+                _mm_storeu_ps(out + n, result);
+            }
+            else
+            {
+                alignas(16) float lanes[4];
+                _mm_store_ps(lanes, result);
+                for (int l = 0; l < 4; l++)
+                    out[(n + l) * outStride] = lanes[l];
+            }
+        }
+        return n;
+    }
+#endif
+
+#ifdef FNL_SIMD_AVX2
+    FNL_TARGET_AVX2
+    static __m256 GradCoordAVX2(__m256i seed, __m256i xPrimed, __m256i yPrimed, __m256 xd, __m256 yd)
+    {
+        __m256i hash = _mm256_xor_si256(_mm256_xor_si256(seed, xPrimed), yPrimed);
+        hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32(0x27d4eb2d));
+        hash = _mm256_xor_si256(hash, _mm256_srai_epi32(hash, 15));
+        hash = _mm256_and_si256(hash, _mm256_set1_epi32(127 << 1));
+
+        const float* g = Lookup<float>::Gradients2D;
+        __m256 xg = _mm256_i32gather_ps(g, hash, 4);
+        __m256 yg = _mm256_i32gather_ps(g + 1, hash, 4);
+
+        return _mm256_add_ps(_mm256_mul_ps(xd, xg), _mm256_mul_ps(yd, yg));
+    }
+
+    FNL_TARGET_AVX2
+    static __m256 SingleSimplexAVX2(const SimplexBatchConstants& k, __m256i seed, __m256 x, __m256 y)
+    {
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256i primeX = _mm256_set1_epi32(PrimeX);
+        const __m256i primeY = _mm256_set1_epi32(PrimeY);
+
+        // FastFloor: (int)f, minus one when !(f >= 0)
+        __m256i i = _mm256_add_epi32(_mm256_cvttps_epi32(x), _mm256_castps_si256(_mm256_cmp_ps(x, zero, _CMP_NGE_UQ)));
+        __m256i j = _mm256_add_epi32(_mm256_cvttps_epi32(y), _mm256_castps_si256(_mm256_cmp_ps(y, zero, _CMP_NGE_UQ)));
+        __m256 xi = _mm256_sub_ps(x, _mm256_cvtepi32_ps(i));
+        __m256 yi = _mm256_sub_ps(y, _mm256_cvtepi32_ps(j));
+
+        __m256 t = _mm256_mul_ps(_mm256_add_ps(xi, yi), _mm256_set1_ps(k.G2));
+        __m256 x0 = _mm256_sub_ps(xi, t);
+        __m256 y0 = _mm256_sub_ps(yi, t);
+
+        i = _mm256_mullo_epi32(i, primeX);
+        j = _mm256_mullo_epi32(j, primeY);
+
+        __m256 a = _mm256_sub_ps(_mm256_sub_ps(half, _mm256_mul_ps(x0, x0)), _mm256_mul_ps(y0, y0));
+        __m256 aa = _mm256_mul_ps(a, a);
+        __m256 n0 = _mm256_mul_ps(_mm256_mul_ps(aa, aa), GradCoordAVX2(seed, i, j, x0, y0));
+        n0 = _mm256_andnot_ps(_mm256_cmp_ps(a, zero, _CMP_LE_OQ), n0);
+
+        __m256 c = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(k.C1), t), _mm256_add_ps(_mm256_set1_ps(k.C2), a));
+        __m256 x2 = _mm256_add_ps(x0, _mm256_set1_ps(k.G2x2m1));
+        __m256 y2 = _mm256_add_ps(y0, _mm256_set1_ps(k.G2x2m1));
+        __m256 cc = _mm256_mul_ps(c, c);
+        __m256 n2 = _mm256_mul_ps(_mm256_mul_ps(cc, cc),
+                                  GradCoordAVX2(seed, _mm256_add_epi32(i, primeX), _mm256_add_epi32(j, primeY), x2, y2));
+        n2 = _mm256_andnot_ps(_mm256_cmp_ps(c, zero, _CMP_LE_OQ), n2);
+
+        // y0 > x0 picks the (0,1) corner, otherwise (1,0)
+        __m256 upper = _mm256_cmp_ps(y0, x0, _CMP_GT_OQ);
+        __m256i upperI = _mm256_castps_si256(upper);
+        __m256 g2 = _mm256_set1_ps(k.G2);
+        __m256 g2m1 = _mm256_set1_ps(k.G2m1);
+        __m256 x1 = _mm256_add_ps(x0, _mm256_blendv_ps(g2m1, g2, upper));
+        __m256 y1 = _mm256_add_ps(y0, _mm256_blendv_ps(g2, g2m1, upper));
+        __m256i i1 = _mm256_add_epi32(i, _mm256_andnot_si256(upperI, primeX));
+        __m256i j1 = _mm256_add_epi32(j, _mm256_and_si256(upperI, primeY));
+
+        __m256 b = _mm256_sub_ps(_mm256_sub_ps(half, _mm256_mul_ps(x1, x1)), _mm256_mul_ps(y1, y1));
+        __m256 bb = _mm256_mul_ps(b, b);
+        __m256 n1 = _mm256_mul_ps(_mm256_mul_ps(bb, bb), GradCoordAVX2(seed, i1, j1, x1, y1));
+        n1 = _mm256_andnot_ps(_mm256_cmp_ps(b, zero, _CMP_LE_OQ), n1);
+
+        return _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(n0, n1), n2), _mm256_set1_ps(99.83685446303647f));
+    }
+
+    template <int Octaves>
+    FNL_TARGET_AVX2
+    int GenBatchSimplexAVX2(const float* xIn, const float* yIn, bool yUniform, bool fbm, float* out, int count, int outStride) const
+    {
+        static const SimplexBatchConstants k;
+        const __m256 freq = _mm256_set1_ps(mFrequency);
+        const __m256 f2 = _mm256_set1_ps(k.F2);
+        const int octaves = Octaves > 0 ? Octaves : mOctaves;
+        const float bounding = Octaves > 0 ? FractalBoundingFixed<Octaves>() : mFractalBounding;
+
+        int n = 0;
+        for (; n + 8 <= count; n += 8)
+        {
+            __m256 x = _mm256_mul_ps(_mm256_loadu_ps(xIn + n), freq);
+            __m256 y = _mm256_mul_ps(yUniform ? _mm256_set1_ps(*yIn) : _mm256_loadu_ps(yIn + n), freq);
+
+            __m256 t = _mm256_mul_ps(_mm256_add_ps(x, y), f2);
+            x = _mm256_add_ps(x, t);
+            y = _mm256_add_ps(y, t);
+
+            __m256 result;
+            if (!fbm)
+            {
+                result = SingleSimplexAVX2(k, _mm256_set1_epi32(mSeed), x, y);
+            }
+            else
+            {
+                const __m256 one = _mm256_set1_ps(1.0f);
+                __m256 sum = _mm256_setzero_ps();
+                __m256 amp = _mm256_set1_ps(bounding);
+                int seed = mSeed;
+
+                for (int o = 0; o < octaves; o++)
+                {
+                    __m256 noise = SingleSimplexAVX2(k, _mm256_set1_epi32(seed++), x, y);
+                    sum = _mm256_add_ps(sum, _mm256_mul_ps(noise, amp));
+
+                    __m256 weight = _mm256_mul_ps(_mm256_min_ps(_mm256_add_ps(noise, one), _mm256_set1_ps(2.0f)), _mm256_set1_ps(0.5f));
+                    amp = _mm256_mul_ps(amp, _mm256_add_ps(one, _mm256_mul_ps(_mm256_set1_ps(mWeightedStrength), _mm256_sub_ps(weight, one))));
+
+                    x = _mm256_mul_ps(x, _mm256_set1_ps(mLacunarity));
+                    y = _mm256_mul_ps(y, _mm256_set1_ps(mLacunarity));
+                    amp = _mm256_mul_ps(amp, _mm256_set1_ps(mGain));
+                }
+                result = sum;
+            }
+
+            if (outStride == 1)
+            {
+                _mm256_storeu_ps(out + n, result);
+            }
+            else
+            {
+                alignas(32) float lanes[8];
+                _mm256_store_ps(lanes, result);
+                for (int l = 0; l < 8; l++)
+                    out[(n + l) * outStride] = lanes[l];
+            }
+        }
+
+        // Leftover group of 4 still goes through SSE2 before the scalar tail
+        return n + GenBatchSimplexSSE2<Octaves>(xIn + n, yUniform ? yIn : yIn + n, yUniform, fbm, out + n * outStride, count - n, outStride);
+    }
+#endif
 };
 
 template <>
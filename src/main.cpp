@@ -7,10 +7,34 @@
 #include <cmath>
 #include <external/FastNoiseLite.h>
 #include <render/shader.h>
+#include <render/vertex_cache.h>
+#include <render/buffer_pool.h>
+#include <render/mega_buffer.h>
+#include <render/gltf_model.h>
+#include <render/upload_ring.h>
+#include <render/instance_buffer.h>
+#include <render/frustum_cull.h>
+#include <render/frame_uniforms.h>
+#include <render/render_queue.h>
+#include <terrain/tile_cache.h>
+#include <terrain/chunk_grid.h>
+#include <terrain/mpmc_ring.h>
+#include <terrain/cdlod.h>
+#include <terrain/height_query.h>
+#include <terrain/terrain_generator.h>
 #include <thread>
 #include <mutex>
-#include <queue>
 #include <atomic>
+#include <condition_variable>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#ifdef __linux__
+#include <unistd.h>
+#endif
 
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
@@ -24,64 +48,114 @@
 
 */
 
-// Data structures for storing vertex, mesh, and object data
-struct Vertex {
-    glm::vec3 Position;
-    glm::vec3 Normal;
-    glm::vec2 TexCoords;
+// CDLOD node vertex: the vertex's own compact sample and the sample it merges
+// with at the parent level (the even grid vertex at or before it on each axis).
+// terrain_cdlod.vert blends from the first to the second as the node morphs.
+struct CdlodVertex {
+    unsigned short height;
+    unsigned short morphHeight;
+    signed char normalOct[2];
+    signed char morphNormalOct[2];
 };
 
-struct TurbineMesh {
-    GLuint VAO;
-    GLuint EBO;
-    GLsizei indexCount;
-    GLenum indexType; 
-    GLsizei vertexCount;
+struct LODLevel {
+    unsigned int indexCount;
+    unsigned int firstIndex;    // into terrainIndexBuffer
+    int baseVertex;             // first vertex of the LOD in terrainVertexBuffer
 };
 
-struct Turbine {
-    tinygltf::Model model;
-    std::vector<TurbineMesh> meshes;
+struct Chunk {
+    std::vector<LODLevel> lodLevels;
+    glm::vec2 position;
+    int chunkX;
+    int chunkZ;
+    MegaBufferRange vertexRange;    // slot in terrainVertexBuffer holding every LOD's vertices
+    MegaBufferRange indexRange;     // an RTIN chunk's own indices in terrainIndexBuffer, else empty
+    glm::vec2 heightBounds;     // lowest and highest LOD0 height, for the culling box
 };
 
-struct SolarPanelMesh {
-    GLuint VAO;
-    GLuint EBO;
+// Index list shared by every chunk at one LOD (the grid topology never changes)
+struct TerrainLODIndices {
+    GLuint firstIndex;          // in terrainIndexBuffer
     GLsizei indexCount;
-    GLenum indexType;
-    GLsizei vertexCount;
 };
 
-struct SolarPanel {
-    tinygltf::Model model;
-    std::vector<SolarPanelMesh> meshes;
+// Pending chunk generation job, ordered by squared distance to the camera.
+// CDLOD node jobs share the workers: chunkX/Z are then the node coordinates.
+struct ChunkRequest {
+    int chunkX;
+    int chunkZ;
+    float priority;
+    int cdlodLevel;     // -1 for a chunk of the window, else the CDLOD node level
 };
 
-struct LODLevel {
-    GLuint VAO;
-    unsigned int indexCount;
+struct ChunkRequestFarther {
+    bool operator()(const ChunkRequest& a, const ChunkRequest& b) const {
+        return a.priority > b.priority;
+    }
 };
 
-struct Chunk {
-    std::vector<LODLevel> lodLevels;
-    glm::vec2 position;
-    int chunkX;
-    int chunkZ;
+// Lifecycle of a chunk between its request and its insertion into activeChunks
+enum ChunkJobState {
+    CHUNK_JOB_QUEUED,     // in chunkRequests
+    CHUNK_JOB_RUNNING     // dispatched to the workers, result not consumed yet
 };
 
-struct ChunkData {
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
-    glm::vec2 position;
+// Worker output for one request. lods is empty when the worker skipped a
+// request whose chunk had already left the window. CDLOD node jobs fill
+// nodeVertices instead.
+struct ChunkResult {
     int chunkX;
     int chunkZ;
+    int cdlodLevel;
+    std::vector<ChunkData> lods;
+    std::vector<CdlodVertex> nodeVertices;
+    HeightTile heightTile;                  // LOD0 samples for terrainHeights
+    glm::vec2 heightBounds;                 // see Chunk::heightBounds
+    std::vector<glm::mat4> turbines;        // the chunk's scattered objects
+    std::vector<glm::mat4> solarPanels;
+};
+
+// One sun shadow cascade, with a cached static layer. Terrain chunks, turbine
+// towers and solar panels are drawn into staticDepth only when
+// shadowCasterGeneration or the cascade's light matrix has changed since the
+// last time; on every update that layer is copied into the cascade's layer of
+// shadowCascadeArray, which the main pass samples, and the dynamic casters
+// (the spinning blades, and CDLOD terrain whose morph follows the camera)
+// are drawn over it.
+struct ShadowMap {
+    unsigned int size;
+    int layer;
+    GLuint depthFBO;        // renders to `layer` of shadowCascadeArray
+    GLuint staticFBO;
+    GLuint staticDepth;
+    glm::mat4 lightSpaceMatrix;
+    bool staticValid;
+    glm::mat4 staticLightSpaceMatrix;       // what the static layer was drawn with
+    unsigned int staticGeneration;
+};
+
+// One primitive of an instanced model as the shadow pass draws it
+struct ShadowCasterMesh {
+    size_t primitive;
+    glm::mat4 model;
+};
+
+// Index buffer shared by every CDLOD node
+struct CdlodIndices {
+    GLuint EBO;
+    GLsizei indexCount;
+};
+
+// A CDLOD node whose vertices are in cdlodBufferPool
+struct CdlodResidentNode {
+    int bufferSlot;
+    unsigned int lastUsedFrame;
 };
 
-// Constants for grid size and scaling
-const unsigned int GRID_SIZE = 100;
-const float GRID_SCALE = 1.0f;
-const float HEIGHT_SCALE = 50.0f;
-const int NUM_TURBINES = 20;
+// Chunks are kept within chunkViewRadius of the camera chunk (--view-radius)
+const int MAX_CHUNK_VIEW_RADIUS = 64;
+int chunkViewRadius = 10;
 
 // Camera and directional lighting setup
 glm::vec3 eye_center(0.0f, 50.0f, 2000.0f);  
@@ -95,13 +169,159 @@ float FoV = 45.0f;
 float zNear = 0.1f;
 float zFar = 3000.0f;
 float cameraViewDistance = 50.0f;
+const float CAMERA_GROUND_CLEARANCE = 2.0f;
+
+// Instances for models (turbines, solar panels) - used for instanced rendering.
+// Every resident chunk owns the objects scattered on it (keyed by chunkKey).
+InstanceBuffer turbineInstances;
+ChunkGrid<Chunk> activeChunks(2 * MAX_CHUNK_VIEW_RADIUS + 1);
+InstanceBuffer solarPanelInstances;
+TerrainLODIndices terrainLODIndices[NUM_TERRAIN_LODS];
+
+// Terrain GPU memory is two megabuffers (render/mega_buffer) read through one
+// VAO: terrainVertexBuffer is an array of chunk slots, each holding all of a
+// chunk's LODs back to back, and terrainIndexBuffer holds the shared LOD
+// index lists plus the indices of adaptive (RTIN) chunks. Chunk draws are
+// base-vertex draws into their slot. terrain.vert finds the slot from
+// gl_VertexID, which includes the base vertex, and reads the slot's chunk
+// origin from terrainOriginTexture, so chunks at one LOD share every uniform
+// and the render queue merges them into a single multi-draw.
+// --terrain-vram-mb is split between the two: the index buffer gets the shared
+// LOD lists plus TERRAIN_RTIN_INDEX_SHARE of the budget when RTIN is on, and
+// the vertex buffer gets the rest.
+float terrainVRAMBudgetMB = 64.0f;
+const GLsizeiptr TERRAIN_INDEX_BUFFER_INITIAL_SIZE = 1024 * 1024;
+const float TERRAIN_RTIN_INDEX_SHARE = 0.25f;
+MegaBuffer terrainVertexBuffer;
+MegaBuffer terrainIndexBuffer;
+GLuint terrainVAO = 0;
+GLuint terrainOriginBuffer = 0;
+GLuint terrainOriginTexture = 0;
+std::vector<glm::vec2> terrainSlotOrigins;     // chunk origin (x, z) per vertex slot
+
+// Finished chunks are streamed to their slots through terrainUploadRing, at
+// most terrainUploadBudgetKB / terrainUploadBudgetMs per frame, nearest first
+// (--upload-budget-kb, --upload-budget-ms).
+const GLsizeiptr TERRAIN_UPLOAD_RING_SIZE = 4 * 1024 * 1024;
+float terrainUploadBudgetKB = 512.0f;
+float terrainUploadBudgetMs = 2.0f;
+StreamingUploadRing terrainUploadRing;
+
+// CDLOD terrain (--cdlod) replaces the chunk window with a quadtree of nodes
+// that all share one CDLOD_GRID_SIZE^2 mesh; node size and LOD range double
+// per level, so the draw count grows with the log of the view distance.
+// Nodes are generated by the chunk workers, stream into cdlodBufferPool and
+// are evicted after CDLOD_EVICT_FRAMES frames without being visited.
+const unsigned int CDLOD_GRID_SIZE = 32;
+const CdlodSettings CDLOD_SETTINGS = { 7, 32.0f, 96.0f, 0.66f, TERRAIN_HEIGHT_MIN, TERRAIN_HEIGHT_MAX };
+const unsigned int CDLOD_EVICT_FRAMES = 120;
+bool cdlodEnabled = false;
+BufferPool cdlodBufferPool;
+std::vector<GLuint> cdlodSlotVAOs;
+CdlodIndices cdlodIndices;     // quadrant-major, so a node can draw any run of quadrants
+std::unordered_map<unsigned long long, CdlodResidentNode> cdlodNodes;
+std::unordered_set<unsigned long long> cdlodNodeJobs;
+std::vector<ChunkResult> cdlodUploadQueue;
+std::vector<CdlodSelectedNode> cdlodSelection;
+unsigned int cdlodFrame = 0;
+
+// Scattered objects (scatterChunkObjects) start with room for this many instances per model
+const size_t INITIAL_INSTANCE_CAPACITY = 4096;
+
+// Turbine primitives are drawn through this transform, and the blades (primitive 16)
+// spin about TURBINE_BLADE_HUB on top of it. A model without position bounds
+// is culled with a MODEL_FALLBACK_RADIUS sphere.
+const glm::vec3 TURBINE_BLADE_HUB(0.0f, 70.0f, 0.0f);
+const size_t TURBINE_BLADE_MESH = 16;
+const float MODEL_FALLBACK_RADIUS = 100.0f;
+const float TURBINE_BLADE_SPEED = 0.10f;
+float turbineBladeRotation = 0.0f;         // degrees, advanced once per frame
+
+// Cascaded sun shadows (updateShadowCascades). NUM_SHADOW_CASCADES maps of
+// SHADOW_CASCADE_SIZE^2, together the texels of one 2048^2 map, cover
+// successive slices of the view frustum out to zFar; the split distances
+// blend logarithmic and uniform splits by SHADOW_SPLIT_LAMBDA. Cascade i is
+// refitted and redrawn every SHADOW_CASCADE_INTERVALS[i] frames (staggered,
+// so at most two update in one frame) and is sampled with the matrix it was
+// last drawn with. Cascades are square around the slice's bounding sphere
+// and move in whole texels, so their shadows do not swim.
+const int NUM_SHADOW_CASCADES = 4;
+const unsigned int SHADOW_CASCADE_SIZE = 1024;
+const unsigned int SHADOW_CASCADE_INTERVALS[NUM_SHADOW_CASCADES] = { 1, 2, 4, 8 };
+const float SHADOW_SPLIT_LAMBDA = 0.75f;
+const float SHADOW_CASTER_MARGIN = 500.0f;     // reach towards the sun for casters outside a slice
+const float SHADOW_BIAS_TEXELS = 2.0f;
+ShadowMap shadowCascades[NUM_SHADOW_CASCADES];
+GLuint shadowCascadeArray = 0;
+unsigned long long shadowCascadeUpdates = 0;
+unsigned long long shadowTexelsWritten = 0;
+
+// Shadow casters (renderShadowMap). The generation counts changes to the
+// resident chunks and their objects, which invalidate the static layers.
+// Terrain casters are drawn at the coarsest LOD whose grid spacing is still
+// no wider than a shadow map texel (shadowCasterLOD).
+unsigned int shadowCasterGeneration = 0;
+unsigned int staticShadowRenders = 0;
+unsigned int shadowFrames = 0;
+unsigned int shadowChunksDrawn = 0;
+unsigned int shadowTerrainDrawCalls = 0;
+unsigned int shadowChunksCulled = 0;
+int shadowTerrainLOD = 0;
+
+// Frame constants (updateFrameUniforms): camera, sun and cascade inputs in one
+// std140 uniform buffer that every program reads. Samplers are fixed to these
+// units once per program (configureShaderProgram), so draws only bind textures.
+static_assert(NUM_SHADOW_CASCADES == FRAME_UNIFORM_CASCADES, "FrameUniforms holds one matrix per cascade");
+FrameUniformBuffer frameUniforms;
+const std::pair<const char*, GLint> SHADER_SAMPLER_UNITS[] = {
+    { "terrainTexture", 0 }, { "baseColorMap", 0 }, { "normalMap", 1 }, { "metallicMap", 2 },
+    { "roughnessMap", 3 }, { "aoMap", 4 }, { "heightMap", 5 }, { "emissiveMap", 6 },
+    { "opacityMap", 7 }, { "specularMap", 8 }, { "shadowMap", 9 }, { "instanceMatrices", 10 },
+    { "chunkOrigins", 11 }
+};
 
-// Instances for models (turbines, solar panels) - used for instanced rendering
-std::vector<glm::mat4> turbineInstances;
-std::vector<Chunk> activeChunks;
-std::vector<glm::mat4> solarPanelInstances;
-GLuint instanceVBO;
-GLuint solarPanelInstanceVBO;
+// Main pass draw packets (render/render_queue): the render* functions queue
+// their draws, SubmitRenderQueue sorts them by pass and state and skips
+// redundant binds. The totals compare the binds and uniform writes the
+// draws asked for with those that reached GL, summed over every frame.
+// shadowRenderQueue carries a cascade's terrain, chunks (drawShadowTerrainChunks)
+// or CDLOD nodes (drawCdlodNodes).
+enum MainRenderPass { RENDER_PASS_SKY, RENDER_PASS_OPAQUE, RENDER_PASS_BLENDED };
+RenderQueue mainRenderQueue;
+RenderQueue shadowRenderQueue;
+GLStateCounters renderStatesRequested;
+GLStateCounters renderStatesIssued;
+unsigned int renderQueueFrames = 0;
+unsigned int renderQueueDraws = 0;
+unsigned int renderQueueDrawCalls = 0;
+
+// View frustum culling (cullScene): resident chunk boxes and object spheres
+// are tested each frame and the main pass only draws what survives. The
+// counters and cullMs (CPU time of the tests) are of the last frame.
+CullBoxList chunkCullBounds;
+std::vector<const Chunk*> chunkCullCandidates;
+std::vector<unsigned int> visibleChunks;    // into chunkCullCandidates
+unsigned int chunksCulled = 0;
+unsigned int objectsDrawn = 0;
+unsigned int objectsCulled = 0;
+double cullMs = 0.0;
+double cullTotalMs = 0.0;
+double cullMaxMs = 0.0;
+unsigned long long cullFrames = 0;
+
+
+// Terrain draw packets (one per chunk or CDLOD node) and triangles of the last
+// main pass, for the window title. The queue merges the packets into fewer GL
+// draw calls, counted in mainRenderQueue.issuedDraws.
+unsigned int terrainDrawPackets = 0;
+unsigned int terrainTrianglesDrawn = 0;
+
+// Frame durations for reportFrameTimes, only recorded during a flight
+// benchmark. --flight-benchmark N flies the camera straight ahead at
+// flightBenchmarkSpeed for N seconds and then exits.
+std::vector<float> frameTimesMs;
+float flightBenchmarkSeconds = 0.0f;
+float flightBenchmarkSpeed = 400.0f;
 
 // Various texture handles used by the solar panel rendering
 GLuint baseColor, normalMap, metallicMap, roughnessMap;
@@ -111,16 +331,51 @@ GLuint aoMap, heightMap, emissiveMap, opacityMap, specularMap;
 static float lastFrameTime = 0.0f;
 static float deltaTime = 0.0f;
 
-// Tracking the chunk location for dynamic terrain loading
+// Tracking the chunk location for dynamic terrain loading. The window is the
+// square of chunks updateChunks last made resident, centred on chunkWindowX/Z.
 int currentChunkX = 0;
 int currentChunkZ = 0;
-
-// Threading objects for loading chunks asynchronously
-static std::thread chunkThread;
-static std::mutex chunkMutex;
-static std::queue<std::vector<ChunkData>> chunkDataQueue;  
-static std::queue<std::pair<int,int>> chunkRequests;  
+static bool chunkWindowValid = false;
+static int chunkWindowX = 0;
+static int chunkWindowZ = 0;
+
+// Threading objects for loading chunks asynchronously. The render thread owns
+// chunkRequests, a min-heap on ChunkRequest::priority, and only hands the
+// nearest CHUNK_DISPATCH_DEPTH requests per worker to chunkRequestRing, so
+// workers still build the closest chunks first. Results come back through
+// chunkResultRing. Neither ring takes a lock; chunkParkMutex only lets idle
+// workers sleep. 0 workers means hardware_concurrency - 1.
+static const int CHUNK_DISPATCH_DEPTH = 2;
+static int chunkWorkerCount = 0;
+static std::vector<std::thread> chunkWorkers;
+static std::mutex chunkParkMutex;
+static std::condition_variable chunkRequestReady;
+static std::atomic<int> chunkRequestsAvailable(0);
+static MpmcRing<ChunkRequest> chunkRequestRing(256);
+static MpmcRing<ChunkResult> chunkResultRing(256);
+static std::vector<ChunkResult> chunkUploadQueue;
+static std::vector<ChunkRequest> chunkRequests;
+static int chunkJobsInFlight = 0;
 static std::atomic<bool> keepLoadingChunks(true);
+static std::atomic<long long> workerChunkWindow(0);   // chunkKey of the window centre, for workers
+
+// Every requested chunk that is not resident yet has one entry here (keyed by
+// chunkKey), so repeated requests merge and stale jobs can be dropped.
+static std::unordered_map<long long, ChunkJobState> chunkJobs;
+static unsigned int chunkRequestsMerged = 0;      // requests folded into an existing job
+static unsigned int chunkJobsCancelled = 0;       // dropped before any work was done
+static unsigned int chunkGenerationsWasted = 0;   // finished after leaving the window
+static unsigned int chunkGenerationsDuplicate = 0;// finished for an already resident chunk
+
+// On-disk tile cache. Every LOD of a chunk is one tile, keyed by chunk,
+// LOD and terrainNoiseHash; the timers are summed over all workers.
+static const std::string TERRAIN_CACHE_DIR = "terrain_cache";
+static bool terrainCacheEnabled = false;
+static unsigned long long terrainNoiseHash = 0;
+static std::atomic<unsigned int> terrainCacheHits(0);
+static std::atomic<unsigned int> terrainCacheMisses(0);
+static std::atomic<long long> terrainCacheLoadMicros(0);
+static std::atomic<long long> terrainGenerateMicros(0);
 static double lastTime = 0.0;
 static int nbFrames = 0;
 
@@ -130,265 +385,170 @@ static int nbFrames = 0;
     -----------------------
 
     - processInput, key_callback: Handle user input for camera movement, chunk updates.
-    - updateChunks: Dynamically requests chunk generation around the camera position.
-    - renderTerrainChunks, renderSun, renderTurbine, generateTurbineInstances, etc.: These do the rendering of different scene components or set up instancing.
-    - chunkLoadingTask: Runs on a background thread, generating LOD data for new chunks.
+    - updateChunks, chunkInWindow, forEachChunkOutsideWindow: Dynamically requests chunk generation around the camera position.
+    - renderTerrainChunks, renderSun, renderTurbine, renderSolarPanels, etc.: These queue the draws of different scene components.
+    - reportScatterRegion: Objects scattered per chunk around the origin (--scatter-report).
+    - chunkLoadingTask: Runs on each chunk worker thread, generating LOD data for the nearest requested chunk.
+    - startChunkWorkers, stopChunkWorkers, reprioritiseChunkRequests: Manage the worker pool and its request order.
+    - chunkKey, cancelStaleChunkRequests, reportChunkJobStats: Chunk job de-duplication, cancellation and counters.
+    - requestChunk, dispatchChunkRequests, chunkInWorkerWindow: Feed the lock-free request ring from the render thread's heap.
     - getLODIndex: Chooses an appropriate LOD based on distance from camera.
-    - getTerrainHeight, generateTerrain, setupTerrainBuffers: Helpers for creating or accessing terrain info.
+    - bindTerrainMegaBuffers: Points the terrain VAO and chunk origin texture at the megabuffers.
+    - initTerrainBuffers, destroyTerrainBuffers, releaseChunkBuffers, terrainLODVertexOffset: Megabuffer chunk slots with fence-guarded reuse.
+    - terrainVRAMOccupancy: Terrain buffer usage for the window title.
+    - reportFrameTimes: Frame time percentiles at exit (used with --flight-benchmark).
+    - loadChunkLODs, readCachedChunkLODs, writeCachedChunkLODs: Chunk LODs through the on-disk tile cache.
+    - reportRtinStats, reportRtinRegion: Adaptive RTIN chunk mesh statistics (--rtin-error, --rtin-report).
+    - initTerrainCache, computeTerrainNoiseHash, reportTerrainCacheStats, prebakeTerrainRegion: Tile cache setup, statistics and the --prebake mode.
+    - benchmarkTerrainNoise: Runtime versus compile-time specialised noise kernels (--noise-benchmark).
+    - createTerrainIndexBuffers: Shared, vertex-cache-ordered 16-bit index buffer per terrain LOD.
+    - cullScene: Frustum culls the chunk boxes and the instanced objects' bounding spheres for the main pass.
+    - loadModel, residentSetBytes: Loads a .glb into shared buffers (render/gltf_model) and reports its VRAM and RSS.
+    - modelBoundingSphere, turbineBaseModel, turbineMeshModel: Culling bounds of a loaded glTF model and the turbine's draw transforms.
+    - createShadowMap, renderShadowMap, destroyShadowMap, shadowCasterLOD: One shadow cascade with a cached static caster layer.
+    - createShadowCascadeArray, updateShadowCascades, fitShadowCascade, shadowCascadeBinding: Camera-fitted cascaded sun shadows.
+    - drawShadowTerrainChunks, drawShadowInstances: Light-frustum-culled shadow casters.
+    - configureShaderProgram, updateFrameUniforms: Per-program sampler units and block binding, and the shared per-frame uniform buffer.
+    - initRenderQueues, recordRenderQueueStats, stateChangeTotal: Pass states of the sorted draw queues and their state change counters.
+    - initCdlodTerrain, updateCdlodTerrain, renderCdlodTerrain, drawCdlodNodes, destroyCdlodTerrain: Quadtree CDLOD terrain (--cdlod).
+    - buildCdlodNodeVertices, uploadCdlodNodes, setupCdlodNodeBuffers, cdlodNodeKey, wakeChunkWorkers: CDLOD node generation and streaming.
+
+    Terrain sampling, the chunk LOD builders, height tiles and the object
+    scatter are in terrain/terrain_generator, which the bench target shares.
 */
 
 void processInput(GLFWwindow *window, float deltaTime);
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
 void updateChunks(int chunkX, int chunkZ);
-void renderTerrainChunks(GLuint shader, const glm::mat4& vpMatrix, GLuint texture, glm::mat4 lightSpaceMatrix, GLuint depthMap);
-void renderSun(GLuint shader, GLuint sunVAO, const glm::mat4& vpMatrix);
-void renderTurbine(const Turbine& turbine, GLuint shader, const glm::mat4& vpMatrix, glm::mat4 lightSpaceMatrix, GLuint depthMap);
-void generateTurbineInstances();
-void generateSolarPanelInstances(int panelCount);
-void renderSolarPanels(const SolarPanel& solarPanel, GLuint shader, const glm::mat4& vpMatrix,
+bool chunkInWindow(int chunkX, int chunkZ);
+bool chunkInWorkerWindow(int chunkX, int chunkZ);
+void requestChunk(int chunkX, int chunkZ, const glm::vec2& focus);
+void dispatchChunkRequests();
+long long chunkKey(int chunkX, int chunkZ);
+void cancelStaleChunkRequests();
+void reportChunkJobStats();
+void renderTerrainChunks(const ShaderProgram& shader, GLuint texture);
+void renderSun(const ShaderProgram& shader, GLuint sunVAO);
+void renderTurbine(const GltfModel& turbine, const ShaderProgram& shader);
+void renderSolarPanels(const GltfModel& solarPanel, const ShaderProgram& shader,
                        GLuint baseColor, GLuint normalMap, GLuint metallicMap, GLuint roughnessMap,
-                       GLuint aoMap, GLuint heightMap, GLuint emissiveMap, GLuint opacityMap, GLuint specularMap, glm::mat4 lightSpaceMatrix, GLuint depthMap);
-void renderHalo(GLuint shader, GLuint haloQuadVAO, const glm::mat4& vpMatrix);
+                       GLuint aoMap, GLuint heightMap, GLuint emissiveMap, GLuint opacityMap, GLuint specularMap);
+void renderHalo(const ShaderProgram& shader, GLuint haloQuadVAO);
+void renderSky(const ShaderProgram& shader, GLuint skyQuadVAO);
 void chunkLoadingTask();
+void startChunkWorkers(int workerCount);
+void stopChunkWorkers();
+void reprioritiseChunkRequests(const glm::vec3& focus);
+float chunkRequestPriority(int chunkX, int chunkZ, const glm::vec2& focus);
+std::vector<ChunkData> loadChunkLODs(int chunkX, int chunkZ);
+bool readCachedChunkLODs(int chunkX, int chunkZ, std::vector<ChunkData>& allLODData);
+void writeCachedChunkLODs(const std::vector<ChunkData>& allLODData);
+void initTerrainCache();
+unsigned long long computeTerrainNoiseHash();
+void reportTerrainCacheStats();
+int prebakeTerrainRegion(int minChunkX, int minChunkZ, int maxChunkX, int maxChunkZ);
+int benchmarkTerrainNoise();
 int getLODIndex(float distance);
-float getTerrainHeight(float globalX, float globalZ);
-std::vector<Vertex> generateTerrain(unsigned int gridSize, float gridScale, float heightScale, std::vector<unsigned int>& indices, int chunkX, int chunkZ);
-GLuint setupTerrainBuffers(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+void createTerrainIndexBuffers();
+void bindTerrainMegaBuffers();
+void initTerrainBuffers();
+BufferPoolOccupancy terrainVRAMOccupancy();
+void reportFrameTimes();
+void destroyTerrainBuffers();
+void releaseChunkBuffers(const Chunk& chunk);
+unsigned int terrainLODVertexOffset(int lod);
+void wakeChunkWorkers();
+void initCdlodTerrain();
+bool updateCdlodTerrain();
+void renderCdlodTerrain(const ShaderProgram& shader, GLuint texture);
+void drawCdlodNodes(const ShaderProgram& shader, RenderQueue& queue, int pass, unsigned int material);
+void destroyCdlodTerrain();
+std::vector<CdlodVertex> buildCdlodNodeVertices(const CdlodNode& node);
+void uploadCdlodNodes(double uploadStart, GLsizeiptr& uploadedBytes);
+GLuint setupCdlodNodeBuffers(GLuint slotVBO, GLuint sharedEBO);
+unsigned long long cdlodNodeKey(const CdlodNode& node);
+void reportRtinStats();
+int reportRtinRegion(float maxError, int radius);
+int reportScatterRegion(int radius);
+void cullScene(const Frustum& viewFrustum);
+glm::vec4 modelBoundingSphere(const GltfModel& model, const glm::mat4& transform, const glm::vec3* pivot);
+GltfModel loadModel(const char* path);
+size_t residentSetBytes();
+glm::mat4 turbineBaseModel();
+glm::mat4 turbineMeshModel(size_t mesh);
+ShadowMap createShadowMap(unsigned int size, GLuint depthArray, int layer);
+GLuint createShadowCascadeArray(unsigned int size, int layers);
+void updateShadowCascades(const glm::mat4& viewMatrix, float aspect, const GltfModel& turbine, const GltfModel& solarPanel,
+                          const ShaderProgram& terrainShadowShader, const ShaderProgram& cdlodShadowShader,
+                          const ShaderProgram& shadowShader);
+void fitShadowCascade(ShadowMap& shadowMap, const glm::mat4& viewMatrix, float aspect, float nearDistance, float farDistance);
+RenderTextureBinding shadowCascadeBinding();
+void destroyShadowMap(ShadowMap& shadowMap);
+void renderShadowMap(ShadowMap& shadowMap, const GltfModel& turbine, const GltfModel& solarPanel,
+                     const ShaderProgram& terrainShadowShader, const ShaderProgram& cdlodShadowShader,
+                     const ShaderProgram& shadowShader);
+int shadowCasterLOD(const glm::mat4& lightSpaceMatrix, unsigned int size);
+void drawShadowTerrainChunks(const ShaderProgram& shader, const Frustum& lightFrustum, int lod);
+void drawShadowInstances(const ShaderProgram& shader, InstanceBuffer& instanceBuffer, const Frustum& lightFrustum,
+                         const GltfModel& source, const std::vector<ShadowCasterMesh>& meshes);
+void configureShaderProgram(const ShaderProgram& program);
+void updateFrameUniforms(const glm::mat4& vpMatrix);
+void initRenderQueues();
+void recordRenderQueueStats();
+unsigned int stateChangeTotal(const GLStateCounters& counters);
+
+// Height/normal lookups on the resident LOD0 chunks, falling back to the
+// noise (getTerrainHeight) elsewhere. Safe to use from any thread.
+TerrainHeightQuery terrainHeights(GRID_SIZE * GRID_SCALE, getTerrainHeight);
 
 /*
     ---------------
     MODEL LOADING
     ---------------
-    These functions (loadTurbine, loadSolarPanel) load a glTF model from file 
-    and create the appropriate VBO/VAO/EBO structures in OpenGL. They iterate 
-    over each mesh + primitive in the glTF file, setting up attributes for 
-    POSITION, NORMAL, TEXCOORD, etc.
-*/
-
-Turbine loadTurbine(const char* path) {
-    tinygltf::Model model;
-    tinygltf::TinyGLTF loader;
-    std::string err, warn;
-
-    bool success = loader.LoadBinaryFromFile(&model, &err, &warn, path);
-    if (!warn.empty()) {
-        std::cerr << "Warning: " << warn << std::endl;
-    }
-    if (!success) {
-        std::cerr << "Failed to load turbine model: " << err << std::endl;
-        return {}; 
-    }
-
-    std::vector<TurbineMesh> turbineMeshes;
-
-    for (const auto& mesh : model.meshes) {
-        for (const auto& primitive : mesh.primitives) {
-            GLuint vao;
-            glGenVertexArrays(1, &vao);
-            glBindVertexArray(vao);
-
-            for (auto& attrib : primitive.attributes) {
-                const auto& accessor = model.accessors[attrib.second];
-                const auto& bufferView = model.bufferViews[accessor.bufferView];
-                const auto& buffer = model.buffers[bufferView.buffer];
-
-                GLuint vbo;
-                glGenBuffers(1, &vbo);
-                glBindBuffer(GL_ARRAY_BUFFER, vbo);
-                glBufferData(GL_ARRAY_BUFFER, bufferView.byteLength,
-                             &buffer.data[bufferView.byteOffset], GL_STATIC_DRAW);
-
-                GLint attribLocation = -1;
-                if (attrib.first == "POSITION") attribLocation = 0;
-                if (attrib.first == "NORMAL") attribLocation = 1;
-                if (attrib.first == "TEXCOORD_0") attribLocation = 2;
-                if (attrib.first == "TEXCOORD_1") {
-                    std::cerr << "Warning: TEXCOORD_1 is present but ignored." << std::endl;
-                    continue; 
-                }
-
-                if (attribLocation >= 0) {
-                    int componentCount = 0;
-                    switch (accessor.type) {
-                        case TINYGLTF_TYPE_VEC2: componentCount = 2; break;
-                        case TINYGLTF_TYPE_VEC3: componentCount = 3; break;
-                        case TINYGLTF_TYPE_VEC4: componentCount = 4; break;
-                        case TINYGLTF_TYPE_SCALAR: componentCount = 1; break;
-                        default: break;
-                    }
-
-                    glEnableVertexAttribArray(attribLocation);
-                    glVertexAttribPointer(
-                        attribLocation,
-                        componentCount,
-                        accessor.componentType,
-                        accessor.normalized ? GL_TRUE : GL_FALSE,
-                        int(accessor.ByteStride(bufferView)),
-                        (void*)(uintptr_t)accessor.byteOffset
-                    );
-                }
-            }
-
-            TurbineMesh tmesh;
-            tmesh.VAO = vao;
-            tmesh.EBO = 0;
-            tmesh.indexCount = 0;
-            tmesh.indexType = GL_UNSIGNED_INT;
-            tmesh.vertexCount = 0;
-
-            if (primitive.indices >= 0) {
-                const auto& indexAccessor = model.accessors[primitive.indices];
-                const auto& bufferView = model.bufferViews[indexAccessor.bufferView];
-                const auto& buffer = model.buffers[bufferView.buffer];
-
-                GLuint ebo;
-                glGenBuffers(1, &ebo);
-                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, bufferView.byteLength, &buffer.data[bufferView.byteOffset], GL_STATIC_DRAW);
-
-                GLsizei indexCount = static_cast<GLsizei>(indexAccessor.count);
-                GLenum indexType = GL_UNSIGNED_INT;
-
-                if (indexAccessor.componentType == TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT) {
-                    indexType = GL_UNSIGNED_SHORT;
-                } else if (indexAccessor.componentType == TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT) {
-                    indexType = GL_UNSIGNED_INT;
-                } else if (indexAccessor.componentType == TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE) {
-                    indexType = GL_UNSIGNED_BYTE;
-                }
-
-                tmesh.EBO = ebo;
-                tmesh.indexCount = indexCount;
-                tmesh.indexType = indexType;
-            } else {
-                int positionIndex = primitive.attributes.at("POSITION");
-                const auto& positionAccessor = model.accessors[positionIndex];
-                GLsizei vertexCount = static_cast<GLsizei>(positionAccessor.count);
-                tmesh.vertexCount = vertexCount;
-            }
-
-            turbineMeshes.push_back(tmesh);
-
-            glBindVertexArray(0);
-        }
-    }
-
-    Turbine turbine;
-    turbine.model = model;
-    turbine.meshes = turbineMeshes;
-    return turbine;
-}
-
-SolarPanel loadSolarPanel(const char* path) {
-    tinygltf::Model model;
-    tinygltf::TinyGLTF loader;
-    std::string err, warn;
-
-    bool success = loader.LoadBinaryFromFile(&model, &err, &warn, path);
-    if (!warn.empty()) {
-        std::cerr << "Warning: " << warn << std::endl;
-    }
-    if (!success) {
-        std::cerr << "Failed to load solar panel model: " << err << std::endl;
-        return {};
-    }
-
-    std::vector<SolarPanelMesh> solarPanelMeshes;
-
-    for (const auto& mesh : model.meshes) {
-        for (const auto& primitive : mesh.primitives) {
-            GLuint vao;
-            glGenVertexArrays(1, &vao);
-            glBindVertexArray(vao);
-
-            for (auto& attrib : primitive.attributes) {
-                const auto& accessor = model.accessors[attrib.second];
-                const auto& bufferView = model.bufferViews[accessor.bufferView];
-                const auto& buffer = model.buffers[bufferView.buffer];
-
-                GLuint vbo;
-                glGenBuffers(1, &vbo);
-                glBindBuffer(GL_ARRAY_BUFFER, vbo);
-                glBufferData(GL_ARRAY_BUFFER, bufferView.byteLength,
-                             &buffer.data[bufferView.byteOffset], GL_STATIC_DRAW);
-
-                GLint attribLocation = -1;
-                if (attrib.first == "POSITION") attribLocation = 0;
-                if (attrib.first == "NORMAL") attribLocation = 1;
-                if (attrib.first == "TEXCOORD_0") attribLocation = 2;
-                if (attrib.first == "TEXCOORD_1") attribLocation = 3;
-
-                if (attribLocation >= 0) {
-                    int componentCount = 0;
-                    switch (accessor.type) {
-                        case TINYGLTF_TYPE_VEC2: componentCount = 2; break;
-                        case TINYGLTF_TYPE_VEC3: componentCount = 3; break;
-                        case TINYGLTF_TYPE_VEC4: componentCount = 4; break;
-                        default: 
-                            std::cerr << "Unsupported accessor type for attribute " << attrib.first << std::endl;
-                            continue;
-                    }
-
-                    glEnableVertexAttribArray(attribLocation);
-                    glVertexAttribPointer(
-                        attribLocation,
-                        componentCount,
-                        accessor.componentType,
-                        accessor.normalized ? GL_TRUE : GL_FALSE,
-                        accessor.ByteStride(bufferView) > 0 ? accessor.ByteStride(bufferView) : componentCount * sizeof(float),
-                        (void*)(uintptr_t)accessor.byteOffset
-                    );
-                } else {
-                    std::cerr << "Unrecognized attribute: " << attrib.first << std::endl;
-                }
-            }
-
-            SolarPanelMesh spMesh = {vao, 0, 0, GL_UNSIGNED_INT, 0};
-
-            if (primitive.indices >= 0) {
-                const auto& indexAccessor = model.accessors[primitive.indices];
-                const auto& bufferView = model.bufferViews[indexAccessor.bufferView];
-                const auto& buffer = model.buffers[bufferView.buffer];
-
-                GLuint ebo;
-                glGenBuffers(1, &ebo);
-                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, bufferView.byteLength,
-                             &buffer.data[bufferView.byteOffset], GL_STATIC_DRAW);
-
-                spMesh.EBO = ebo;
-                spMesh.indexCount = indexAccessor.count;
-
-                switch (indexAccessor.componentType) {
-                    case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE:
-                        spMesh.indexType = GL_UNSIGNED_BYTE;
-                        break;
-                    case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT:
-                        spMesh.indexType = GL_UNSIGNED_SHORT;
-                        break;
-                    case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT:
-                        spMesh.indexType = GL_UNSIGNED_INT;
-                        break;
-                    default:
-                        std::cerr << "Unsupported index component type in GLTF file." << std::endl;
-                        break;
-                }
-            } else {
-                const auto& positionAccessor = model.accessors[primitive.attributes.at("POSITION")];
-                spMesh.vertexCount = positionAccessor.count;
-            }
+    loadModel loads a .glb file with LoadGltfModel (render/gltf_model), which
+    repacks every primitive into one interleaved VBO and one EBO shared
+    through a single VAO, and frees the parsed file once they are uploaded.
+    It prints the model's VRAM next to what uploading each referenced
+    bufferView per attribute would take, the CPU-side data freed, and the
+    process RSS before and after the load.
+*/
 
-            solarPanelMeshes.push_back(spMesh);
+GltfModel loadModel(const char* path)
+{
+    size_t rssBefore = residentSetBytes();
 
-            glBindVertexArray(0);
-        }
+    GltfModel model;
+    if (!LoadGltfModel(model, path)) {
+        return model;
     }
 
-    SolarPanel solarPanel;
-    solarPanel.model = model;
-    solarPanel.meshes = solarPanelMeshes;
+    printf("%s: %u primitives, %.2f MB in one VBO/EBO (%.2f MB as per-attribute bufferView uploads), "
+           "%.2f MB of CPU-side buffers and images freed, RSS %.1f -> %.1f MB\n",
+           path, (unsigned int)model.primitives.size(), model.uploadedBytes / (1024.0 * 1024.0),
+           model.bufferViewBytes / (1024.0 * 1024.0), model.cpuBytes / (1024.0 * 1024.0),
+           rssBefore / (1024.0 * 1024.0), residentSetBytes() / (1024.0 * 1024.0));
+    return model;
+}
+
+/*
+    ------------------
+    residentSetBytes
+    ------------------
+    Resident set size of the process, or 0 where /proc is not available.
+*/
 
-    return solarPanel;
+size_t residentSetBytes()
+{
+#ifdef __linux__
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    unsigned long sizePages = 0, residentPages = 0;
+    int read = fscanf(statm, "%lu %lu", &sizePages, &residentPages);
+    fclose(statm);
+    return read == 2 ? residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+    return 0;
+#endif
 }
 
 
@@ -540,38 +700,425 @@ GLuint createSunVAO() {
 
 /*
     ------------------------
-    setupTerrainBuffers
+    bindTerrainMegaBuffers
     ------------------------
-    Creates VAO/VBO/EBO for a batch of terrain vertices/indices. Used in LODLevel creation.
+    Points the terrain VAO at the vertex and index megabuffers and sizes the
+    chunk origin texture buffer to the vertex slots. Called at start-up and
+    again whenever a megabuffer grows, since growing replaces its buffer.
+    Both attributes are integer attributes; terrain.vert does the decoding.
 */
 
-GLuint setupTerrainBuffers(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
-    GLuint VAO, VBO, EBO;
+void bindTerrainMegaBuffers()
+{
+    glBindVertexArray(terrainVAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, terrainVertexBuffer.buffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, terrainIndexBuffer.buffer);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribIPointer(0, 1, GL_UNSIGNED_SHORT, sizeof(TerrainVertex), (void*)offsetof(TerrainVertex, height));
+    glEnableVertexAttribArray(1);
+    glVertexAttribIPointer(1, 2, GL_BYTE, sizeof(TerrainVertex), (void*)offsetof(TerrainVertex, normalOct));
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // One RG32F texel per vertex slot
+    GLuint slots = terrainVertexBuffer.capacity / terrainLODVertexOffset(NUM_TERRAIN_LODS);
+    terrainSlotOrigins.resize(slots, glm::vec2(0.0f));
+    glBindBuffer(GL_TEXTURE_BUFFER, terrainOriginBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, slots * sizeof(glm::vec2), terrainSlotOrigins.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_BUFFER, terrainOriginTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, terrainOriginBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+/*
+    ----------------------------
+    createTerrainIndexBuffers
+    ----------------------------
+    Every chunk at a given LOD has the same grid topology, so each LOD gets one
+    GL_UNSIGNED_SHORT index list (101x101 vertices fit in 16 bits), reordered
+    for the post-transform vertex cache, in terrainIndexBuffer that every
+    chunk at that LOD draws with its own base vertex.
+*/
+
+void createTerrainIndexBuffers()
+{
+    for (int lod = 0; lod < NUM_TERRAIN_LODS; ++lod) {
+        unsigned int gridSize = TERRAIN_LOD_GRID_SIZES[lod];
+        unsigned int vertexCount = (gridSize + 1) * (gridSize + 1);
+
+        std::vector<unsigned int> indices = buildTerrainIndices(gridSize);
+        float acmrBefore = ComputeACMR(indices, vertexCount, 16);
+        OptimizeVertexCache(indices, vertexCount);
+        float acmrAfter = ComputeACMR(indices, vertexCount, 16);
+
+        std::vector<unsigned short> shortIndices(indices.begin(), indices.end());
+
+        MegaBufferRange range;
+        bool grew = false;
+        if (!AllocateMegaBufferRange(terrainIndexBuffer, static_cast<GLuint>(shortIndices.size()), range, &grew)) {
+            std::cerr << "Terrain index buffer budget too small for the LOD" << lod << " indices; raise --terrain-vram-mb." << std::endl;
+            range.first = 0;
+            shortIndices.clear();
+        }
+        if (grew) bindTerrainMegaBuffers();
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, terrainIndexBuffer.buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, range.first * sizeof(unsigned short),
+                        shortIndices.size() * sizeof(unsigned short), shortIndices.data());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        terrainLODIndices[lod].firstIndex = range.first;
+        terrainLODIndices[lod].indexCount = static_cast<GLsizei>(shortIndices.size());
+
+        printf("Terrain LOD%d indices: %u x 16-bit, ACMR %.3f -> %.3f\n",
+               lod, (unsigned int)shortIndices.size(), acmrBefore, acmrAfter);
+    }
+}
+
+/*
+    ----------------------------
+    initTerrainBuffers
+    ----------------------------
+    Creates the terrain megabuffers, their VAO and the chunk origin texture.
+    A vertex slot holds every LOD of one chunk, and the vertex megabuffer
+    starts with room for the whole chunk window so that it only grows when
+    the view radius outgrows it. The two megabuffers share one budget: the
+    index buffer is reserved the shared LOD lists plus RTIN headroom, and the
+    vertex buffer gets what is left.
+*/
+
+void initTerrainBuffers()
+{
+    GLsizeiptr slotSize = terrainLODVertexOffset(NUM_TERRAIN_LODS) * sizeof(TerrainVertex);
+    GLsizeiptr totalBudgetBytes = static_cast<GLsizeiptr>(terrainVRAMBudgetMB * 1024.0f * 1024.0f);
+    long windowChunks = (2L * chunkViewRadius + 1) * (2L * chunkViewRadius + 1);
+
+    GLsizeiptr indexBudgetBytes = 0;
+    for (int lod = 0; lod < NUM_TERRAIN_LODS; ++lod) {
+        GLsizeiptr gridSize = TERRAIN_LOD_GRID_SIZES[lod];
+        indexBudgetBytes += gridSize * gridSize * 6 * sizeof(unsigned short);
+    }
+    if (rtinMaxError > 0.0f) {
+        indexBudgetBytes += static_cast<GLsizeiptr>(totalBudgetBytes * TERRAIN_RTIN_INDEX_SHARE);
+    }
+    indexBudgetBytes = std::min(indexBudgetBytes, totalBudgetBytes);
+    GLsizeiptr vertexBudgetBytes = totalBudgetBytes - indexBudgetBytes;
+
+    InitMegaBuffer(terrainVertexBuffer, sizeof(TerrainVertex), windowChunks * slotSize, vertexBudgetBytes);
+    InitMegaBuffer(terrainIndexBuffer, sizeof(unsigned short), TERRAIN_INDEX_BUFFER_INITIAL_SIZE, indexBudgetBytes);
+    InitUploadRing(terrainUploadRing, TERRAIN_UPLOAD_RING_SIZE);
+
+    glGenVertexArrays(1, &terrainVAO);
+    glGenBuffers(1, &terrainOriginBuffer);
+    glGenTextures(1, &terrainOriginTexture);
+    bindTerrainMegaBuffers();
+
+    printf("Terrain megabuffers: %ld B per chunk slot, %.1f MB for %ld slots allocated, budget %.1f MB "
+           "(vertices %.1f MB = %ld slots, indices %.1f MB)\n",
+           (long)slotSize, terrainVertexBuffer.capacity * terrainVertexBuffer.elementSize / (1024.0 * 1024.0),
+           (long)terrainSlotOrigins.size(), terrainVRAMBudgetMB, vertexBudgetBytes / (1024.0 * 1024.0),
+           (long)(vertexBudgetBytes / slotSize), indexBudgetBytes / (1024.0 * 1024.0));
+
+    if (vertexBudgetBytes / slotSize < windowChunks) {
+        std::cerr << "Warning: a view radius of " << chunkViewRadius << " needs "
+                  << windowChunks * slotSize / (1024.0 * 1024.0) << " MB of terrain buffers; raise --terrain-vram-mb." << std::endl;
+    }
+}
+
+/*
+    ----------------------------
+    terrainLODVertexOffset
+    ----------------------------
+    Vertex offset of a LOD inside a chunk slot; passing NUM_TERRAIN_LODS gives
+    the vertex count of the whole slot. RTIN chunks share one grid between
+    their LODs.
+*/
+
+unsigned int terrainLODVertexOffset(int lod)
+{
+    if (rtinMaxError > 0.0f) {
+        return lod < NUM_TERRAIN_LODS ? 0 : (RTIN_GRID_SIZE + 1) * (RTIN_GRID_SIZE + 1);
+    }
+
+    unsigned int offset = 0;
+    for (int i = 0; i < lod; ++i) {
+        offset += (TERRAIN_LOD_GRID_SIZES[i] + 1) * (TERRAIN_LOD_GRID_SIZES[i] + 1);
+    }
+    return offset;
+}
+
+/*
+    ----------------------------
+    reportFrameTimes
+    ----------------------------
+    Prints the mean, median, 99th percentile and worst frame time of a
+    --flight-benchmark run; normal sessions record no frame times.
+*/
+
+void reportFrameTimes()
+{
+    if (frameTimesMs.empty()) return;
+
+    std::vector<float> sorted(frameTimesMs);
+    std::sort(sorted.begin(), sorted.end());
+
+    double total = 0.0;
+    for (float frameTime : sorted) total += frameTime;
+
+    size_t p99 = std::min(sorted.size() - 1, static_cast<size_t>(sorted.size() * 0.99));
+    printf("Frame times over %u frames: mean %.2f ms, p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+           (unsigned int)sorted.size(), total / sorted.size(), sorted[sorted.size() / 2], sorted[p99], sorted.back());
+}
+
+/*
+    ----------------------------
+    releaseChunkBuffers
+    ----------------------------
+    Returns an evicted chunk's vertex slot and indices to the megabuffers. They
+    are only handed out again after a fence shows the GPU has finished the
+    draws that read them.
+*/
+
+void releaseChunkBuffers(const Chunk& chunk)
+{
+    if (chunk.vertexRange.count > 0) {
+        ReleaseMegaBufferRange(terrainVertexBuffer, chunk.vertexRange);
+    }
+    if (chunk.indexRange.count > 0) {
+        ReleaseMegaBufferRange(terrainIndexBuffer, chunk.indexRange);
+    }
+}
+
+/*
+    ----------------------------
+    destroyTerrainBuffers
+    ----------------------------
+    Frees all terrain GPU memory at shutdown: both megabuffers, their VAO and
+    the chunk origin texture.
+*/
+
+void destroyTerrainBuffers()
+{
+    for (const auto& chunk : activeChunks) {
+        releaseChunkBuffers(chunk);
+    }
+    activeChunks.Reset(activeChunks.Dimension());
+    terrainHeights.Clear();
+
+    MegaBufferOccupancy vertices = GetMegaBufferOccupancy(terrainVertexBuffer);
+    MegaBufferOccupancy indices = GetMegaBufferOccupancy(terrainIndexBuffer);
+    printf("Terrain megabuffers at exit: vertices %.1f / %.1f MB allocated (%u slots, grew %u times), "
+           "indices %.1f / %.1f MB allocated (grew %u times)\n",
+           vertices.allocatedBytes / (1024.0 * 1024.0), vertices.budgetBytes / (1024.0 * 1024.0),
+           (unsigned int)terrainSlotOrigins.size(), terrainVertexBuffer.growths,
+           indices.allocatedBytes / (1024.0 * 1024.0), indices.budgetBytes / (1024.0 * 1024.0), terrainIndexBuffer.growths);
+
+    DestroyMegaBuffer(terrainVertexBuffer);
+    DestroyMegaBuffer(terrainIndexBuffer);
+    DestroyUploadRing(terrainUploadRing);
+
+    glDeleteVertexArrays(1, &terrainVAO);
+    glDeleteBuffers(1, &terrainOriginBuffer);
+    glDeleteTextures(1, &terrainOriginTexture);
+    terrainSlotOrigins.clear();
+}
+
+/*
+    ----------------------------
+    terrainVRAMOccupancy
+    ----------------------------
+    Terrain buffer usage for the window title: the CDLOD node pool, or the
+    chunk megabuffers in the same terms, counted in vertex slots.
+*/
+
+BufferPoolOccupancy terrainVRAMOccupancy()
+{
+    if (cdlodEnabled) {
+        return GetBufferPoolOccupancy(cdlodBufferPool);
+    }
+
+    MegaBufferOccupancy vertices = GetMegaBufferOccupancy(terrainVertexBuffer);
+    MegaBufferOccupancy indices = GetMegaBufferOccupancy(terrainIndexBuffer);
+    GLsizeiptr slotSize = terrainLODVertexOffset(NUM_TERRAIN_LODS) * sizeof(TerrainVertex);
+
+    BufferPoolOccupancy occupancy;
+    occupancy.inUse = vertices.rangesInUse;
+    occupancy.pending = static_cast<unsigned int>(vertices.pendingBytes / slotSize);
+    occupancy.free = static_cast<unsigned int>((vertices.allocatedBytes - vertices.usedBytes - vertices.pendingBytes) / slotSize);
+    occupancy.allocatedBytes = vertices.allocatedBytes + indices.allocatedBytes;
+    occupancy.budgetBytes = static_cast<GLsizeiptr>(terrainVRAMBudgetMB * 1024.0f * 1024.0f);
+    return occupancy;
+}
+
+/*
+    ----------------------------
+    setupCdlodNodeBuffers
+    ----------------------------
+    Creates the VAO of one CDLOD node slot: both heights as one integer uvec2
+    attribute, both packed normals as one ivec4, and the shared node indices.
+*/
 
+GLuint setupCdlodNodeBuffers(GLuint slotVBO, GLuint sharedEBO)
+{
+    GLuint VAO;
     glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
 
     glBindVertexArray(VAO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, slotVBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sharedEBO);
 
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glVertexAttribIPointer(0, 2, GL_UNSIGNED_SHORT, sizeof(CdlodVertex), (void*)offsetof(CdlodVertex, height));
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+    glVertexAttribIPointer(1, 4, GL_BYTE, sizeof(CdlodVertex), (void*)offsetof(CdlodVertex, normalOct));
 
     glBindVertexArray(0);
 
     return VAO;
 }
 
+/*
+    ----------------------------
+    initCdlodTerrain
+    ----------------------------
+    Builds the index buffer every CDLOD node shares and sizes the node pool.
+    The indices are laid out quadrant by quadrant (each vertex-cache ordered
+    on its own), so a node that only covers some of its quadrants draws them
+    as contiguous index ranges.
+*/
+
+void initCdlodTerrain()
+{
+    const unsigned int half = CDLOD_GRID_SIZE / 2;
+    const unsigned int vertexCount = (CDLOD_GRID_SIZE + 1) * (CDLOD_GRID_SIZE + 1);
+
+    // buildTerrainIndices emits 6 indices per cell in row order
+    std::vector<unsigned int> gridIndices = buildTerrainIndices(CDLOD_GRID_SIZE);
+    std::vector<unsigned short> shortIndices;
+    shortIndices.reserve(gridIndices.size());
+
+    for (int quadrant = 0; quadrant < 4; ++quadrant) {
+        unsigned int firstX = (quadrant & 1) * half;
+        unsigned int firstZ = (quadrant >> 1) * half;
+
+        std::vector<unsigned int> quadrantIndices;
+        quadrantIndices.reserve(half * half * 6);
+        for (unsigned int z = firstZ; z < firstZ + half; ++z) {
+            for (unsigned int x = firstX; x < firstX + half; ++x) {
+                const unsigned int* cell = &gridIndices[(z * CDLOD_GRID_SIZE + x) * 6];
+                quadrantIndices.insert(quadrantIndices.end(), cell, cell + 6);
+            }
+        }
+
+        OptimizeVertexCache(quadrantIndices, vertexCount);
+        shortIndices.insert(shortIndices.end(), quadrantIndices.begin(), quadrantIndices.end());
+    }
+
+    glGenBuffers(1, &cdlodIndices.EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cdlodIndices.EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(unsigned short), shortIndices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    cdlodIndices.indexCount = static_cast<GLsizei>(shortIndices.size());
+
+    GLsizeiptr slotSize = vertexCount * sizeof(CdlodVertex);
+    InitBufferPool(cdlodBufferPool, slotSize, static_cast<GLsizeiptr>(terrainVRAMBudgetMB * 1024.0f * 1024.0f));
+
+    const int rootLevel = CDLOD_SETTINGS.levelCount - 1;
+    printf("CDLOD terrain: %d levels, %ux%u node grid, leaf %.0f, root %.0f, view range %.0f, %ld B per node slot\n",
+           CDLOD_SETTINGS.levelCount, CDLOD_GRID_SIZE, CDLOD_GRID_SIZE,
+           CDLOD_SETTINGS.leafNodeSize, CdlodNodeSize(CDLOD_SETTINGS, rootLevel),
+           CdlodLevelRange(CDLOD_SETTINGS, rootLevel), (long)slotSize);
+}
+
+/*
+    ----------------------------
+    uploadCdlodNodes
+    ----------------------------
+    Streams finished CDLOD nodes, coarsest first, into cdlodBufferPool
+    through terrainUploadRing. Shares pollLoadedChunks' per-frame byte and
+    time budget: uploadedBytes carries what that frame has already spent.
+*/
+
+void uploadCdlodNodes(double uploadStart, GLsizeiptr& uploadedBytes)
+{
+    if (cdlodUploadQueue.empty()) return;
+
+    // Finest first, so the coarsest node sits at the back
+    std::sort(cdlodUploadQueue.begin(), cdlodUploadQueue.end(),
+        [](const ChunkResult& a, const ChunkResult& b) {
+            return a.cdlodLevel < b.cdlodLevel;
+        }
+    );
+
+    const GLsizeiptr nodeBytes = cdlodBufferPool.slotSize;
+
+    while (!cdlodUploadQueue.empty())
+    {
+        if (uploadedBytes > 0 &&
+            (uploadedBytes + nodeBytes > terrainUploadBudgetKB * 1024.0f ||
+             (glfwGetTime() - uploadStart) * 1000.0 > terrainUploadBudgetMs)) {
+            break;
+        }
+
+        unsigned char* staging = static_cast<unsigned char*>(BeginStreamUpload(terrainUploadRing, nodeBytes));
+        if (!staging) break;
+
+        bool created = false;
+        int slot = AcquireBufferSlot(cdlodBufferPool, &created);
+        if (slot < 0) {
+            CancelStreamUpload(terrainUploadRing);
+            static bool warned = false;
+            if (!warned) {
+                std::cerr << "Terrain VRAM budget of " << terrainVRAMBudgetMB << " MB reached, deferring CDLOD node uploads." << std::endl;
+                warned = true;
+            }
+            break;
+        }
+        if (created) {
+            cdlodSlotVAOs.push_back(setupCdlodNodeBuffers(cdlodBufferPool.buffers[slot], cdlodIndices.EBO));
+        }
+
+        ChunkResult& front = cdlodUploadQueue.back();
+        CdlodNode node = { front.cdlodLevel, front.chunkX, front.chunkZ };
+        unsigned long long key = cdlodNodeKey(node);
+
+        std::memcpy(staging, front.nodeVertices.data(), nodeBytes);
+        EndStreamUpload(terrainUploadRing, cdlodBufferPool.buffers[slot], 0);
+        uploadedBytes += nodeBytes;
+        cdlodUploadQueue.pop_back();
+
+        cdlodNodeJobs.erase(key);
+        CdlodResidentNode resident = { slot, cdlodFrame };
+        cdlodNodes[key] = resident;
+    }
+}
+
+/*
+    ----------------------------
+    destroyCdlodTerrain
+    ----------------------------
+    Frees the CDLOD node slots, their VAOs and the shared node indices.
+*/
+
+void destroyCdlodTerrain()
+{
+    if (!cdlodEnabled) return;
+
+    cdlodNodes.clear();
+    DestroyBufferPool(cdlodBufferPool);
+
+    if (!cdlodSlotVAOs.empty()) {
+        glDeleteVertexArrays(static_cast<GLsizei>(cdlodSlotVAOs.size()), cdlodSlotVAOs.data());
+        cdlodSlotVAOs.clear();
+    }
+    glDeleteBuffers(1, &cdlodIndices.EBO);
+}
+
 /*
     -------------------------
     createHaloQuadVAO
@@ -618,17 +1165,112 @@ GLuint createHaloQuadVAO()
     ------------------------------------
     pollLoadedChunks
     ------------------------------------
-    Checks for newly generated chunk data from the chunk loading thread,
-    creates VAOs for each LOD level, and adds them to the activeChunks list.
+    Drains the worker result ring (never blocking on a worker) into
+    chunkUploadQueue and uploads the chunks nearest the camera first, until
+    this frame's byte or time budget is spent. Each chunk is written into the
+    streaming upload ring and copied into its megabuffer slot on the GPU.
+    Whatever does not fit (budget, a busy upload ring, or a full VRAM pool)
+    waits for the next frame. Chunks that left the window while they were
+    being generated, or that are already resident, are dropped. CDLOD nodes
+    share the same budget through uploadCdlodNodes. Finally the request ring
+    is topped up again.
 */
 
 void pollLoadedChunks()
 {
-    std::lock_guard<std::mutex> lock(chunkMutex);
-    while (!chunkDataQueue.empty())
+    CollectMegaBufferRanges(terrainVertexBuffer);
+    CollectMegaBufferRanges(terrainIndexBuffer);
+    CollectBufferSlots(cdlodBufferPool);
+
+    ChunkResult result;
+    while (chunkResultRing.TryPop(result)) {
+        chunkJobsInFlight--;
+        if (result.cdlodLevel >= 0)
+            cdlodUploadQueue.push_back(std::move(result));
+        else
+            chunkUploadQueue.push_back(std::move(result));
+    }
+
+    // Farthest first, so the nearest chunk sits at the back
+    glm::vec2 focus(eye_center.x, eye_center.z);
+    std::sort(chunkUploadQueue.begin(), chunkUploadQueue.end(),
+        [&focus](const ChunkResult& a, const ChunkResult& b) {
+            return chunkRequestPriority(a.chunkX, a.chunkZ, focus) > chunkRequestPriority(b.chunkX, b.chunkZ, focus);
+        }
+    );
+
+    const GLuint chunkVertices = terrainLODVertexOffset(NUM_TERRAIN_LODS);
+    const GLsizeiptr chunkBytes = chunkVertices * sizeof(TerrainVertex);
+    const double uploadStart = glfwGetTime();
+    GLsizeiptr uploadedBytes = 0;
+
+    while (!chunkUploadQueue.empty())
     {
-        std::vector<ChunkData> lodChunkData = chunkDataQueue.front();
-        chunkDataQueue.pop();
+        ChunkResult& front = chunkUploadQueue.back();
+        if (front.lods.empty()) {
+            // Skipped by a worker that saw an older window; ask again if still wanted
+            chunkJobsCancelled++;
+            chunkJobs.erase(chunkKey(front.chunkX, front.chunkZ));
+            if (chunkInWindow(front.chunkX, front.chunkZ)) {
+                requestChunk(front.chunkX, front.chunkZ, focus);
+            }
+            chunkUploadQueue.pop_back();
+            continue;
+        }
+        if (!chunkInWindow(front.chunkX, front.chunkZ)) {
+            chunkGenerationsWasted++;
+            chunkJobs.erase(chunkKey(front.chunkX, front.chunkZ));
+            chunkUploadQueue.pop_back();
+            continue;
+        }
+        if (activeChunks.Find(front.chunkX, front.chunkZ)) {
+            chunkGenerationsDuplicate++;
+            chunkJobs.erase(chunkKey(front.chunkX, front.chunkZ));
+            chunkUploadQueue.pop_back();
+            continue;
+        }
+
+        GLsizeiptr indexBytes = 0;
+        for (const ChunkData& lod : front.lods) {
+            indexBytes += lod.indices.size() * sizeof(unsigned short);
+        }
+
+        // At least one chunk per frame goes through, so uploads always make progress
+        if (uploadedBytes > 0 &&
+            (uploadedBytes + chunkBytes + indexBytes > terrainUploadBudgetKB * 1024.0f ||
+             (glfwGetTime() - uploadStart) * 1000.0 > terrainUploadBudgetMs)) {
+            break;
+        }
+
+        unsigned char* staging = static_cast<unsigned char*>(BeginStreamUpload(terrainUploadRing, chunkBytes));
+        if (!staging) break;
+
+        MegaBufferRange vertexRange;
+        MegaBufferRange indexRange = { 0, 0 };
+        bool vertexGrew = false, indexGrew = false;
+        bool allocated = AllocateMegaBufferRange(terrainVertexBuffer, chunkVertices, vertexRange, &vertexGrew);
+        if (allocated && indexBytes > 0) {
+            allocated = AllocateMegaBufferRange(terrainIndexBuffer, static_cast<GLuint>(indexBytes / sizeof(unsigned short)),
+                                                indexRange, &indexGrew);
+            if (!allocated) ReleaseMegaBufferRange(terrainVertexBuffer, vertexRange);
+        }
+        if (vertexGrew || indexGrew) {
+            bindTerrainMegaBuffers();
+        }
+        if (!allocated) {
+            CancelStreamUpload(terrainUploadRing);
+            static bool warned = false;
+            if (!warned) {
+                std::cerr << "Terrain VRAM budget of " << terrainVRAMBudgetMB << " MB reached, deferring chunk uploads." << std::endl;
+                warned = true;
+            }
+            break;
+        }
+
+        ChunkResult loaded = std::move(front);
+        std::vector<ChunkData>& lodChunkData = loaded.lods;
+        chunkUploadQueue.pop_back();
+        chunkJobs.erase(chunkKey(lodChunkData[0].chunkX, lodChunkData[0].chunkZ));
 
         glm::vec2 pos   = lodChunkData[0].position;
         int       cX    = lodChunkData[0].chunkX;
@@ -638,18 +1280,64 @@ void pollLoadedChunks()
         newChunk.position = pos;
         newChunk.chunkX   = cX;
         newChunk.chunkZ   = cZ;
-
-        for (auto& cd : lodChunkData)
+        newChunk.vertexRange = vertexRange;
+        newChunk.indexRange = indexRange;
+        newChunk.heightBounds = loaded.heightBounds;
+
+        // The staging region has the slot's layout, so one copy moves every LOD
+        std::vector<unsigned short> chunkIndices;
+        chunkIndices.reserve(indexBytes / sizeof(unsigned short));
+        for (size_t lod = 0; lod < lodChunkData.size(); ++lod)
         {
-            GLuint vao = setupTerrainBuffers(cd.vertices, cd.indices);
+            const std::vector<TerrainVertex>& vertices = lodChunkData[lod].vertices;
+            std::memcpy(staging + terrainLODVertexOffset(lod) * sizeof(TerrainVertex),
+                        vertices.data(), vertices.size() * sizeof(TerrainVertex));
+
+            const std::vector<unsigned short>& indices = lodChunkData[lod].indices;
+
             LODLevel level;
-            level.VAO        = vao;
-            level.indexCount = static_cast<unsigned int>(cd.indices.size());
+            level.indexCount = indices.empty() ? static_cast<unsigned int>(terrainLODIndices[lod].indexCount)
+                                               : static_cast<unsigned int>(indices.size());
+            level.firstIndex = indices.empty() ? terrainLODIndices[lod].firstIndex
+                                               : indexRange.first + static_cast<unsigned int>(chunkIndices.size());
+            level.baseVertex = static_cast<int>(vertexRange.first + terrainLODVertexOffset(lod));
             newChunk.lodLevels.push_back(level);
+
+            chunkIndices.insert(chunkIndices.end(), indices.begin(), indices.end());
+        }
+        EndStreamUpload(terrainUploadRing, terrainVertexBuffer.buffer, vertexRange.first * sizeof(TerrainVertex));
+        uploadedBytes += chunkBytes;
+
+        // RTIN indices go straight into the chunk's fresh index range: no
+        // draw reads it before the chunk becomes resident
+        if (!chunkIndices.empty()) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, terrainIndexBuffer.buffer);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, indexRange.first * sizeof(unsigned short), indexBytes, chunkIndices.data());
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            uploadedBytes += indexBytes;
         }
 
-        activeChunks.push_back(newChunk);
+        GLuint slot = vertexRange.first / chunkVertices;
+        terrainSlotOrigins[slot] = pos;
+        glBindBuffer(GL_TEXTURE_BUFFER, terrainOriginBuffer);
+        glBufferSubData(GL_TEXTURE_BUFFER, slot * sizeof(glm::vec2), sizeof(glm::vec2), &pos[0]);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        if (activeChunks.Insert(std::move(newChunk))) {
+            shadowCasterGeneration++;
+            terrainHeights.AddTile(cX, cZ, std::move(loaded.heightTile));
+            AddInstances(turbineInstances, chunkKey(cX, cZ), loaded.turbines);
+            AddInstances(solarPanelInstances, chunkKey(cX, cZ), loaded.solarPanels);
+        } else {
+            ReleaseMegaBufferRange(terrainVertexBuffer, vertexRange);
+            if (indexRange.count > 0) ReleaseMegaBufferRange(terrainIndexBuffer, indexRange);
+        }
     }
+
+    uploadCdlodNodes(uploadStart, uploadedBytes);
+
+    FenceUploadRing(terrainUploadRing);
+    dispatchChunkRequests();
 }
 
 /*
@@ -662,11 +1350,81 @@ void pollLoadedChunks()
     3. Configure shadow-map FBO.
     4. Load textures, models, and shaders.
     5. Create VAOs for the sun, halo, sky, etc.
-    6. Spawn chunk loading thread.
+    6. Spawn the chunk worker pool and load the chunk window (or the CDLOD quadtree).
     7. Main loop: handle input, poll new chunks, render passes (shadow, sky, terrain, objects).
 */
 
-int main() {
+int main(int argc, char** argv) {
+    initTerrainCache();
+
+    // --terrain-vram-mb N: budget shared by the terrain megabuffers (chunk vertices, chunk indices)
+    // --view-radius N: chunks kept around the camera chunk, 1 to MAX_CHUNK_VIEW_RADIUS
+    // --upload-budget-kb N, --upload-budget-ms N: per-frame terrain upload limits
+    // --flight-benchmark N: fly straight ahead for N seconds, then print frame times
+    // --cdlod: quadtree CDLOD terrain instead of the chunk window
+    // --rtin-error E: adaptive RTIN chunk meshes with a tolerance of E world units
+    // --scatter-density D: scattered turbine and solar panel candidates per area, relative to the default
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--cdlod") == 0) {
+            cdlodEnabled = true;
+        }
+    }
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--terrain-vram-mb") == 0) {
+            terrainVRAMBudgetMB = static_cast<float>(std::atof(argv[i + 1]));
+        }
+        if (std::strcmp(argv[i], "--view-radius") == 0) {
+            chunkViewRadius = glm::clamp(std::atoi(argv[i + 1]), 1, MAX_CHUNK_VIEW_RADIUS);
+        }
+        if (std::strcmp(argv[i], "--upload-budget-kb") == 0) {
+            terrainUploadBudgetKB = static_cast<float>(std::atof(argv[i + 1]));
+        }
+        if (std::strcmp(argv[i], "--upload-budget-ms") == 0) {
+            terrainUploadBudgetMs = static_cast<float>(std::atof(argv[i + 1]));
+        }
+        if (std::strcmp(argv[i], "--flight-benchmark") == 0) {
+            flightBenchmarkSeconds = static_cast<float>(std::atof(argv[i + 1]));
+        }
+        if (std::strcmp(argv[i], "--rtin-error") == 0) {
+            rtinMaxError = std::max(0.0f, static_cast<float>(std::atof(argv[i + 1])));
+        }
+        if (std::strcmp(argv[i], "--scatter-density") == 0) {
+            scatterDensity = std::max(0.01f, static_cast<float>(std::atof(argv[i + 1])));
+        }
+    }
+
+    // --prebake minX minZ maxX maxZ: bake the chunk rectangle into the tile cache and exit
+    if (argc > 1 && std::strcmp(argv[1], "--prebake") == 0) {
+        if (argc != 6) {
+            std::cerr << "Usage: " << argv[0] << " --prebake <minChunkX> <minChunkZ> <maxChunkX> <maxChunkZ>" << std::endl;
+            return -1;
+        }
+        return prebakeTerrainRegion(std::atoi(argv[2]), std::atoi(argv[3]), std::atoi(argv[4]), std::atoi(argv[5]));
+    }
+
+    // --noise-benchmark: compare the runtime and specialised noise kernels and exit
+    if (argc > 1 && std::strcmp(argv[1], "--noise-benchmark") == 0) {
+        return benchmarkTerrainNoise();
+    }
+
+    // --rtin-report maxError radius: mesh the chunks around the origin, print per-chunk savings and exit
+    if (argc > 1 && std::strcmp(argv[1], "--rtin-report") == 0) {
+        if (argc != 4 || std::atof(argv[2]) <= 0.0) {
+            std::cerr << "Usage: " << argv[0] << " --rtin-report <maxError> <chunkRadius>" << std::endl;
+            return -1;
+        }
+        return reportRtinRegion(static_cast<float>(std::atof(argv[2])), std::atoi(argv[3]));
+    }
+
+    // --scatter-report radius: scatter objects on the chunks around the origin, print the counts and exit
+    if (argc > 1 && std::strcmp(argv[1], "--scatter-report") == 0) {
+        if (argc < 3) {
+            std::cerr << "Usage: " << argv[0] << " --scatter-report <chunkRadius> [--scatter-density D]" << std::endl;
+            return -1;
+        }
+        return reportScatterRegion(std::atoi(argv[2]));
+    }
+
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW." << std::endl;
         return -1;
@@ -693,28 +1451,10 @@ int main() {
         return -1;
     }
 
-    const unsigned int SHADOW_WIDTH = 2048, SHADOW_HEIGHT = 2048;
-
-    GLuint depthMapFBO;
-    glGenFramebuffers(1, &depthMapFBO);
-
-    GLuint depthMap;
-    glGenTextures(1, &depthMap);
-    glBindTexture(GL_TEXTURE_2D, depthMap);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW_WIDTH, SHADOW_HEIGHT, 0,  GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-    float borderColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-
-    glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMap, 0);
-    glDrawBuffer(GL_NONE); 
-    glReadBuffer(GL_NONE);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    shadowCascadeArray = createShadowCascadeArray(SHADOW_CASCADE_SIZE, NUM_SHADOW_CASCADES);
+    for (int cascade = 0; cascade < NUM_SHADOW_CASCADES; ++cascade) {
+        shadowCascades[cascade] = createShadowMap(SHADOW_CASCADE_SIZE, shadowCascadeArray, cascade);
+    }
 
     GLuint grassTexture = loadTexture("../src/utils/grass.jpeg");
     if (grassTexture == 0) {
@@ -776,118 +1516,145 @@ int main() {
         return -1;
     }
 
-    GLuint terrainShader = LoadShadersFromFile("../src/shader/terrain.vert", "../src/shader/terrain.frag");
-    if (terrainShader == 0) {
+    ShaderProgram terrainShader = LoadProgramFromFile("../src/shader/terrain.vert", "../src/shader/terrain.frag");
+    if (terrainShader.id == 0) {
         std::cerr << "Failed to load terrain shaders." << std::endl;
         return -1;
     }
 
-    GLuint sunLightingShader = LoadShadersFromFile("../src/shader/sun.vert", "../src/shader/sun.frag");
-    if (sunLightingShader == 0) {
+    ShaderProgram sunLightingShader = LoadProgramFromFile("../src/shader/sun.vert", "../src/shader/sun.frag");
+    if (sunLightingShader.id == 0) {
         std::cerr << "Failed to load sun lighting shaders." << std::endl;
         return -1;
     }
 
-    GLuint turbineShader = LoadShadersFromFile("../src/shader/turbine.vert", "../src/shader/turbine.frag");
-    if (turbineShader == 0) {
+    ShaderProgram turbineShader = LoadProgramFromFile("../src/shader/turbine.vert", "../src/shader/turbine.frag");
+    if (turbineShader.id == 0) {
         std::cerr << "Failed to load turbine shaders." << std::endl;
         return -1;
     }
 
-    GLuint solarPanelShader = LoadShadersFromFile("../src/shader/solarPanel.vert", "../src/shader/solarPanel.frag");
-    if (solarPanelShader == 0) {
+    ShaderProgram solarPanelShader = LoadProgramFromFile("../src/shader/solarPanel.vert", "../src/shader/solarPanel.frag");
+    if (solarPanelShader.id == 0) {
         std::cerr << "Failed to load solar panel shaders." << std::endl;
         return -1;
     }
 
-    GLuint haloShader = LoadShadersFromFile("../src/shader/halo.vert", "../src/shader/halo.frag");
-     if (haloShader == 0) {
+    ShaderProgram haloShader = LoadProgramFromFile("../src/shader/halo.vert", "../src/shader/halo.frag");
+     if (haloShader.id == 0) {
         std::cerr << "Failed to load halo shaders." << std::endl;
         return -1;
     }
 
-    GLuint shadowShader = LoadShadersFromFile("../src/shader/shadow.vert", "../src/shader/shadow.frag");
-     if (shadowShader == 0) {
+    ShaderProgram shadowShader = LoadProgramFromFile("../src/shader/shadow.vert", "../src/shader/shadow.frag");
+     if (shadowShader.id == 0) {
         std::cerr << "Failed to load shadow shaders." << std::endl;
         return -1;
     }
 
-    GLuint skyShader = LoadShadersFromFile("../src/shader/sky.vert", "../src/shader/sky.frag");
-    if (skyShader == 0) {
+    ShaderProgram terrainShadowShader = LoadProgramFromFile("../src/shader/terrain_shadow.vert", "../src/shader/shadow.frag");
+    if (terrainShadowShader.id == 0) {
+        std::cerr << "Failed to load terrain shadow shaders." << std::endl;
+        return -1;
+    }
+
+    ShaderProgram cdlodShader = LoadProgramFromFile("../src/shader/terrain_cdlod.vert", "../src/shader/terrain.frag");
+    if (cdlodShader.id == 0) {
+        std::cerr << "Failed to load CDLOD terrain shaders." << std::endl;
+        return -1;
+    }
+
+    ShaderProgram cdlodShadowShader = LoadProgramFromFile("../src/shader/terrain_cdlod_shadow.vert", "../src/shader/shadow.frag");
+    if (cdlodShadowShader.id == 0) {
+        std::cerr << "Failed to load CDLOD terrain shadow shaders." << std::endl;
+        return -1;
+    }
+
+    ShaderProgram skyShader = LoadProgramFromFile("../src/shader/sky.vert", "../src/shader/sky.frag");
+    if (skyShader.id == 0) {
         std::cerr << "Failed to load sky shaders." << std::endl;
         return -1;
     }
 
+    for (const ShaderProgram* program : { &terrainShader, &sunLightingShader, &turbineShader, &solarPanelShader, &haloShader,
+                                          &shadowShader, &terrainShadowShader, &cdlodShader, &cdlodShadowShader, &skyShader }) {
+        configureShaderProgram(*program);
+    }
+    InitFrameUniformBuffer(frameUniforms);
+
     GLuint sunVAO = createSunVAO();
     GLuint haloQuadVAO = createHaloQuadVAO();
     GLuint skyQuadVAO = createSkyQuadVAO();
 
-    keepLoadingChunks = true;
-    chunkThread = std::thread(chunkLoadingTask);
-
-    updateChunks(currentChunkX, currentChunkZ);
+    initTerrainBuffers();
+    createTerrainIndexBuffers();
+    startChunkWorkers(chunkWorkerCount);
 
-    while (!chunkRequests.empty()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        pollLoadedChunks();
-    }
+    if (cdlodEnabled) {
+        // The quadtree's coarsest level reaches past the chunk window's far plane
+        initCdlodTerrain();
+        zFar = std::max(zFar, CdlodLevelRange(CDLOD_SETTINGS, CDLOD_SETTINGS.levelCount - 1));
 
-    glm::mat4 projectionMatrix = glm::perspective(glm::radians(FoV), 1024.0f / 768.0f, zNear, zFar);
+        while (!updateCdlodTerrain()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            pollLoadedChunks();
 
-    float orthoSize = 7000.0f; 
-    glm::mat4 lightProjection = glm::ortho( -orthoSize, orthoSize, -orthoSize, orthoSize, 0.1f, 5000.0f);
-    glm::vec3 lightPos = eye_center - sunlightDirection * 1000.0f; 
-    glm::mat4 lightView = glm::lookAt(lightPos, lightPos + sunlightDirection, glm::vec3(0, 1, 0));
-    glm::mat4 lightSpaceMatrix = lightProjection * lightView;
-
-    glEnable(GL_DEPTH_TEST);
-
-    Turbine turbine = loadTurbine("../src/model/turbine/Turbine.glb");
-
-    SolarPanel solarPanel = loadSolarPanel("../src/model/solarpanel/SolarPanel.glb");
-
-    generateTurbineInstances();
-    generateSolarPanelInstances(20);
-
-    glGenBuffers(1, &instanceVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
-    glBufferData(GL_ARRAY_BUFFER, turbineInstances.size() * sizeof(glm::mat4), &turbineInstances[0], GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    for (auto& tmesh : turbine.meshes) {
-        glBindVertexArray(tmesh.VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
-
-        std::size_t vec4Size = sizeof(glm::vec4);
-        for (int i = 0; i < 4; i++) {
-            glEnableVertexAttribArray(3 + i);
-            glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(i * vec4Size));
-            glVertexAttribDivisor(3 + i, 1);
+            // Stop waiting if the VRAM budget cannot hold the whole selection
+            BufferPoolOccupancy occupancy = GetBufferPoolOccupancy(cdlodBufferPool);
+            if (!cdlodUploadQueue.empty() && occupancy.free == 0 &&
+                occupancy.allocatedBytes + cdlodBufferPool.slotSize > occupancy.budgetBytes) break;
         }
+    } else {
+        updateChunks(currentChunkX, currentChunkZ);
 
-        glBindVertexArray(0);
+        while (true) {
+            if (chunkRequests.empty()) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            pollLoadedChunks();
+        }
     }
 
-    glGenBuffers(1, &solarPanelInstanceVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, solarPanelInstanceVBO);
-    glBufferData(GL_ARRAY_BUFFER, solarPanelInstances.size() * sizeof(glm::mat4), &solarPanelInstances[0], GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    const float aspectRatio = 1024.0f / 768.0f;
+    glm::mat4 projectionMatrix = glm::perspective(glm::radians(FoV), aspectRatio, zNear, zFar);
 
-    for (auto& mesh : solarPanel.meshes) {
-        glBindVertexArray(mesh.VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, solarPanelInstanceVBO);
+    glEnable(GL_DEPTH_TEST);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    initRenderQueues();
+
+    GltfModel turbine = loadModel("../src/model/turbine/Turbine.glb");
+
+    GltfModel solarPanel = loadModel("../src/model/solarpanel/SolarPanel.glb");
+
+    // Filled by pollLoadedChunks as chunks arrive; the buffers grow as needed.
+    // The rotor spins about the hub, so the turbine's sphere is centred there.
+    InitInstanceBuffer(turbineInstances, INITIAL_INSTANCE_CAPACITY,
+                       modelBoundingSphere(turbine, turbineBaseModel(), &TURBINE_BLADE_HUB));
+    InitInstanceBuffer(solarPanelInstances, INITIAL_INSTANCE_CAPACITY,
+                       modelBoundingSphere(solarPanel, glm::mat4(1.0f), nullptr));
+
+    // Attribute 3 is the index of the instance's matrix in the instanceMatrices texture buffer
+    if (turbine.VAO != 0) {
+        glBindVertexArray(turbine.VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, turbineInstances.visibleBuffer);
+        glEnableVertexAttribArray(3);
+        glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(unsigned int), (void*)0);
+        glVertexAttribDivisor(3, 1);
+        glBindVertexArray(0);
+    }
 
-        for (int i = 0; i < 4; i++) {
-            glEnableVertexAttribArray(3 + i);
-            glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(i * sizeof(glm::vec4)));
-            glVertexAttribDivisor(3 + i, 1);
-        }
+    if (solarPanel.VAO != 0) {
+        glBindVertexArray(solarPanel.VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, solarPanelInstances.visibleBuffer);
+        glEnableVertexAttribArray(3);
+        glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(unsigned int), (void*)0);
+        glVertexAttribDivisor(3, 1);
         glBindVertexArray(0);
     }
 
     glClearColor(0.5f, 0.7f, 1.0f, 1.0f);
 
     double frameStartTime = glfwGetTime();
+    const double flightStartTime = frameStartTime;
 
     /*
         ---------------------------------
@@ -895,10 +1662,10 @@ int main() {
         ---------------------------------
         1) Calculate delta time and FPS.
         2) Process input (camera movement).
-        3) Poll for newly loaded chunks.
+        3) Poll for newly loaded chunks (and reselect CDLOD nodes).
         4) Render scene in two passes:
-           - Shadow pass: render terrain, turbines, solar panels from light's POV.
-           - Main pass: render sky, terrain, sun, halo, turbines, solar panels.
+           - Shadow pass: refit and redraw the cascades due this frame (cached static casters + blades).
+           - Main pass: queue sky, terrain, sun, halo, turbines, solar panels, then submit them sorted.
     */
 
     while (!glfwWindowShouldClose(window)) {
@@ -910,7 +1677,17 @@ int main() {
         nbFrames++;
         if (currentTime - lastTime >= 1.0) { 
             double fps = double(nbFrames);
-            std::string title = "Towards a Futuristic Emerald Isle. FPS: " + std::to_string(fps);
+            BufferPoolOccupancy occupancy = terrainVRAMOccupancy();
+            char poolStatus[400];
+            snprintf(poolStatus, sizeof(poolStatus), " | Terrain VRAM %.1f/%.0f MB, %u %s, %u pending, %u free | terrain %u packets, %.2fM tris"
+                     " | main pass %u draws in %u GL calls | culled %u chunks, objects %u drawn / %u culled in %.3f ms | state changes %u of %u",
+                     occupancy.allocatedBytes / (1024.0 * 1024.0), occupancy.budgetBytes / (1024.0 * 1024.0),
+                     occupancy.inUse, cdlodEnabled ? "nodes" : "chunks", occupancy.pending, occupancy.free,
+                     terrainDrawPackets, terrainTrianglesDrawn / 1000000.0,
+                     mainRenderQueue.submittedDraws, mainRenderQueue.issuedDraws,
+                     chunksCulled, objectsDrawn, objectsCulled, cullMs,
+                     stateChangeTotal(mainRenderQueue.state.issued), stateChangeTotal(mainRenderQueue.state.requested));
+            std::string title = "Towards a Futuristic Emerald Isle. FPS: " + std::to_string(fps) + poolStatus;
             glfwSetWindowTitle(window, title.c_str()); 
             nbFrames = 0;
             lastTime += 1.0;
@@ -918,108 +1695,38 @@ int main() {
 
         processInput(window, deltaTime);
         pollLoadedChunks();
+        if (cdlodEnabled) {
+            updateCdlodTerrain();
+        }
+        FlushInstanceBuffer(turbineInstances);
+        FlushInstanceBuffer(solarPanelInstances);
 
         glm::mat4 viewMatrix = glm::lookAt(eye_center, lookat, up);
         glm::mat4 vpMatrix = projectionMatrix * viewMatrix;
 
-        glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-        glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-        glClear(GL_DEPTH_BUFFER_BIT);
-
-        glUseProgram(shadowShader);
-        GLuint lightSpaceLoc = glGetUniformLocation(shadowShader, "lightSpaceMatrix");
-        glUniformMatrix4fv(lightSpaceLoc, 1, GL_FALSE, &lightSpaceMatrix[0][0]);
-
-        {
-            GLint modelLoc = glGetUniformLocation(shadowShader, "model");
-            for (const auto& chunk : activeChunks) {
-                int lodIndex = 0; 
-                glm::mat4 terrainModel = glm::mat4(1.0f);
-                glUniformMatrix4fv(modelLoc, 1, GL_FALSE, &terrainModel[0][0]);
-                const LODLevel& lodLevel = chunk.lodLevels[lodIndex];
-                glBindVertexArray(lodLevel.VAO);
-                glDrawElements(GL_TRIANGLES, lodLevel.indexCount, GL_UNSIGNED_INT, nullptr);
-            }
-        }
-
-        {
-            GLint modelLoc = glGetUniformLocation(shadowShader, "model");
-            glm::mat4 identityModel = glm::mat4(1.0f);
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, &identityModel[0][0]);
-
-            for (size_t i = 0; i < turbine.meshes.size(); ++i) {
-                glBindVertexArray(turbine.meshes[i].VAO);
-
-                if (turbine.meshes[i].indexCount > 0) {
-                    glDrawElementsInstanced(
-                        GL_TRIANGLES,
-                        turbine.meshes[i].indexCount,
-                        turbine.meshes[i].indexType,
-                        0,
-                        NUM_TURBINES
-                    );
-                } else {
-                    glDrawArraysInstanced(
-                        GL_TRIANGLES,
-                        0,
-                        turbine.meshes[i].vertexCount,
-                        NUM_TURBINES
-                    );
-                }
-            }
-        }
-
-        {
-            GLint modelLoc = glGetUniformLocation(shadowShader, "model");
-            glm::mat4 identityModel = glm::mat4(1.0f);
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, &identityModel[0][0]);
-
-            for (const auto& mesh : solarPanel.meshes) {
-                glBindVertexArray(mesh.VAO);
-
-                if (mesh.indexCount > 0) {
-                    glDrawElementsInstanced(
-                        GL_TRIANGLES,
-                        mesh.indexCount,
-                        mesh.indexType,
-                        0,
-                        static_cast<GLsizei>(solarPanelInstances.size())
-                    );
-                } else {
-                    glDrawArraysInstanced(
-                        GL_TRIANGLES,
-                        0,
-                        mesh.vertexCount,
-                        static_cast<GLsizei>(solarPanelInstances.size())
-                    );
-                }
-            }
-        }
-
-        glBindVertexArray(0);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        turbineBladeRotation = fmod(turbineBladeRotation + glfwGetTime() * TURBINE_BLADE_SPEED, 360.0f);
+        updateShadowCascades(viewMatrix, aspectRatio, turbine, solarPanel, terrainShadowShader, cdlodShadowShader, shadowShader);
+        updateFrameUniforms(vpMatrix);
 
         int windowWidth, windowHeight;
         glfwGetFramebufferSize(window, &windowWidth, &windowHeight);
         glViewport(0, 0, windowWidth, windowHeight);
         
         glClear(GL_DEPTH_BUFFER_BIT);
-        glDisable(GL_DEPTH_TEST);
-        glUseProgram(skyShader);
-        glBindVertexArray(skyQuadVAO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        glEnable(GL_DEPTH_TEST);
-
-        renderTerrainChunks(terrainShader, vpMatrix, grassTexture, lightSpaceMatrix, depthMap);
-        glDepthMask(GL_FALSE);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        renderSun(sunLightingShader, sunVAO, vpMatrix);
-        renderHalo(haloShader, haloQuadVAO, vpMatrix);
-        glDisable(GL_BLEND);
-        glDepthMask(GL_TRUE);
-        renderTurbine(turbine, turbineShader, vpMatrix, lightSpaceMatrix, depthMap);
-        renderSolarPanels(solarPanel, solarPanelShader, vpMatrix, baseColor, normalMap, metallicMap, roughnessMap, aoMap, heightMap, emissiveMap, opacityMap, specularMap, lightSpaceMatrix, depthMap);
+
+        ClearRenderQueue(mainRenderQueue);
+        cullScene(ExtractFrustum(vpMatrix));
+        renderSky(skyShader, skyQuadVAO);
+        if (cdlodEnabled)
+            renderCdlodTerrain(cdlodShader, grassTexture);
+        else
+            renderTerrainChunks(terrainShader, grassTexture);
+        renderSun(sunLightingShader, sunVAO);
+        renderHalo(haloShader, haloQuadVAO);
+        renderTurbine(turbine, turbineShader);
+        renderSolarPanels(solarPanel, solarPanelShader, baseColor, normalMap, metallicMap, roughnessMap, aoMap, heightMap, emissiveMap, opacityMap, specularMap);
+        SubmitRenderQueue(mainRenderQueue);
+        recordRenderQueueStats();
 
         glfwSwapBuffers(window);
         glfwPollEvents();
@@ -1027,14 +1734,59 @@ int main() {
         double frameEndTime = glfwGetTime();
         double frameDuration = frameEndTime - frameStartTime;
         frameStartTime = glfwGetTime(); 
+        if (flightBenchmarkSeconds > 0.0f) {
+            frameTimesMs.push_back(static_cast<float>(frameDuration * 1000.0));
+            if (frameEndTime - flightStartTime >= flightBenchmarkSeconds) {
+                glfwSetWindowShouldClose(window, GL_TRUE);
+            }
+        }
+    }
+
+    reportFrameTimes();
+
+    stopChunkWorkers();
+    reportChunkJobStats();
+    reportRtinStats();
+    printf("Terrain height queries: %llu from resident chunks, %llu from noise\n",
+           terrainHeights.ResidentQueries(), terrainHeights.FallbackQueries());
+    printf("Scattered objects at exit: %d turbines, %d solar panels, %.1f MB of instance uploads\n",
+           InstanceCount(turbineInstances), InstanceCount(solarPanelInstances),
+           (turbineInstances.uploadedBytes + solarPanelInstances.uploadedBytes) / (1024.0 * 1024.0));
+    if (cullFrames > 0) {
+        printf("Frustum culling: %.4f ms mean, %.4f ms max per frame over %llu frames\n",
+               cullTotalMs / cullFrames, cullMaxMs, cullFrames);
     }
+    if (renderQueueFrames > 0) {
+        printf("Main pass state changes per frame over %u frames, %.1f draws in %.1f GL draw calls: requested / issued\n"
+               "  programs %.1f / %.1f, vertex arrays %.1f / %.1f, textures %.1f / %.1f, uniforms %.1f / %.1f, render states %.1f / %.1f\n",
+               renderQueueFrames, double(renderQueueDraws) / renderQueueFrames, double(renderQueueDrawCalls) / renderQueueFrames,
+               double(renderStatesRequested.programs) / renderQueueFrames, double(renderStatesIssued.programs) / renderQueueFrames,
+               double(renderStatesRequested.vertexArrays) / renderQueueFrames, double(renderStatesIssued.vertexArrays) / renderQueueFrames,
+               double(renderStatesRequested.textures) / renderQueueFrames, double(renderStatesIssued.textures) / renderQueueFrames,
+               double(renderStatesRequested.uniforms) / renderQueueFrames, double(renderStatesIssued.uniforms) / renderQueueFrames,
+               double(renderStatesRequested.renderStates) / renderQueueFrames, double(renderStatesIssued.renderStates) / renderQueueFrames);
+    }
+    if (shadowFrames > 0) {
+        printf("Shadow cascades: %.2f updates and %.2fM texels written per frame over %u frames (one 2048^2 map per frame: %.2fM); "
+               "static layers drawn %u times, the last with %u chunks at LOD %d in %u draw calls, %u outside its light frustum\n",
+               double(shadowCascadeUpdates) / shadowFrames, shadowTexelsWritten / 1e6 / shadowFrames, shadowFrames,
+               2048.0 * 2048.0 / 1e6, staticShadowRenders, shadowChunksDrawn, shadowTerrainLOD, shadowTerrainDrawCalls, shadowChunksCulled);
+    }
+    for (ShadowMap& cascade : shadowCascades) {
+        destroyShadowMap(cascade);
+    }
+    glDeleteTextures(1, &shadowCascadeArray);
+    DestroyFrameUniformBuffer(frameUniforms);
+    destroyCdlodTerrain();
+    destroyTerrainBuffers();
+    DestroyInstanceBuffer(turbineInstances);
+    DestroyInstanceBuffer(solarPanelInstances);
+    DestroyGltfModel(turbine);
+    DestroyGltfModel(solarPanel);
 
     glfwTerminate();
 
-    keepLoadingChunks = false;
-    if (chunkThread.joinable()) {
-        chunkThread.join();
-    }
+    reportTerrainCacheStats();
 
     return 0;
 }
@@ -1044,37 +1796,36 @@ int main() {
     ---------------------------------------------------
     renderTerrainChunks
     ---------------------------------------------------
-    Renders each active chunk using the appropriate LOD.
+    Queues each chunk cullScene left visible using the appropriate LOD.
     Chooses an LOD level based on camera distance to chunk center.
+    Every chunk is one base-vertex draw packet at its distance from the
+    camera. The packets only differ in their index range and base vertex
+    within a LOD, and the LOD bands follow the distance, so the queue issues
+    one multi-draw per LOD.
 */
 
-void renderTerrainChunks(GLuint shader, const glm::mat4& vpMatrix, GLuint texture, glm::mat4 lightSpaceMatrix, GLuint depthMap)
+void renderTerrainChunks(const ShaderProgram& shader, GLuint texture)
 {
-    glUseProgram(shader);
-
-    GLint vpLoc = glGetUniformLocation(shader, "vpMatrix");
-    glUniformMatrix4fv(vpLoc, 1, GL_FALSE, &vpMatrix[0][0]);
-
-    GLint lightSpaceLoc = glGetUniformLocation(shader, "lightSpaceMatrix");
-    glUniformMatrix4fv(lightSpaceLoc, 1, GL_FALSE, &lightSpaceMatrix[0][0]);
-
-    glActiveTexture(GL_TEXTURE9);
-    glBindTexture(GL_TEXTURE_2D, depthMap);
-    GLint shadowMapLoc = glGetUniformLocation(shader, "shadowMap");
-    glUniform1i(shadowMapLoc, 9);
-
-    glUniform3fv(glGetUniformLocation(shader, "lightDir"), 1, &sunlightDirection[0]);
-    glUniform3fv(glGetUniformLocation(shader, "lightColor"), 1, &sunlightColor[0]);
-    glUniform3f(glGetUniformLocation(shader, "viewPos"),
-                eye_center.x, eye_center.y, eye_center.z);
+    const RenderTextureBinding textures[] = {
+        { 0, GL_TEXTURE_2D, texture },
+        shadowCascadeBinding(),
+        { 11, GL_TEXTURE_BUFFER, terrainOriginTexture }
+    };
+    unsigned int material = AddRenderMaterial(mainRenderQueue, textures, 3);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glUniform1i(glGetUniformLocation(shader, "terrainTexture"), 0);
+    GLint gridSizeLoc = UniformLocation(shader, "gridSize");
+    GLint gridScaleLoc = UniformLocation(shader, "gridScale");
+    GLint heightRangeLoc = UniformLocation(shader, "heightRange");
+    GLint slotVerticesLoc = UniformLocation(shader, "slotVertices");
+    GLint lodVertexOffsetLoc = UniformLocation(shader, "lodVertexOffset");
+    const glm::vec2 heightRange(TERRAIN_HEIGHT_MIN, TERRAIN_HEIGHT_MAX - TERRAIN_HEIGHT_MIN);
+    const int slotVertices = static_cast<int>(terrainLODVertexOffset(NUM_TERRAIN_LODS));
 
-    GLint modelMatrixLoc = glGetUniformLocation(shader, "modelMatrix");
+    terrainDrawPackets = 0;
+    terrainTrianglesDrawn = 0;
 
-    for (const auto& chunk : activeChunks) {
+    for (unsigned int visibleIndex : visibleChunks) {
+        const Chunk& chunk = *chunkCullCandidates[visibleIndex];
         glm::vec3 chunkCenter(
             chunk.position.x + (GRID_SIZE * GRID_SCALE * 0.5f),
             0.0f,
@@ -1088,15 +1839,175 @@ void renderTerrainChunks(GLuint shader, const glm::mat4& vpMatrix, GLuint textur
         }
         const LODLevel& lodLevel = chunk.lodLevels[lodIndex];
 
-        glm::mat4 chunkModel = glm::translate(
-            glm::mat4(1.0f),
-            glm::vec3(chunk.position.x, 0.0f, chunk.position.y)
-        );
+        DrawPacket& packet = PushDrawPacket(mainRenderQueue, RENDER_PASS_OPAQUE, shader.id, material, terrainVAO, distance);
+        packet.count = lodLevel.indexCount;
+        packet.indexType = GL_UNSIGNED_SHORT;
+        packet.first = lodLevel.firstIndex * sizeof(unsigned short);
+        packet.baseVertex = lodLevel.baseVertex;
+        PushDrawUniform(mainRenderQueue, gridSizeLoc, static_cast<int>(terrainLODGridSize(lodIndex)));
+        PushDrawUniform(mainRenderQueue, gridScaleLoc, GRID_SCALE * (static_cast<float>(GRID_SIZE) / terrainLODGridSize(lodIndex)));
+        PushDrawUniform(mainRenderQueue, heightRangeLoc, heightRange);
+        PushDrawUniform(mainRenderQueue, slotVerticesLoc, slotVertices);
+        PushDrawUniform(mainRenderQueue, lodVertexOffsetLoc, static_cast<int>(terrainLODVertexOffset(lodIndex)));
+
+        terrainDrawPackets++;
+        terrainTrianglesDrawn += lodLevel.indexCount / 3;
+    }
+}
+
+/*
+    ---------------------------------------------------
+    updateCdlodTerrain
+    ---------------------------------------------------
+    Selects this frame's CDLOD nodes around the camera, evicts nodes the
+    selection has not visited for CDLOD_EVICT_FRAMES frames, and hands the
+    missing nodes to the chunk workers, coarsest level first and then nearest
+    first, within the same dispatch depth as chunk jobs. Returns true when
+    every node the selection wanted was resident.
+*/
+
+bool updateCdlodTerrain()
+{
+    cdlodFrame++;
+
+    std::vector<CdlodNode> missing;
+    cdlodSelection.clear();
+    SelectCdlodNodes(CDLOD_SETTINGS, eye_center,
+        [](const CdlodNode& node) {
+            auto it = cdlodNodes.find(cdlodNodeKey(node));
+            if (it == cdlodNodes.end()) return false;
+            it->second.lastUsedFrame = cdlodFrame;
+            return true;
+        },
+        cdlodSelection, missing);
+
+    for (auto it = cdlodNodes.begin(); it != cdlodNodes.end(); ) {
+        if (cdlodFrame - it->second.lastUsedFrame > CDLOD_EVICT_FRAMES) {
+            ReleaseBufferSlot(cdlodBufferPool, it->second.bufferSlot);
+            it = cdlodNodes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    glm::vec2 focus(eye_center.x, eye_center.z);
+    auto nodeDistance = [&focus](const CdlodNode& node) {
+        float size = CdlodNodeSize(CDLOD_SETTINGS, node.level);
+        glm::vec2 offset = glm::vec2((node.x + 0.5f) * size, (node.z + 0.5f) * size) - focus;
+        return glm::dot(offset, offset);
+    };
+    std::sort(missing.begin(), missing.end(),
+        [&nodeDistance](const CdlodNode& a, const CdlodNode& b) {
+            if (a.level != b.level) return a.level > b.level;
+            return nodeDistance(a) < nodeDistance(b);
+        }
+    );
+
+    int depth = std::min(static_cast<int>(chunkWorkers.size()) * CHUNK_DISPATCH_DEPTH,
+                         static_cast<int>(chunkRequestRing.Capacity()));
+
+    bool dispatched = false;
+    for (const CdlodNode& node : missing) {
+        if (chunkJobsInFlight >= depth) break;
+
+        unsigned long long key = cdlodNodeKey(node);
+        if (cdlodNodeJobs.count(key)) continue;
+
+        ChunkRequest request = { node.x, node.z, nodeDistance(node), node.level };
+        if (!chunkRequestRing.TryPush(std::move(request))) break;
+
+        cdlodNodeJobs.insert(key);
+        chunkJobsInFlight++;
+        chunkRequestsAvailable++;
+        dispatched = true;
+    }
+
+    if (dispatched) {
+        wakeChunkWorkers();
+    }
+
+    return missing.empty();
+}
+
+/*
+    ---------------------------------------------------
+    renderCdlodTerrain
+    ---------------------------------------------------
+    Main-pass counterpart of renderTerrainChunks for the CDLOD quadtree:
+    same lighting and shadow inputs, one draw per run of selected quadrants.
+*/
+
+void renderCdlodTerrain(const ShaderProgram& shader, GLuint texture)
+{
+    const RenderTextureBinding textures[] = {
+        { 0, GL_TEXTURE_2D, texture },
+        shadowCascadeBinding()
+    };
+
+    terrainDrawPackets = 0;
+    terrainTrianglesDrawn = 0;
+    drawCdlodNodes(shader, mainRenderQueue, RENDER_PASS_OPAQUE, AddRenderMaterial(mainRenderQueue, textures, 2));
+}
 
-        glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &chunkModel[0][0]);
+/*
+    ---------------------------------------------------
+    drawCdlodNodes
+    ---------------------------------------------------
+    Queues cdlodSelection for a terrain_cdlod(_shadow) program. Nodes are
+    placed and morphed by per-packet uniforms; adjacent selected quadrants
+    are merged into one draw since the shared indices are stored quadrant by
+    quadrant.
+*/
 
-        glBindVertexArray(lodLevel.VAO);
-        glDrawElements(GL_TRIANGLES, lodLevel.indexCount, GL_UNSIGNED_INT, 0);
+void drawCdlodNodes(const ShaderProgram& shader, RenderQueue& queue, int pass, unsigned int material)
+{
+    GLint gridSizeLoc = UniformLocation(shader, "gridSize");
+    GLint heightRangeLoc = UniformLocation(shader, "heightRange");
+    GLint texCoordScaleLoc = UniformLocation(shader, "texCoordScale");
+    GLint nodeOriginLoc = UniformLocation(shader, "nodeOrigin");
+    GLint nodeSpacingLoc = UniformLocation(shader, "nodeSpacing");
+    GLint morphRangeLoc = UniformLocation(shader, "morphRange");
+    // The shadow pass runs before this frame's FrameUniforms are sent, so its
+    // program takes the camera as a uniform; the main pass reads viewPos
+    GLint cameraPosLoc = UniformLocation(shader, "cameraPos");
+    const glm::vec2 heightRange(TERRAIN_HEIGHT_MIN, TERRAIN_HEIGHT_MAX - TERRAIN_HEIGHT_MIN);
+
+    const GLsizei quadrantIndexCount = cdlodIndices.indexCount / 4;
+
+    for (const CdlodSelectedNode& selected : cdlodSelection) {
+        auto resident = cdlodNodes.find(cdlodNodeKey(selected.node));
+        if (resident == cdlodNodes.end()) continue;
+
+        float size = CdlodNodeSize(CDLOD_SETTINGS, selected.node.level);
+        glm::vec2 nodeOrigin(selected.node.x * size, selected.node.z * size);
+        float distance = glm::distance(glm::vec2(eye_center.x, eye_center.z), nodeOrigin + glm::vec2(size * 0.5f));
+        GLuint vertexArray = cdlodSlotVAOs[resident->second.bufferSlot];
+
+        int quadrant = 0;
+        while (quadrant < 4) {
+            if (!(selected.quadrantMask & (1 << quadrant))) {
+                ++quadrant;
+                continue;
+            }
+            int first = quadrant;
+            while (quadrant < 4 && (selected.quadrantMask & (1 << quadrant))) ++quadrant;
+
+            GLsizei count = (quadrant - first) * quadrantIndexCount;
+            DrawPacket& packet = PushDrawPacket(queue, pass, shader.id, material, vertexArray, distance);
+            packet.count = count;
+            packet.indexType = GL_UNSIGNED_SHORT;
+            packet.first = first * quadrantIndexCount * sizeof(unsigned short);
+            PushDrawUniform(queue, gridSizeLoc, static_cast<int>(CDLOD_GRID_SIZE));
+            PushDrawUniform(queue, heightRangeLoc, heightRange);
+            // One texture repeat per chunk, as in the chunk renderer
+            PushDrawUniform(queue, texCoordScaleLoc, 1.0f / (GRID_SIZE * GRID_SCALE));
+            PushDrawUniform(queue, cameraPosLoc, eye_center);
+            PushDrawUniform(queue, nodeOriginLoc, nodeOrigin);
+            PushDrawUniform(queue, nodeSpacingLoc, size / CDLOD_GRID_SIZE);
+            PushDrawUniform(queue, morphRangeLoc, selected.morphRange);
+            terrainDrawPackets++;
+            terrainTrianglesDrawn += count / 3;
+        }
     }
 }
 
@@ -1107,9 +2018,7 @@ void renderTerrainChunks(GLuint shader, const glm::mat4& vpMatrix, GLuint textur
     Renders a small sphere in front of the camera to represent the sun in the sky.
 */
 
-void renderSun(GLuint shader, GLuint sunVAO, const glm::mat4& vpMatrix) {
-    glUseProgram(shader);
-
+void renderSun(const ShaderProgram& shader, GLuint sunVAO) {
     float forwardDistance = 200.0f; 
     float rightOffset     = 75.0f; 
     float upOffset        = 50.0f; 
@@ -1118,18 +2027,15 @@ void renderSun(GLuint shader, GLuint sunVAO, const glm::mat4& vpMatrix) {
     glm::mat4 model = glm::translate(glm::mat4(1.0f), sunPosition);
     model = glm::scale(model, glm::vec3(7.5f));
 
-    glUniformMatrix4fv(glGetUniformLocation(shader, "model"), 1, GL_FALSE, &model[0][0]);
-    glUniformMatrix4fv(glGetUniformLocation(shader, "vpMatrix"), 1, GL_FALSE, &vpMatrix[0][0]);
-
     glm::vec3 brightSunColor = glm::vec3(1.0f, 0.98f, 0.90f);
-    glUniform3fv(glGetUniformLocation(shader, "lightColor"), 1, &brightSunColor[0]);
-    glUniform1f(glGetUniformLocation(shader, "intensity"), 5.0f);
-
-    glm::vec3 dir = glm::normalize(glm::vec3(-1.0f, -1.0f, -1.0f));
-    glUniform3fv(glGetUniformLocation(shader, "lightDir"), 1, &dir[0]);
 
-    glBindVertexArray(sunVAO);
-    glDrawElements(GL_TRIANGLES, 36 * 18 * 6, GL_UNSIGNED_INT, 0);
+    DrawPacket& packet = PushDrawPacket(mainRenderQueue, RENDER_PASS_BLENDED, shader.id, AddRenderMaterial(mainRenderQueue, nullptr, 0),
+                                        sunVAO, glm::distance(sunPosition, eye_center));
+    packet.count = 36 * 18 * 6;
+    packet.indexType = GL_UNSIGNED_INT;
+    PushDrawUniform(mainRenderQueue, UniformLocation(shader, "model"), model);
+    PushDrawUniform(mainRenderQueue, UniformLocation(shader, "sunColor"), brightSunColor);
+    PushDrawUniform(mainRenderQueue, UniformLocation(shader, "intensity"), 5.0f);
 }
 
 /*
@@ -1137,12 +2043,11 @@ void renderSun(GLuint shader, GLuint sunVAO, const glm::mat4& vpMatrix) {
     renderHalo
     -------------
     Renders a screen-aligned quad with a halo effect around the sun.
-    This is drawn in transparency mode on top of the scene.
+    This is drawn in transparency mode on top of the scene; it is queued at
+    the front of the sun's sphere so it blends over the sun.
 */
 
-void renderHalo(GLuint shader, GLuint haloQuadVAO, const glm::mat4& vpMatrix) {
-    glUseProgram(shader);
-
+void renderHalo(const ShaderProgram& shader, GLuint haloQuadVAO) {
     float forwardDistance = 200.0f;
     float rightOffset = 75.0f;
     float upOffset = 50.0f;
@@ -1160,74 +2065,63 @@ void renderHalo(GLuint shader, GLuint haloQuadVAO, const glm::mat4& vpMatrix) {
                         * billboard
                         * glm::scale(glm::mat4(1.0f), glm::vec3(50.0f)); 
 
-    glUniformMatrix4fv(glGetUniformLocation(shader, "vpMatrix"), 1, GL_FALSE, &vpMatrix[0][0]);
-    glUniformMatrix4fv(glGetUniformLocation(shader, "model"), 1, GL_FALSE, &modelHalo[0][0]);
-
     glm::vec3 haloColor = glm::vec3(1.0f, 0.95f, 0.8f); 
-    glUniform3fv(glGetUniformLocation(shader, "haloColor"), 1, &haloColor[0]);
 
-    glUniform1f(glGetUniformLocation(shader, "haloAlpha"), 0.3f);  
-    glUniform1f(glGetUniformLocation(shader, "haloIntensity"), 1.0f);  
+    DrawPacket& packet = PushDrawPacket(mainRenderQueue, RENDER_PASS_BLENDED, shader.id, AddRenderMaterial(mainRenderQueue, nullptr, 0),
+                                        haloQuadVAO, glm::distance(sunPos, eye_center) - 7.5f);
+    packet.count = 6;
+    packet.indexType = GL_UNSIGNED_INT;
+    PushDrawUniform(mainRenderQueue, UniformLocation(shader, "model"), modelHalo);
+    PushDrawUniform(mainRenderQueue, UniformLocation(shader, "haloColor"), haloColor);
+    PushDrawUniform(mainRenderQueue, UniformLocation(shader, "haloAlpha"), 0.3f);
+    PushDrawUniform(mainRenderQueue, UniformLocation(shader, "haloIntensity"), 1.0f);
+}
+
+/*
+    -------------
+    renderSky
+    -------------
+    Queues the full-screen sky gradient, drawn first without depth testing.
+*/
 
-    glBindVertexArray(haloQuadVAO);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+void renderSky(const ShaderProgram& shader, GLuint skyQuadVAO) {
+    DrawPacket& packet = PushDrawPacket(mainRenderQueue, RENDER_PASS_SKY, shader.id, AddRenderMaterial(mainRenderQueue, nullptr, 0),
+                                        skyQuadVAO, 0.0f);
+    packet.count = 6;
+    packet.indexType = GL_UNSIGNED_INT;
 }
 
 /*
     ----------------
     renderTurbine
     ----------------
-    Draws the wind turbines using instancing. Each instance transform is 
-    loaded in the instance VBO. One special mesh (blades) is rotated over time.
+    Queues the wind turbines using instancing. Each instance transform is 
+    loaded in the instance VBO; only the instances cullScene kept are drawn.
+    One special mesh (blades) is rotated over time.
 */
 
-void renderTurbine(const Turbine& turbine, GLuint shader, const glm::mat4& vpMatrix, glm::mat4 lightSpaceMatrix, GLuint depthMap) {
-    glUseProgram(shader);
-
-    GLint lightSpaceLoc = glGetUniformLocation(shader, "lightSpaceMatrix");
-    glUniformMatrix4fv(lightSpaceLoc, 1, GL_FALSE, &lightSpaceMatrix[0][0]);
-    glActiveTexture(GL_TEXTURE9);
-    glBindTexture(GL_TEXTURE_2D, depthMap);
-    GLint shadowMapLoc = glGetUniformLocation(shader, "shadowMap");
-    glUniform1i(shadowMapLoc, 9);
-
-    static float bladeRotation = 0.0f;
-    float rotationSpeed = 0.10f;
-    bladeRotation += glfwGetTime() * rotationSpeed;
-    bladeRotation = fmod(bladeRotation, 360.0f);
-
-    glm::mat4 baseModelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(50.0f, -5.0f, 50.0f));
-    baseModelMatrix = glm::rotate(baseModelMatrix, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-    baseModelMatrix = glm::scale(baseModelMatrix, glm::vec3(1.0f));
-
-    glm::vec3 bladeAttachmentPoint(0.0f, 70.0f, 0.0f);
-    glm::vec3 rotationCircleScale(0.5f, 0.5f, 0.5f);
+void renderTurbine(const GltfModel& turbine, const ShaderProgram& shader) {
+    GLsizei instanceCount = UploadVisibleInstances(turbineInstances);
+    if (instanceCount == 0)
+        return;
 
-    for (size_t i = 0; i < turbine.meshes.size(); ++i) {
-        glm::mat4 modelMatrix = baseModelMatrix;
-
-        if (i == 16) {  
-            modelMatrix = glm::translate(modelMatrix, bladeAttachmentPoint);
-            modelMatrix = glm::scale(modelMatrix, rotationCircleScale);
-            modelMatrix = glm::rotate(modelMatrix, glm::radians(bladeRotation), glm::vec3(0.0f, 0.0f, 1.0f));
-            modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0f) / rotationCircleScale);
-            modelMatrix = glm::translate(modelMatrix, -bladeAttachmentPoint);
-        }
-
-        glUniformMatrix4fv(glGetUniformLocation(shader, "model"), 1, GL_FALSE, &modelMatrix[0][0]);
-        glUniformMatrix4fv(glGetUniformLocation(shader, "vpMatrix"), 1, GL_FALSE, &vpMatrix[0][0]);
-        glUniform3f(glGetUniformLocation(shader, "lightColor"), 1.0f, 1.0f, 1.0f);
-        glUniform3f(glGetUniformLocation(shader, "lightDir"), -1.0f, -1.0f, -1.0f);
-        glUniform3f(glGetUniformLocation(shader, "viewPos"), eye_center.x, eye_center.y, eye_center.z);
-        glUniform1i(glGetUniformLocation(shader, "isBlade"), (i == 16) ? 1 : 0);
-
-        glBindVertexArray(turbine.meshes[i].VAO);
-
-        if (turbine.meshes[i].indexCount > 0) {
-            glDrawElementsInstanced(GL_TRIANGLES, turbine.meshes[i].indexCount, turbine.meshes[i].indexType, 0, NUM_TURBINES);
-        } else {
-            glDrawArraysInstanced(GL_TRIANGLES, 0, turbine.meshes[i].vertexCount, NUM_TURBINES);
-        }
+    const RenderTextureBinding textures[] = {
+        shadowCascadeBinding(),
+        { 10, GL_TEXTURE_BUFFER, turbineInstances.texture }
+    };
+    unsigned int material = AddRenderMaterial(mainRenderQueue, textures, 2);
+
+    GLint modelLoc = UniformLocation(shader, "model");
+    for (size_t i = 0; i < turbine.primitives.size(); ++i) {
+        const GltfPrimitive& primitive = turbine.primitives[i];
+        DrawPacket& packet = PushDrawPacket(mainRenderQueue, RENDER_PASS_OPAQUE, shader.id, material, turbine.VAO, 0.0f);
+        packet.mode = primitive.mode;
+        packet.count = primitive.indexCount;
+        packet.indexType = turbine.indexType;
+        packet.first = primitive.firstIndex;
+        packet.baseVertex = primitive.baseVertex;
+        packet.instanceCount = instanceCount;
+        PushDrawUniform(mainRenderQueue, modelLoc, turbineMeshModel(i));
     }
 }
 
@@ -1239,399 +2133,1404 @@ void renderTurbine(const Turbine& turbine, GLuint shader, const glm::mat4& vpMat
     and also instanced.
 */
 
-void renderSolarPanels(const SolarPanel& solarPanel, GLuint shader, const glm::mat4& vpMatrix,
+void renderSolarPanels(const GltfModel& solarPanel, const ShaderProgram& shader,
                        GLuint baseColor, GLuint normalMap, GLuint metallicMap, GLuint roughnessMap,
-                       GLuint aoMap, GLuint heightMap, GLuint emissiveMap, GLuint opacityMap, GLuint specularMap, glm::mat4 lightSpaceMatrix, GLuint depthMap) {
-    glUseProgram(shader);
-    GLint lightSpaceLoc = glGetUniformLocation(shader, "lightSpaceMatrix");
-    glUniformMatrix4fv(lightSpaceLoc, 1, GL_FALSE, &lightSpaceMatrix[0][0]);
-
-    glActiveTexture(GL_TEXTURE9);
-    glBindTexture(GL_TEXTURE_2D, depthMap);
-    GLint shadowMapLoc = glGetUniformLocation(shader, "shadowMap");
-    glUniform1i(shadowMapLoc, 9);
-    glUniform1f(glGetUniformLocation(shader, "normalBlendFactor"), 1.0f);
-    glUniform3fv(glGetUniformLocation(shader, "viewPos"), 1, &eye_center[0]);
-    glUniform3fv(glGetUniformLocation(shader, "lightDir"), 1, &sunlightDirection[0]);
-    glUniform3fv(glGetUniformLocation(shader, "lightColor"), 1, &sunlightColor[0]);
-
-    GLint vpMatrixLoc = glGetUniformLocation(shader, "vpMatrix");
-    glUniformMatrix4fv(vpMatrixLoc, 1, GL_FALSE, &vpMatrix[0][0]);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, baseColor);
-    glUniform1i(glGetUniformLocation(shader, "baseColorMap"), 0);
-
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, normalMap);
-    glUniform1i(glGetUniformLocation(shader, "normalMap"), 1);
-
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, metallicMap);
-    glUniform1i(glGetUniformLocation(shader, "metallicMap"), 2);
-
-    glActiveTexture(GL_TEXTURE3);
-    glBindTexture(GL_TEXTURE_2D, roughnessMap);
-    glUniform1i(glGetUniformLocation(shader, "roughnessMap"), 3);
-
-    glActiveTexture(GL_TEXTURE4);
-    glBindTexture(GL_TEXTURE_2D, aoMap);
-    glUniform1i(glGetUniformLocation(shader, "aoMap"), 4);
-
-    glActiveTexture(GL_TEXTURE5);
-    glBindTexture(GL_TEXTURE_2D, heightMap);
-    glUniform1i(glGetUniformLocation(shader, "heightMap"), 5);
-
-    glActiveTexture(GL_TEXTURE6);
-    glBindTexture(GL_TEXTURE_2D, emissiveMap);
-    glUniform1i(glGetUniformLocation(shader, "emissiveMap"), 6);
-
-    glActiveTexture(GL_TEXTURE7);
-    glBindTexture(GL_TEXTURE_2D, opacityMap);
-    glUniform1i(glGetUniformLocation(shader, "opacityMap"), 7);
-
-    glActiveTexture(GL_TEXTURE8);
-    glBindTexture(GL_TEXTURE_2D, specularMap);
-    glUniform1i(glGetUniformLocation(shader, "specularMap"), 8);
-
-    for (const auto& mesh : solarPanel.meshes) {
-        glBindVertexArray(mesh.VAO);
-        if (mesh.indexCount > 0) {
-            glDrawElementsInstanced(GL_TRIANGLES, mesh.indexCount, mesh.indexType, 0, static_cast<GLsizei>(solarPanelInstances.size()));
-        } else {
-            glDrawArraysInstanced(GL_TRIANGLES, 0, mesh.vertexCount, static_cast<GLsizei>(solarPanelInstances.size()));
-        }
+                       GLuint aoMap, GLuint heightMap, GLuint emissiveMap, GLuint opacityMap, GLuint specularMap) {
+    GLsizei instanceCount = UploadVisibleInstances(solarPanelInstances);
+    if (instanceCount == 0)
+        return;
+
+    const RenderTextureBinding textures[] = {
+        { 0, GL_TEXTURE_2D, baseColor },
+        { 1, GL_TEXTURE_2D, normalMap },
+        { 2, GL_TEXTURE_2D, metallicMap },
+        { 3, GL_TEXTURE_2D, roughnessMap },
+        { 4, GL_TEXTURE_2D, aoMap },
+        { 5, GL_TEXTURE_2D, heightMap },
+        { 6, GL_TEXTURE_2D, emissiveMap },
+        { 7, GL_TEXTURE_2D, opacityMap },
+        { 8, GL_TEXTURE_2D, specularMap },
+        shadowCascadeBinding(),
+        { 10, GL_TEXTURE_BUFFER, solarPanelInstances.texture }
+    };
+    unsigned int material = AddRenderMaterial(mainRenderQueue, textures, 11);
+
+    GLint normalBlendFactorLoc = UniformLocation(shader, "normalBlendFactor");
+    for (const GltfPrimitive& primitive : solarPanel.primitives) {
+        DrawPacket& packet = PushDrawPacket(mainRenderQueue, RENDER_PASS_OPAQUE, shader.id, material, solarPanel.VAO, 0.0f);
+        packet.mode = primitive.mode;
+        packet.count = primitive.indexCount;
+        packet.indexType = solarPanel.indexType;
+        packet.first = primitive.firstIndex;
+        packet.baseVertex = primitive.baseVertex;
+        packet.instanceCount = instanceCount;
+        PushDrawUniform(mainRenderQueue, normalBlendFactorLoc, 1.0f);
     }
 }
 
 
 /*
-    -------------
-    getLODIndex
-    -------------
-    Simple LOD heuristic: closer chunks get more detail, 
-    farther chunks get less detail.
+    ----------------
+    cullScene
+    ----------------
+    Tests every resident chunk's box (its footprint times heightBounds) and
+    every scattered object's bounding sphere against the view frustum. The
+    chunks to draw are left in visibleChunks, the objects in each instance
+    buffer's visible list. Bounds are kept as structure-of-arrays, so both
+    tests run four at a time (CullBoxes, CullSpheres).
 */
 
-int getLODIndex(float distance)
+void cullScene(const Frustum& viewFrustum)
 {
-    if (distance < 400.0f)
-        return 0;  
-    else if (distance < 800.0f)
-        return 1; 
-    else
-        return 2; 
+    double cullStart = glfwGetTime();
+
+    const float chunkSize = GRID_SIZE * GRID_SCALE;
+    chunkCullCandidates.clear();
+    chunkCullBounds.minX.clear();
+    chunkCullBounds.minY.clear();
+    chunkCullBounds.minZ.clear();
+    chunkCullBounds.maxX.clear();
+    chunkCullBounds.maxY.clear();
+    chunkCullBounds.maxZ.clear();
+    for (const auto& chunk : activeChunks) {
+        chunkCullCandidates.push_back(&chunk);
+        chunkCullBounds.minX.push_back(chunk.position.x);
+        chunkCullBounds.minY.push_back(chunk.heightBounds.x);
+        chunkCullBounds.minZ.push_back(chunk.position.y);
+        chunkCullBounds.maxX.push_back(chunk.position.x + chunkSize);
+        chunkCullBounds.maxY.push_back(chunk.heightBounds.y);
+        chunkCullBounds.maxZ.push_back(chunk.position.y + chunkSize);
+    }
+
+    visibleChunks.clear();
+    CullBoxes(viewFrustum, chunkCullBounds, visibleChunks);
+    CullInstances(turbineInstances, &viewFrustum);
+    CullInstances(solarPanelInstances, &viewFrustum);
+
+    cullMs = (glfwGetTime() - cullStart) * 1000.0;
+    cullTotalMs += cullMs;
+    cullMaxMs = std::max(cullMaxMs, cullMs);
+    cullFrames++;
+
+    chunksCulled = static_cast<unsigned int>(chunkCullCandidates.size() - visibleChunks.size());
+    objectsDrawn = static_cast<unsigned int>(turbineInstances.visible.size() + solarPanelInstances.visible.size());
+    objectsCulled = static_cast<unsigned int>(InstanceCount(turbineInstances) + InstanceCount(solarPanelInstances)) - objectsDrawn;
 }
 
 /*
-    ---------------------------
-    generateTurbineInstances
-    ---------------------------
-    Randomly places NUM_TURBINES turbines around the terrain. Each instance
-    is represented by a 4x4 model matrix. This is later bound to an instanced VBO.
+    ----------------------
+    modelBoundingSphere
+    ----------------------
+    Sphere around the POSITION bounds of every primitive of a loaded model,
+    after transform. With a pivot (in model space) the sphere is centred on
+    it, so it still holds parts that rotate about the pivot. Models that failed
+    to load or lack bounds get a MODEL_FALLBACK_RADIUS sphere.
 */
 
-void generateTurbineInstances()
+glm::vec4 modelBoundingSphere(const GltfModel& model, const glm::mat4& transform, const glm::vec3* pivot)
 {
-    turbineInstances.clear();
-    turbineInstances.reserve(NUM_TURBINES);
+    std::vector<glm::vec3> corners;
+    for (const GltfPrimitive& primitive : model.primitives) {
+        if (!primitive.hasBounds)
+            continue;
+
+        for (int corner = 0; corner < 8; ++corner) {
+            glm::vec3 local((corner & 1) ? primitive.boundsMax.x : primitive.boundsMin.x,
+                            (corner & 2) ? primitive.boundsMax.y : primitive.boundsMin.y,
+                            (corner & 4) ? primitive.boundsMax.z : primitive.boundsMin.z);
+            corners.push_back(glm::vec3(transform * glm::vec4(local, 1.0f)));
+        }
+    }
 
-    srand(42);
+    glm::vec3 center = glm::vec3(transform * glm::vec4(pivot ? *pivot : glm::vec3(0.0f), 1.0f));
+    if (corners.empty())
+        return glm::vec4(center, MODEL_FALLBACK_RADIUS);
 
-    float rangeX = 2000.0f;
-    float rangeZ = 2000.0f;
+    if (!pivot) {
+        glm::vec3 low = corners[0];
+        glm::vec3 high = corners[0];
+        for (const glm::vec3& corner : corners) {
+            low = glm::min(low, corner);
+            high = glm::max(high, corner);
+        }
+        center = (low + high) * 0.5f;
+    }
 
-    for (int i = 0; i < NUM_TURBINES; i++)
-    {
-        float x = static_cast<float>(rand()) / RAND_MAX * rangeX;
-        float z = static_cast<float>(rand()) / RAND_MAX * rangeZ;
+    float radius = 0.0f;
+    for (const glm::vec3& corner : corners) {
+        radius = std::max(radius, glm::distance(center, corner));
+    }
+    return glm::vec4(center, radius);
+}
 
-        float y = getTerrainHeight(x, z);
+/*
+    ------------------
+    turbineBaseModel
+    ------------------
+    Transform every turbine mesh is drawn with before its instance matrix.
+*/
 
-        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x, y, z));
+glm::mat4 turbineBaseModel()
+{
+    glm::mat4 baseModelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(50.0f, -5.0f, 50.0f));
+    baseModelMatrix = glm::rotate(baseModelMatrix, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    return baseModelMatrix;
+}
 
-        float angle = glm::radians(static_cast<float>(rand() % 360));
-        model = glm::rotate(model, angle, glm::vec3(0,1,0));
+/*
+    ------------------
+    turbineMeshModel
+    ------------------
+    Model matrix of one turbine mesh this frame: the base transform, plus the
+    blade mesh's rotation of turbineBladeRotation degrees about the hub.
+*/
 
-        turbineInstances.push_back(model);
+glm::mat4 turbineMeshModel(size_t mesh)
+{
+    glm::mat4 modelMatrix = turbineBaseModel();
+    if (mesh == TURBINE_BLADE_MESH) {
+        glm::vec3 rotationCircleScale(0.5f, 0.5f, 0.5f);
+        modelMatrix = glm::translate(modelMatrix, TURBINE_BLADE_HUB);
+        modelMatrix = glm::scale(modelMatrix, rotationCircleScale);
+        modelMatrix = glm::rotate(modelMatrix, glm::radians(turbineBladeRotation), glm::vec3(0.0f, 0.0f, 1.0f));
+        modelMatrix = glm::scale(modelMatrix, glm::vec3(1.0f) / rotationCircleScale);
+        modelMatrix = glm::translate(modelMatrix, -TURBINE_BLADE_HUB);
     }
+    return modelMatrix;
 }
 
 /*
-    ------------------------------
-    generateSolarPanelInstances
-    ------------------------------
-    Similar to turbines, but for solar panels. 
-    The panel is slightly tilted, and faced towards the camera.
+    ------------------
+    createShadowMap
+    ------------------
+    Sets up one cascade: an FBO on its layer of the shared depth array and a
+    size x size static layer to cache the static casters in.
 */
 
-void generateSolarPanelInstances(int panelCount)
+ShadowMap createShadowMap(unsigned int size, GLuint depthArray, int layer)
 {
-    solarPanelInstances.clear();
-    solarPanelInstances.reserve(panelCount);
+    ShadowMap shadowMap = {};
+    shadowMap.size = size;
+    shadowMap.layer = layer;
 
-    srand(123);
+    glGenTextures(1, &shadowMap.staticDepth);
+    glBindTexture(GL_TEXTURE_2D, shadowMap.staticDepth);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-    float rangeX = 2000.0f;
-    float rangeZ = 2000.0f;
-    float verticalOffset = 25.0f;
+    glGenFramebuffers(1, &shadowMap.staticFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadowMap.staticFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, shadowMap.staticDepth, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
 
-    for (int i = 0; i < panelCount; i++)
-    {
-        float x = static_cast<float>(rand()) / RAND_MAX * rangeX;
-        float z = static_cast<float>(rand()) / RAND_MAX * rangeZ;
+    glGenFramebuffers(1, &shadowMap.depthFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadowMap.depthFBO);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0, layer);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-        float y = getTerrainHeight(x, z) + verticalOffset;
-        glm::vec3 panelPosition(x, y, z);
+    return shadowMap;
+}
+
+void destroyShadowMap(ShadowMap& shadowMap)
+{
+    glDeleteFramebuffers(1, &shadowMap.depthFBO);
+    glDeleteFramebuffers(1, &shadowMap.staticFBO);
+    glDeleteTextures(1, &shadowMap.staticDepth);
+    shadowMap = ShadowMap();
+}
 
-        glm::vec3 toCamera = glm::normalize(eye_center - panelPosition);
-        float angleY = atan2(toCamera.x, toCamera.z);
+/*
+    --------------------------
+    createShadowCascadeArray
+    --------------------------
+    The depth texture array the main pass samples, one layer per cascade.
+    Lookups outside a layer return the far plane (lit).
+*/
 
-        glm::mat4 model(1.0f);
-        model = glm::translate(model, panelPosition);
-        model = glm::rotate(model, angleY, glm::vec3(0, 1, 0));
+GLuint createShadowCascadeArray(unsigned int size, int layers)
+{
+    GLuint depthArray;
+    glGenTextures(1, &depthArray);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthArray);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, size, size, layers, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    float borderColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return depthArray;
+}
 
-        model = glm::rotate(model, glm::radians(-30.0f), glm::vec3(1, 0, 0));
-        model = glm::scale(model, glm::vec3(0.5f));
+/*
+    ------------------------
+    updateShadowCascades
+    ------------------------
+    Refits and redraws the cascades that are due this frame (and any that
+    have never been drawn). Split distances follow zNear/zFar.
+*/
 
-        solarPanelInstances.push_back(model);
+void updateShadowCascades(const glm::mat4& viewMatrix, float aspect, const GltfModel& turbine, const GltfModel& solarPanel,
+                          const ShaderProgram& terrainShadowShader, const ShaderProgram& cdlodShadowShader,
+                          const ShaderProgram& shadowShader)
+{
+    float splits[NUM_SHADOW_CASCADES + 1];
+    for (int i = 0; i <= NUM_SHADOW_CASCADES; ++i) {
+        float t = static_cast<float>(i) / NUM_SHADOW_CASCADES;
+        float logarithmic = zNear * std::pow(zFar / zNear, t);
+        float uniform = zNear + (zFar - zNear) * t;
+        splits[i] = SHADOW_SPLIT_LAMBDA * logarithmic + (1.0f - SHADOW_SPLIT_LAMBDA) * uniform;
     }
 
-    if (solarPanelInstanceVBO != 0) {
-        glBindBuffer(GL_ARRAY_BUFFER, solarPanelInstanceVBO);
-        glBufferData(GL_ARRAY_BUFFER,
-                     solarPanelInstances.size() * sizeof(glm::mat4),
-                     &solarPanelInstances[0],
-                     GL_STATIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    for (int cascade = 0; cascade < NUM_SHADOW_CASCADES; ++cascade) {
+        ShadowMap& shadowMap = shadowCascades[cascade];
+        unsigned int interval = SHADOW_CASCADE_INTERVALS[cascade];
+        if (shadowMap.staticValid && (shadowFrames + interval / 2) % interval != 0)
+            continue;
+
+        fitShadowCascade(shadowMap, viewMatrix, aspect, splits[cascade], splits[cascade + 1]);
+        renderShadowMap(shadowMap, turbine, solarPanel, terrainShadowShader, cdlodShadowShader, shadowShader);
+        shadowCascadeUpdates++;
     }
+    shadowFrames++;
 }
 
 /*
-    --------------
-    updateChunks
-    --------------
-    Decides which chunks are in range of the camera, removes out-of-range chunks,
-    and queues up requests for missing chunks. This is part of the dynamic LOD terrain system.
+    --------------------
+    fitShadowCascade
+    --------------------
+    Points a cascade's light matrix at the view frustum slice between two
+    distances. The box is the slice's bounding sphere, whose size does not
+    change as the camera turns, and its centre is snapped to whole texels
+    in light space. The near plane is pulled SHADOW_CASTER_MARGIN towards
+    the sun so casters above the slice still land in the map.
 */
 
-void updateChunks(int cx, int cz)
+void fitShadowCascade(ShadowMap& shadowMap, const glm::mat4& viewMatrix, float aspect, float nearDistance, float farDistance)
 {
-    int range = 10;
-    int startX = cx - range;
-    int endX   = cx + range;
-    int startZ = cz - range;
-    int endZ   = cz + range;
-
-    activeChunks.erase(
-        std::remove_if(activeChunks.begin(), activeChunks.end(),
-            [=](const Chunk &chunk)
-            {
-                return (chunk.chunkX < startX || chunk.chunkX > endX ||
-                        chunk.chunkZ < startZ || chunk.chunkZ > endZ);
-            }
-        ),
-        activeChunks.end()
-    );
+    glm::mat4 cameraToWorld = glm::inverse(viewMatrix);
+    float tanHalfFov = std::tan(glm::radians(FoV) * 0.5f);
+
+    glm::vec3 corners[8];
+    glm::vec3 center(0.0f);
+    for (int i = 0; i < 8; ++i) {
+        float distance = (i & 4) ? farDistance : nearDistance;
+        glm::vec4 viewCorner(((i & 1) ? 1.0f : -1.0f) * distance * tanHalfFov * aspect,
+                             ((i & 2) ? 1.0f : -1.0f) * distance * tanHalfFov,
+                             -distance, 1.0f);
+        corners[i] = glm::vec3(cameraToWorld * viewCorner);
+        center += corners[i] / 8.0f;
+    }
 
-    for (int z = startZ; z <= endZ; ++z) {
-        for (int x = startX; x <= endX; ++x) {
-            bool found = false;
-            for (const auto &chunk : activeChunks) {
-                if (chunk.chunkX == x && chunk.chunkZ == z) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
-                std::lock_guard<std::mutex> lock(chunkMutex);
-                chunkRequests.push({x, z});
-            }
-        }
+    float radius = 0.0f;
+    for (const glm::vec3& corner : corners) {
+        radius = std::max(radius, glm::distance(center, corner));
     }
+    radius = std::ceil(radius);
+
+    glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), sunlightDirection, glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+    float texelWorldSize = 2.0f * radius / shadowMap.size;
+    lightCenter.x = std::floor(lightCenter.x / texelWorldSize) * texelWorldSize;
+    lightCenter.y = std::floor(lightCenter.y / texelWorldSize) * texelWorldSize;
+
+    glm::mat4 lightProjection = glm::ortho(lightCenter.x - radius, lightCenter.x + radius,
+                                           lightCenter.y - radius, lightCenter.y + radius,
+                                           -(lightCenter.z + radius + SHADOW_CASTER_MARGIN), -(lightCenter.z - radius));
+    shadowMap.lightSpaceMatrix = lightProjection * lightView;
 }
 
 /*
-    -------------------------
-    generateTerrain
-    -------------------------
-    Uses FastNoiseLite to generate a heightmap for a given chunk. 
-    We produce (gridSize+1)*(gridSize+1) vertices, forming a grid. 
-    Then we build the index list for triangle rendering.
+    ----------------------
+    shadowCascadeBinding
+    ----------------------
+    The cascade array on unit 9, as main-pass materials list it. The light
+    matrices and depth biases it is sampled with are in FrameUniforms.
 */
 
-std::vector<Vertex> generateTerrain(unsigned int gridSize, float gridScale, float heightScale, 
-                                    std::vector<unsigned int>& indices, int chunkX, int chunkZ)
+RenderTextureBinding shadowCascadeBinding()
 {
-    std::vector<Vertex> vertices;
-    vertices.reserve((gridSize + 1) * (gridSize + 1));
-    
-    FastNoiseLite noise;
-    noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
-    noise.SetFractalType(FastNoiseLite::FractalType_FBm);
-    noise.SetFractalOctaves(6);
-    noise.SetFrequency(0.02f);
-    noise.SetFractalLacunarity(2.0f);
-    noise.SetFractalGain(0.5f);
-
-    float worldOffsetX = chunkX * (float)gridSize * gridScale;
-    float worldOffsetZ = chunkZ * (float)gridSize * gridScale;
-
-    for (unsigned int z = 0; z <= gridSize; ++z) {
-        for (unsigned int x = 0; x <= gridSize; ++x) {
-            float localX = x * gridScale;
-            float localZ = z * gridScale;
-
-            float globalX = worldOffsetX + localX;
-            float globalZ = worldOffsetZ + localZ;
-
-            float lowFrequencyNoise = noise.GetNoise(globalX * 0.05f, globalZ * 0.05f);
-            float midFrequencyNoise = noise.GetNoise(globalX * 0.2f, globalZ * 0.2f);
-            float highFrequencyNoise = noise.GetNoise(globalX * 0.8f, globalZ * 0.8f);
-
-            float biomeFactor = (noise.GetNoise(globalX * 0.01f, globalZ * 0.01f) + 1.0f) / 2.0f;
-            float biomeHeightScale = glm::mix(20.0f, 60.0f, biomeFactor);
-
-            float height = ((lowFrequencyNoise * 0.5f + 
-                             midFrequencyNoise * 0.3f + 
-                             highFrequencyNoise * 0.2f) + 1.0f) * 0.5f * biomeHeightScale;
+    RenderTextureBinding binding = { 9, GL_TEXTURE_2D_ARRAY, shadowCascadeArray };
+    return binding;
+}
 
-            Vertex vertex;
-            vertex.Position = glm::vec3(localX, height, localZ);
-            vertex.Normal = glm::vec3(0.0f, 1.0f, 0.0f);
-            vertex.TexCoords = glm::vec2((float)x / gridSize, (float)z / gridSize);
+/*
+    ----------------------
+    updateFrameUniforms
+    ----------------------
+    Fills and sends the shared FrameUniforms block once per frame, after the
+    cascades were updated: camera, sun, and for each cascade the matrix it
+    was last drawn with and a depth bias of SHADOW_BIAS_TEXELS texels in
+    [0,1] depth units.
+*/
 
-            vertices.push_back(vertex);
-        }
+void updateFrameUniforms(const glm::mat4& vpMatrix)
+{
+    FrameUniforms& data = frameUniforms.data;
+    data.vpMatrix = vpMatrix;
+    data.lightDir = glm::vec4(sunlightDirection, 0.0f);
+    data.lightColor = glm::vec4(sunlightColor, 0.0f);
+    data.viewPos = glm::vec4(eye_center, 1.0f);
+
+    for (int cascade = 0; cascade < NUM_SHADOW_CASCADES; ++cascade) {
+        const glm::mat4& matrix = shadowCascades[cascade].lightSpaceMatrix;
+        glm::vec3 row0(matrix[0][0], matrix[1][0], matrix[2][0]);
+        glm::vec3 row2(matrix[0][2], matrix[1][2], matrix[2][2]);
+        float texelWorldSize = 2.0f / (glm::length(row0) * shadowCascades[cascade].size);
+        data.lightSpaceMatrices[cascade] = matrix;
+        data.cascadeDepthBias[cascade] = SHADOW_BIAS_TEXELS * texelWorldSize * 0.5f * glm::length(row2);
     }
 
-    indices.reserve(gridSize * gridSize * 6);
-    for (unsigned int z = 0; z < gridSize; ++z) {
-        for (unsigned int x = 0; x < gridSize; ++x) {
-            unsigned int topLeft = z * (gridSize + 1) + x;
-            unsigned int topRight = topLeft + 1;
-            unsigned int bottomLeft = (z + 1) * (gridSize + 1) + x;
-            unsigned int bottomRight = bottomLeft + 1;
+    UploadFrameUniforms(frameUniforms);
+}
 
-            indices.push_back(topLeft);
-            indices.push_back(bottomLeft);
-            indices.push_back(topRight);
+/*
+    ------------------------
+    configureShaderProgram
+    ------------------------
+    One-time state of a freshly loaded program: its FrameUniforms block is
+    bound to FRAME_UNIFORM_BINDING and each sampler it uses is pointed at
+    its unit in SHADER_SAMPLER_UNITS.
+*/
 
-            indices.push_back(topRight);
-            indices.push_back(bottomLeft);
-            indices.push_back(bottomRight);
-        }
+void configureShaderProgram(const ShaderProgram& program)
+{
+    SetUniformBlockBinding(program, "FrameUniforms", FRAME_UNIFORM_BINDING);
+    for (const auto& sampler : SHADER_SAMPLER_UNITS) {
+        SetSamplerUnit(program, sampler.first, sampler.second);
     }
-
-    return vertices;
+    glUseProgram(0);
 }
 
 /*
-    ---------------------
-    getTerrainHeight
-    ---------------------
-    A quick utility for sampling the same noise function used for the terrain, 
-    allowing objects (turbines, panels) to be placed on the ground.
+    --------------------
+    initRenderQueues
+    --------------------
+    Pass states of the main queue: the sky without depth testing, opaque
+    geometry, then the sun and halo blended back to front without depth
+    writes. The shadow queue only holds opaque depth draws.
 */
 
-float getTerrainHeight(float globalX, float globalZ)
+void initRenderQueues()
 {
-    static FastNoiseLite noise;
-    static bool noiseInitialized = false;
-    if (!noiseInitialized) {
-        noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
-        noise.SetFractalType(FastNoiseLite::FractalType_FBm);
-        noise.SetFractalOctaves(6);
-        noise.SetFrequency(0.02f);
-        noise.SetFractalLacunarity(2.0f);
-        noise.SetFractalGain(0.5f);
-        noiseInitialized = true;
-    }
+    InitRenderQueue(mainRenderQueue, zFar);
+    SetRenderPassState(mainRenderQueue, RENDER_PASS_SKY, RenderPassState{ false, true, false, false });
+    SetRenderPassState(mainRenderQueue, RENDER_PASS_OPAQUE, RenderPassState{ true, true, false, false });
+    SetRenderPassState(mainRenderQueue, RENDER_PASS_BLENDED, RenderPassState{ true, false, true, true });
 
-    float lowFrequencyNoise = noise.GetNoise(globalX * 0.05f, globalZ * 0.05f);
-    float midFrequencyNoise = noise.GetNoise(globalX * 0.2f,  globalZ * 0.2f);
-    float highFrequencyNoise= noise.GetNoise(globalX * 0.8f,  globalZ * 0.8f);
+    InitRenderQueue(shadowRenderQueue, zFar);
+}
 
-    float biomeFactor = (noise.GetNoise(globalX * 0.01f, globalZ * 0.01f) + 1.0f)*0.5f;
-    float biomeHeightScale = glm::mix(20.0f, 60.0f, biomeFactor);
+/*
+    ------------------------
+    recordRenderQueueStats
+    ------------------------
+    Adds the main queue's last submit to the state change totals.
+*/
 
-    float height = ((lowFrequencyNoise * 0.5f +
-                     midFrequencyNoise * 0.3f +
-                     highFrequencyNoise * 0.2f) + 1.0f) * 0.5f 
-                     * biomeHeightScale;
+void recordRenderQueueStats()
+{
+    const GLStateCounters& requested = mainRenderQueue.state.requested;
+    const GLStateCounters& issued = mainRenderQueue.state.issued;
+    renderStatesRequested.programs += requested.programs;
+    renderStatesRequested.vertexArrays += requested.vertexArrays;
+    renderStatesRequested.textures += requested.textures;
+    renderStatesRequested.uniforms += requested.uniforms;
+    renderStatesRequested.renderStates += requested.renderStates;
+    renderStatesIssued.programs += issued.programs;
+    renderStatesIssued.vertexArrays += issued.vertexArrays;
+    renderStatesIssued.textures += issued.textures;
+    renderStatesIssued.uniforms += issued.uniforms;
+    renderStatesIssued.renderStates += issued.renderStates;
+    renderQueueDraws += mainRenderQueue.submittedDraws;
+    renderQueueDrawCalls += mainRenderQueue.issuedDraws;
+    renderQueueFrames++;
+}
 
-    return height;
+unsigned int stateChangeTotal(const GLStateCounters& counters)
+{
+    return counters.programs + counters.vertexArrays + counters.textures + counters.uniforms + counters.renderStates;
 }
 
 /*
-    ----------------------
-    chunkLoadingTask
-    ----------------------
-    Runs on a separate thread. When new chunks are requested, it:
-    1) Dequeues a chunk request (x,z).
-    2) Generates multiple LODs for that chunk.
-    3) Pushes the results onto the chunkDataQueue.
+    ------------------
+    shadowCasterLOD
+    ------------------
+    Coarsest terrain LOD whose grid spacing is at most one shadow map texel
+    of an orthographic light; finer caster detail would not change the map.
 */
 
-void chunkLoadingTask()
+int shadowCasterLOD(const glm::mat4& lightSpaceMatrix, unsigned int size)
 {
-    std::vector<unsigned int> lodGridSizes = { 100, 50, 25 };
-
-    while (keepLoadingChunks)
-    {
-        std::pair<int,int> request;
-        {
-            std::lock_guard<std::mutex> lock(chunkMutex);
-            if (!chunkRequests.empty())
-            {
-                request = chunkRequests.front();
-                chunkRequests.pop();
-            }
-            else
-            {
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                continue;
-            }
-        }
+    // Row 0 maps world units to NDC x, which spans 2 over size texels
+    glm::vec3 row0(lightSpaceMatrix[0][0], lightSpaceMatrix[1][0], lightSpaceMatrix[2][0]);
+    float texelWorldSize = 2.0f / (glm::length(row0) * size);
+
+    int lod = 0;
+    while (lod + 1 < NUM_TERRAIN_LODS &&
+           GRID_SCALE * (static_cast<float>(GRID_SIZE) / terrainLODGridSize(lod + 1)) <= texelWorldSize) {
+        ++lod;
+    }
+    return lod;
+}
 
-        int x = request.first;
-        int z = request.second;
+/*
+    ------------------
+    renderShadowMap
+    ------------------
+    Redraws the static layer when it is stale, copies it into the sampled
+    map and draws the dynamic casters over it. Chunks and instances are culled
+    against the light frustum, so casters outside the map are never drawn.
+*/
 
-        glm::vec2 chunkPos(
-            x * GRID_SIZE * GRID_SCALE,
-            z * GRID_SIZE * GRID_SCALE
-        );
+void renderShadowMap(ShadowMap& shadowMap, const GltfModel& turbine, const GltfModel& solarPanel,
+                     const ShaderProgram& terrainShadowShader, const ShaderProgram& cdlodShadowShader,
+                     const ShaderProgram& shadowShader)
+{
+    const glm::mat4& lightSpaceMatrix = shadowMap.lightSpaceMatrix;
+    Frustum lightFrustum = ExtractFrustum(lightSpaceMatrix);
+    GLsizei size = static_cast<GLsizei>(shadowMap.size);
 
-        std::vector<ChunkData> allLODData;
-        allLODData.reserve(lodGridSizes.size());
+    glViewport(0, 0, size, size);
+    shadowTexelsWritten += static_cast<unsigned long long>(size) * size;
 
-        for (auto lodGrid : lodGridSizes)
-        {
-            std::vector<unsigned int> indices;
-            std::vector<Vertex> vertices = generateTerrain(
-                lodGrid, 
-                GRID_SCALE * (static_cast<float>(GRID_SIZE) / lodGrid),
-                HEIGHT_SCALE,
-                indices,
-                x, z
-            );
+    glUseProgram(shadowShader.id);
+    glUniformMatrix4fv(UniformLocation(shadowShader, "lightSpaceMatrix"), 1, GL_FALSE, &lightSpaceMatrix[0][0]);
 
-            ChunkData cd;
-            cd.vertices  = std::move(vertices);
-            cd.indices   = std::move(indices);
-            cd.position  = chunkPos;
-            cd.chunkX    = x;
-            cd.chunkZ    = z;
+    if (!shadowMap.staticValid || shadowMap.staticGeneration != shadowCasterGeneration ||
+        shadowMap.staticLightSpaceMatrix != lightSpaceMatrix) {
+        glBindFramebuffer(GL_FRAMEBUFFER, shadowMap.staticFBO);
+        glClear(GL_DEPTH_BUFFER_BIT);
 
-            allLODData.push_back(cd);
+        if (!cdlodEnabled) {
+            shadowTerrainLOD = shadowCasterLOD(lightSpaceMatrix, shadowMap.size);
+            glUseProgram(terrainShadowShader.id);
+            glUniformMatrix4fv(UniformLocation(terrainShadowShader, "lightSpaceMatrix"), 1, GL_FALSE, &lightSpaceMatrix[0][0]);
+            ClearRenderQueue(shadowRenderQueue);
+            drawShadowTerrainChunks(terrainShadowShader, lightFrustum, shadowTerrainLOD);
+            SubmitRenderQueue(shadowRenderQueue);
+            shadowTerrainDrawCalls = shadowRenderQueue.issuedDraws;
         }
 
-        {
-            std::lock_guard<std::mutex> lock(chunkMutex);
-            chunkDataQueue.push(allLODData);
+        std::vector<ShadowCasterMesh> towerMeshes;
+        for (size_t i = 0; i < turbine.primitives.size(); ++i) {
+            if (i == TURBINE_BLADE_MESH) continue;
+            towerMeshes.push_back({ i, turbineMeshModel(i) });
         }
-    }
-}
+        std::vector<ShadowCasterMesh> panelMeshes;
+        for (size_t i = 0; i < solarPanel.primitives.size(); ++i) {
+            panelMeshes.push_back({ i, glm::mat4(1.0f) });
+        }
+
+        glUseProgram(shadowShader.id);
+        drawShadowInstances(shadowShader, turbineInstances, lightFrustum, turbine, towerMeshes);
+        drawShadowInstances(shadowShader, solarPanelInstances, lightFrustum, solarPanel, panelMeshes);
+
+        shadowMap.staticValid = true;
+        shadowMap.staticLightSpaceMatrix = lightSpaceMatrix;
+        shadowMap.staticGeneration = shadowCasterGeneration;
+        staticShadowRenders++;
+        shadowTexelsWritten += static_cast<unsigned long long>(size) * size;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, shadowMap.staticFBO);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, shadowMap.depthFBO);
+    glBlitFramebuffer(0, 0, size, size, 0, 0, size, size, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadowMap.depthFBO);
+
+    if (cdlodEnabled) {
+        glUseProgram(cdlodShadowShader.id);
+        glUniformMatrix4fv(UniformLocation(cdlodShadowShader, "lightSpaceMatrix"), 1, GL_FALSE, &lightSpaceMatrix[0][0]);
+        ClearRenderQueue(shadowRenderQueue);
+        drawCdlodNodes(cdlodShadowShader, shadowRenderQueue, 0, AddRenderMaterial(shadowRenderQueue, nullptr, 0));
+        SubmitRenderQueue(shadowRenderQueue);
+    }
+
+    if (turbine.primitives.size() > TURBINE_BLADE_MESH) {
+        std::vector<ShadowCasterMesh> bladeMeshes(1, { TURBINE_BLADE_MESH, turbineMeshModel(TURBINE_BLADE_MESH) });
+        glUseProgram(shadowShader.id);
+        drawShadowInstances(shadowShader, turbineInstances, lightFrustum, turbine, bladeMeshes);
+    }
+
+    glBindVertexArray(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/*
+    -------------------------
+    drawShadowTerrainChunks
+    -------------------------
+    Queues the resident chunks inside the light frustum at one LOD on
+    shadowRenderQueue, with the uniforms they share set on the bound terrain
+    shadow program. The packets differ only in their base vertex and index
+    range, so they are submitted as one multi-draw.
+*/
+
+void drawShadowTerrainChunks(const ShaderProgram& shader, const Frustum& lightFrustum, int lod)
+{
+    glUniform2f(UniformLocation(shader, "heightRange"),
+                TERRAIN_HEIGHT_MIN, TERRAIN_HEIGHT_MAX - TERRAIN_HEIGHT_MIN);
+    glUniform1i(UniformLocation(shader, "gridSize"), terrainLODGridSize(lod));
+    glUniform1f(UniformLocation(shader, "gridScale"),
+                GRID_SCALE * (static_cast<float>(GRID_SIZE) / terrainLODGridSize(lod)));
+    glUniform1i(UniformLocation(shader, "slotVertices"), terrainLODVertexOffset(NUM_TERRAIN_LODS));
+    glUniform1i(UniformLocation(shader, "lodVertexOffset"), terrainLODVertexOffset(lod));
+
+    const float chunkSize = GRID_SIZE * GRID_SCALE;
+    std::vector<const Chunk*> chunks;
+    CullBoxList bounds;
+    for (const auto& chunk : activeChunks) {
+        chunks.push_back(&chunk);
+        bounds.minX.push_back(chunk.position.x);
+        bounds.minY.push_back(chunk.heightBounds.x);
+        bounds.minZ.push_back(chunk.position.y);
+        bounds.maxX.push_back(chunk.position.x + chunkSize);
+        bounds.maxY.push_back(chunk.heightBounds.y);
+        bounds.maxZ.push_back(chunk.position.y + chunkSize);
+    }
+    std::vector<unsigned int> visible;
+    CullBoxes(lightFrustum, bounds, visible);
+
+    const RenderTextureBinding origins = { 11, GL_TEXTURE_BUFFER, terrainOriginTexture };
+    unsigned int material = AddRenderMaterial(shadowRenderQueue, &origins, 1);
+    for (unsigned int index : visible) {
+        const Chunk& chunk = *chunks[index];
+        const LODLevel& lodLevel = chunk.lodLevels[std::min(lod, static_cast<int>(chunk.lodLevels.size()) - 1)];
+        DrawPacket& packet = PushDrawPacket(shadowRenderQueue, 0, shader.id, material, terrainVAO, 0.0f);
+        packet.count = lodLevel.indexCount;
+        packet.indexType = GL_UNSIGNED_SHORT;
+        packet.first = lodLevel.firstIndex * sizeof(unsigned short);
+        packet.baseVertex = lodLevel.baseVertex;
+    }
+
+    shadowChunksDrawn = static_cast<unsigned int>(visible.size());
+    shadowChunksCulled = static_cast<unsigned int>(chunks.size() - visible.size());
+}
+
+/*
+    -----------------------
+    drawShadowInstances
+    -----------------------
+    Draws the listed primitives of a model for each instance inside the light
+    frustum, with the bound shadow program.
+*/
+
+void drawShadowInstances(const ShaderProgram& shader, InstanceBuffer& instanceBuffer, const Frustum& lightFrustum,
+                         const GltfModel& source, const std::vector<ShadowCasterMesh>& meshes)
+{
+    CullInstances(instanceBuffer, &lightFrustum);
+    GLsizei instanceCount = UploadVisibleInstances(instanceBuffer);
+    if (instanceCount == 0)
+        return;
+
+    glActiveTexture(GL_TEXTURE10);
+    glBindTexture(GL_TEXTURE_BUFFER, instanceBuffer.texture);
+
+    GLint modelLoc = UniformLocation(shader, "model");
+    glBindVertexArray(source.VAO);
+    for (const ShadowCasterMesh& mesh : meshes) {
+        const GltfPrimitive& primitive = source.primitives[mesh.primitive];
+        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, &mesh.model[0][0]);
+        glDrawElementsInstancedBaseVertex(primitive.mode, primitive.indexCount, source.indexType,
+                                          (void*)primitive.firstIndex, instanceCount, primitive.baseVertex);
+    }
+}
+
+/*
+    -------------
+    getLODIndex
+    -------------
+    Simple LOD heuristic: closer chunks get more detail, 
+    farther chunks get less detail.
+*/
+
+int getLODIndex(float distance)
+{
+    if (distance < 400.0f)
+        return 0;  
+    else if (distance < 800.0f)
+        return 1; 
+    else
+        return 2; 
+}
+
+/*
+    ----------------------------
+    forEachChunkOutsideWindow
+    ----------------------------
+    Calls visit(x, z) for every chunk of the square window of `radius` around
+    (fromX, fromZ) that is not in the same-sized window around (toX, toZ).
+    Rows fully outside are visited whole, the others only over the column
+    ranges left and right of the target window.
+*/
+
+template <typename Visit>
+void forEachChunkOutsideWindow(int fromX, int fromZ, int toX, int toZ, int radius, Visit visit)
+{
+    for (int z = fromZ - radius; z <= fromZ + radius; ++z) {
+        if (std::abs(z - toZ) > radius) {
+            for (int x = fromX - radius; x <= fromX + radius; ++x) {
+                visit(x, z);
+            }
+            continue;
+        }
+        for (int x = fromX - radius; x <= std::min(fromX + radius, toX - radius - 1); ++x) {
+            visit(x, z);
+        }
+        for (int x = std::max(fromX - radius, toX + radius + 1); x <= fromX + radius; ++x) {
+            visit(x, z);
+        }
+    }
+}
+
+/*
+    --------------
+    updateChunks
+    --------------
+    Decides which chunks are in range of the camera, removes out-of-range chunks,
+    and queues up requests for missing chunks. This is part of the dynamic LOD terrain system.
+    Only the strips of chunks that leave and enter the window are visited, so
+    crossing a chunk boundary costs O(radius) rather than O(radius^2).
+*/
+
+void updateChunks(int cx, int cz)
+{
+    const int range = chunkViewRadius;
+
+    if (chunkWindowValid) {
+        forEachChunkOutsideWindow(chunkWindowX, chunkWindowZ, cx, cz, range, [](int x, int z) {
+            const Chunk* chunk = activeChunks.Find(x, z);
+            if (chunk) {
+                releaseChunkBuffers(*chunk);
+                activeChunks.Evict(x, z);
+                shadowCasterGeneration++;
+                terrainHeights.RemoveTile(x, z);
+                RemoveInstances(turbineInstances, chunkKey(x, z));
+                RemoveInstances(solarPanelInstances, chunkKey(x, z));
+            }
+        });
+    }
+
+    int previousX = chunkWindowX;
+    int previousZ = chunkWindowZ;
+    bool incremental = chunkWindowValid;
+
+    chunkWindowX = cx;
+    chunkWindowZ = cz;
+    chunkWindowValid = true;
+    workerChunkWindow = chunkKey(cx, cz);
+
+    glm::vec2 focus(eye_center.x, eye_center.z);
+    auto request = [&focus](int x, int z) {
+        requestChunk(x, z, focus);
+    };
+
+    if (incremental) {
+        forEachChunkOutsideWindow(cx, cz, previousX, previousZ, range, request);
+    } else {
+        for (int z = cz - range; z <= cz + range; ++z) {
+            for (int x = cx - range; x <= cx + range; ++x) {
+                request(x, z);
+            }
+        }
+    }
+
+    cancelStaleChunkRequests();
+
+    for (auto& request : chunkRequests) {
+        request.priority = chunkRequestPriority(request.chunkX, request.chunkZ, focus);
+    }
+    std::make_heap(chunkRequests.begin(), chunkRequests.end(), ChunkRequestFarther());
+
+    dispatchChunkRequests();
+}
+
+/*
+    ----------------------------
+    requestChunk
+    ----------------------------
+    Queues a chunk unless it is resident or already has a job, in which case
+    the request merges into that job.
+*/
+
+void requestChunk(int chunkX, int chunkZ, const glm::vec2& focus)
+{
+    if (activeChunks.Find(chunkX, chunkZ))
+        return;
+    if (!chunkJobs.insert(std::make_pair(chunkKey(chunkX, chunkZ), CHUNK_JOB_QUEUED)).second) {
+        chunkRequestsMerged++;
+        return;
+    }
+
+    ChunkRequest request = { chunkX, chunkZ, chunkRequestPriority(chunkX, chunkZ, focus), -1 };
+    chunkRequests.push_back(request);
+    std::push_heap(chunkRequests.begin(), chunkRequests.end(), ChunkRequestFarther());
+}
+
+/*
+    ----------------------------
+    dispatchChunkRequests
+    ----------------------------
+    Moves the nearest queued requests into chunkRequestRing until every worker
+    has CHUNK_DISPATCH_DEPTH jobs in flight, then wakes parked workers. Keeping
+    the ring shallow leaves the ordering decisions in the heap, where
+    reprioritiseChunkRequests and cancelStaleChunkRequests can still act.
+*/
+
+void dispatchChunkRequests()
+{
+    int depth = std::min(static_cast<int>(chunkWorkers.size()) * CHUNK_DISPATCH_DEPTH,
+                         static_cast<int>(chunkRequestRing.Capacity()));
+
+    bool dispatched = false;
+    while (chunkJobsInFlight < depth && !chunkRequests.empty()) {
+        std::pop_heap(chunkRequests.begin(), chunkRequests.end(), ChunkRequestFarther());
+        ChunkRequest request = chunkRequests.back();
+        long long key = chunkKey(request.chunkX, request.chunkZ);
+        if (!chunkRequestRing.TryPush(std::move(request))) {
+            std::push_heap(chunkRequests.begin(), chunkRequests.end(), ChunkRequestFarther());
+            break;
+        }
+        chunkRequests.pop_back();
+
+        chunkJobs[key] = CHUNK_JOB_RUNNING;
+        chunkJobsInFlight++;
+        chunkRequestsAvailable++;
+        dispatched = true;
+    }
+
+    if (dispatched) {
+        wakeChunkWorkers();
+    }
+}
+
+// Wakes parked workers after requests were pushed to chunkRequestRing
+void wakeChunkWorkers()
+{
+    // Taking the park mutex orders the wake-up after any worker's predicate check
+    { std::lock_guard<std::mutex> lock(chunkParkMutex); }
+    chunkRequestReady.notify_all();
+}
+
+/*
+    ----------------------------
+    cancelStaleChunkRequests
+    ----------------------------
+    Removes queued requests that the window has moved away from. Callers
+    rebuild the heap afterwards. Dispatched jobs are not touched here; their
+    workers skip them or pollLoadedChunks drops their results.
+*/
+
+void cancelStaleChunkRequests()
+{
+    auto stale = std::remove_if(chunkRequests.begin(), chunkRequests.end(),
+        [](const ChunkRequest& request) {
+            return !chunkInWindow(request.chunkX, request.chunkZ);
+        }
+    );
+    for (auto it = stale; it != chunkRequests.end(); ++it) {
+        chunkJobs.erase(chunkKey(it->chunkX, it->chunkZ));
+        chunkJobsCancelled++;
+    }
+    chunkRequests.erase(stale, chunkRequests.end());
+}
+
+/*
+    ----------------------------
+    chunkKey
+    ----------------------------
+    Packs a chunk coordinate into one key for chunkJobs.
+*/
+
+long long chunkKey(int chunkX, int chunkZ)
+{
+    return (static_cast<long long>(chunkX) << 32) | static_cast<unsigned int>(chunkZ);
+}
+
+/*
+    ----------------------------
+    cdlodNodeKey
+    ----------------------------
+    Packs a CDLOD node into one key: 8 bits of level, 28 bits per coordinate.
+*/
+
+unsigned long long cdlodNodeKey(const CdlodNode& node)
+{
+    return (static_cast<unsigned long long>(node.level) << 56) |
+           (static_cast<unsigned long long>(node.x & 0xFFFFFFF) << 28) |
+           static_cast<unsigned long long>(node.z & 0xFFFFFFF);
+}
+
+/*
+    ----------------------------
+    reportChunkJobStats
+    ----------------------------
+    Prints how much chunk work was merged, cancelled or thrown away.
+*/
+
+void reportChunkJobStats()
+{
+    printf("Chunk jobs: %u requests merged, %u cancelled before running, %u wasted generations, %u duplicate generations\n",
+           chunkRequestsMerged, chunkJobsCancelled, chunkGenerationsWasted, chunkGenerationsDuplicate);
+}
+
+/*
+    ----------------------------
+    chunkInWindow
+    ----------------------------
+    True if the chunk lies in the window of the last updateChunks call.
+*/
+
+bool chunkInWindow(int chunkX, int chunkZ)
+{
+    return chunkWindowValid &&
+           std::abs(chunkX - chunkWindowX) <= chunkViewRadius &&
+           std::abs(chunkZ - chunkWindowZ) <= chunkViewRadius;
+}
+
+// Worker-side version, reading the window centre published by updateChunks
+bool chunkInWorkerWindow(int chunkX, int chunkZ)
+{
+    long long window = workerChunkWindow;
+    int windowX = static_cast<int>(window >> 32);
+    int windowZ = static_cast<int>(static_cast<unsigned int>(window));
+    return std::abs(chunkX - windowX) <= chunkViewRadius &&
+           std::abs(chunkZ - windowZ) <= chunkViewRadius;
+}
+
+/*
+    ---------------------------
+    reprioritiseChunkRequests
+    ---------------------------
+    Re-sorts the pending requests around a new camera position so the workers
+    keep picking the nearest chunk while the camera moves inside a chunk.
+*/
+
+void reprioritiseChunkRequests(const glm::vec3& focus)
+{
+    glm::vec2 focus2D(focus.x, focus.z);
+
+    for (auto& request : chunkRequests) {
+        request.priority = chunkRequestPriority(request.chunkX, request.chunkZ, focus2D);
+    }
+    std::make_heap(chunkRequests.begin(), chunkRequests.end(), ChunkRequestFarther());
+}
+
+float chunkRequestPriority(int chunkX, int chunkZ, const glm::vec2& focus)
+{
+    float chunkSize = GRID_SIZE * GRID_SCALE;
+    glm::vec2 chunkCenter((chunkX + 0.5f) * chunkSize, (chunkZ + 0.5f) * chunkSize);
+    glm::vec2 offset = chunkCenter - focus;
+    return glm::dot(offset, offset);
+}
+
+/*
+    ----------------------
+    chunkLoadingTask
+    ----------------------
+    Runs on every chunk worker thread. When new chunks are requested, it:
+    1) Pops the next dispatched request (parking while there is none).
+    2) Generates multiple LODs for that chunk, its height tile and its objects.
+    3) Moves the results into chunkResultRing.
+    Workers share one ring, so a chunk that is slow to build only occupies
+    its own worker while the others keep taking the next nearest requests.
+*/
+
+void chunkLoadingTask()
+{
+    while (true)
+    {
+        ChunkRequest request;
+        if (!chunkRequestRing.TryPop(request)) {
+            std::unique_lock<std::mutex> lock(chunkParkMutex);
+            chunkRequestReady.wait(lock, [] {
+                return !keepLoadingChunks || chunkRequestsAvailable > 0;
+            });
+            if (!keepLoadingChunks)
+                return;
+            continue;
+        }
+        chunkRequestsAvailable--;
+
+        ChunkResult result;
+        result.chunkX = request.chunkX;
+        result.chunkZ = request.chunkZ;
+        result.cdlodLevel = request.cdlodLevel;
+
+        if (request.cdlodLevel >= 0) {
+            CdlodNode node = { request.cdlodLevel, request.chunkX, request.chunkZ };
+            result.nodeVertices = buildCdlodNodeVertices(node);
+        } else if (chunkInWorkerWindow(request.chunkX, request.chunkZ)) {
+            // The camera may have moved on since this request was dispatched
+            result.lods = rtinMaxError > 0.0f ? buildRtinChunkLODs(request.chunkX, request.chunkZ, nullptr)
+                                              : loadChunkLODs(request.chunkX, request.chunkZ);
+            result.heightTile = buildChunkHeightTile(result.lods[0]);
+            result.heightBounds = chunkHeightBounds(result.lods[0]);
+            scatterChunkObjects(request.chunkX, request.chunkZ, result.heightTile, result.turbines, result.solarPanels);
+        }
+
+        // At most chunkRequestRing.Capacity() jobs are in flight, so this
+        // only spins if the render thread is behind by a full ring
+        while (!chunkResultRing.TryPush(std::move(result))) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+/*
+    ----------------------
+    reportRtinStats
+    ----------------------
+    Prints, per RTIN chunk meshed this run, the LOD0 triangles saved against
+    the regular LOD0 grid and the worker time spent meshing.
+*/
+
+void reportRtinStats()
+{
+    if (rtinChunksMeshed == 0) return;
+
+    const double gridTriangles = 2.0 * TERRAIN_LOD_GRID_SIZES[0] * TERRAIN_LOD_GRID_SIZES[0];
+    const double meanTriangles = static_cast<double>(rtinTrianglesKept) / rtinChunksMeshed;
+    printf("RTIN terrain (max error %.3f): %u chunks, LOD0 %.0f triangles per chunk vs %.0f for the grid "
+           "(%.0f saved, %.1f%%), meshing %.2f ms per chunk\n",
+           rtinMaxError, rtinChunksMeshed.load(), meanTriangles, gridTriangles,
+           gridTriangles - meanTriangles, 100.0 * (1.0 - meanTriangles / gridTriangles),
+           rtinMeshingMicros / 1000.0 / rtinChunksMeshed);
+}
+
+/*
+    ----------------------
+    reportRtinRegion
+    ----------------------
+    Handles --rtin-report: meshes the (2 * radius + 1)^2 chunks around the
+    origin at maxError and prints every chunk's triangles per LOD, the LOD0
+    triangles saved and its meshing time, then the totals.
+*/
+
+int reportRtinRegion(float maxError, int radius)
+{
+    rtinMaxError = maxError;
+    const unsigned int gridTriangles = 2 * TERRAIN_LOD_GRID_SIZES[0] * TERRAIN_LOD_GRID_SIZES[0];
+
+    for (int z = -radius; z <= radius; ++z) {
+        for (int x = -radius; x <= radius; ++x) {
+            double meshingMs = 0.0;
+            std::vector<ChunkData> lods = buildRtinChunkLODs(x, z, &meshingMs);
+
+            unsigned int lod0 = static_cast<unsigned int>(lods[0].indices.size() / 3);
+            printf("Chunk (%d, %d): %u / %u / %u triangles, %d saved vs grid, meshed in %.2f ms\n",
+                   x, z, lod0, (unsigned int)(lods[1].indices.size() / 3), (unsigned int)(lods[2].indices.size() / 3),
+                   (int)gridTriangles - (int)lod0, meshingMs);
+        }
+    }
+
+    reportRtinStats();
+    return 0;
+}
+
+/*
+    ----------------------
+    reportScatterRegion
+    ----------------------
+    Handles --scatter-report: builds the (2 * radius + 1)^2 chunks around the
+    origin and scatters their objects as the workers would, then prints the
+    objects per chunk, the scatter time and what a full chunk window of
+    chunkViewRadius would hold.
+*/
+
+int reportScatterRegion(int radius)
+{
+    unsigned long long turbineCount = 0;
+    unsigned long long panelCount = 0;
+    double scatterMs = 0.0;
+    int chunkCount = 0;
+
+    for (int z = -radius; z <= radius; ++z) {
+        for (int x = -radius; x <= radius; ++x) {
+            std::vector<ChunkData> lods = buildChunkLODs(x, z);
+            HeightTile tile = buildChunkHeightTile(lods[0]);
+
+            std::vector<glm::mat4> turbines, solarPanels;
+            auto start = std::chrono::high_resolution_clock::now();
+            scatterChunkObjects(x, z, tile, turbines, solarPanels);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+            printf("Chunk (%d, %d): %u turbines, %u solar panels, scattered in %.3f ms\n",
+                   x, z, (unsigned int)turbines.size(), (unsigned int)solarPanels.size(), ms);
+            turbineCount += turbines.size();
+            panelCount += solarPanels.size();
+            scatterMs += ms;
+            chunkCount++;
+        }
+    }
+
+    const int windowChunks = (2 * chunkViewRadius + 1) * (2 * chunkViewRadius + 1);
+    printf("Scatter (density %.2f): %.1f turbines and %.1f solar panels per chunk, %.3f ms per chunk; "
+           "a %d-chunk window holds about %.0f instances\n",
+           scatterDensity, (double)turbineCount / chunkCount, (double)panelCount / chunkCount, scatterMs / chunkCount,
+           windowChunks, (double)(turbineCount + panelCount) / chunkCount * windowChunks);
+    return 0;
+}
+
+/*
+    ----------------------
+    buildCdlodNodeVertices
+    ----------------------
+    Samples one CDLOD node as a CDLOD_GRID_SIZE^2 heightfield (the node is a
+    "chunk" of its own size, so sampleTerrainHeightfield's world offset lands
+    on the node origin) and pairs every vertex with the even vertex it merges
+    with at the parent level. Node sizes are powers of two times the leaf
+    size, so shared borders sample bit-identical positions.
+*/
+
+std::vector<CdlodVertex> buildCdlodNodeVertices(const CdlodNode& node)
+{
+    const float spacing = CdlodNodeSize(CDLOD_SETTINGS, node.level) / CDLOD_GRID_SIZE;
+    TerrainHeightfield heightfield = sampleTerrainHeightfield(CDLOD_GRID_SIZE, spacing, node.x, node.z);
+
+    std::vector<TerrainVertex> packed = buildCompactTerrainVertices(heightfield);
+
+    const unsigned int rowLength = CDLOD_GRID_SIZE + 1;
+    std::vector<CdlodVertex> vertices(rowLength * rowLength);
+    for (unsigned int z = 0; z < rowLength; ++z) {
+        for (unsigned int x = 0; x < rowLength; ++x) {
+            const TerrainVertex& self = packed[z * rowLength + x];
+            const TerrainVertex& target = packed[(z & ~1u) * rowLength + (x & ~1u)];
+
+            CdlodVertex& vertex = vertices[z * rowLength + x];
+            vertex.height = self.height;
+            vertex.morphHeight = target.height;
+            vertex.normalOct[0] = self.normalOct[0];
+            vertex.normalOct[1] = self.normalOct[1];
+            vertex.morphNormalOct[0] = target.normalOct[0];
+            vertex.morphNormalOct[1] = target.normalOct[1];
+        }
+    }
+
+    return vertices;
+}
+
+/*
+    ----------------------
+    loadChunkLODs
+    ----------------------
+    Returns the LODs of a chunk from the tile cache when every tile is present,
+    otherwise generates them and writes the tiles for the next run.
+*/
+
+std::vector<ChunkData> loadChunkLODs(int chunkX, int chunkZ)
+{
+    std::vector<ChunkData> allLODData;
+
+    if (terrainCacheEnabled) {
+        auto loadStart = std::chrono::steady_clock::now();
+        bool hit = readCachedChunkLODs(chunkX, chunkZ, allLODData);
+        auto loadEnd = std::chrono::steady_clock::now();
+
+        if (hit) {
+            terrainCacheHits++;
+            terrainCacheLoadMicros += std::chrono::duration_cast<std::chrono::microseconds>(loadEnd - loadStart).count();
+            return allLODData;
+        }
+        terrainCacheMisses++;
+    }
+
+    auto generateStart = std::chrono::steady_clock::now();
+    allLODData = buildChunkLODs(chunkX, chunkZ);
+    auto generateEnd = std::chrono::steady_clock::now();
+    terrainGenerateMicros += std::chrono::duration_cast<std::chrono::microseconds>(generateEnd - generateStart).count();
+
+    if (terrainCacheEnabled) {
+        writeCachedChunkLODs(allLODData);
+    }
+
+    return allLODData;
+}
+
+/*
+    -------------------------------------------
+    readCachedChunkLODs, writeCachedChunkLODs
+    -------------------------------------------
+    A tile payload is the chunk's TerrainVertex stream for one LOD, already
+    quantised, so a hit is a memory-mapped copy with no noise evaluation.
+*/
+
+bool readCachedChunkLODs(int chunkX, int chunkZ, std::vector<ChunkData>& allLODData)
+{
+    allLODData.clear();
+    allLODData.reserve(NUM_TERRAIN_LODS);
+
+    for (int lod = 0; lod < NUM_TERRAIN_LODS; ++lod) {
+        unsigned int rowLength = TERRAIN_LOD_GRID_SIZES[lod] + 1;
+
+        ChunkData cd;
+        cd.vertices.resize(rowLength * rowLength);
+        cd.position = glm::vec2(chunkX * GRID_SIZE * GRID_SCALE, chunkZ * GRID_SIZE * GRID_SCALE);
+        cd.chunkX = chunkX;
+        cd.chunkZ = chunkZ;
+
+        TileKey key = { chunkX, chunkZ, static_cast<unsigned int>(lod), terrainNoiseHash };
+        if (!ReadTile(TERRAIN_CACHE_DIR, key, cd.vertices.data(), cd.vertices.size() * sizeof(TerrainVertex))) {
+            allLODData.clear();
+            return false;
+        }
+
+        allLODData.push_back(std::move(cd));
+    }
+
+    return true;
+}
+
+void writeCachedChunkLODs(const std::vector<ChunkData>& allLODData)
+{
+    for (size_t lod = 0; lod < allLODData.size(); ++lod) {
+        const ChunkData& cd = allLODData[lod];
+        TileKey key = { cd.chunkX, cd.chunkZ, static_cast<unsigned int>(lod), terrainNoiseHash };
+        if (!WriteTile(TERRAIN_CACHE_DIR, key, cd.vertices.data(), cd.vertices.size() * sizeof(TerrainVertex))) {
+            std::cerr << "Failed to write terrain tile " << cd.chunkX << "," << cd.chunkZ << " LOD" << lod << std::endl;
+        }
+    }
+}
+
+/*
+    ---------------------------
+    initTerrainCache
+    ---------------------------
+    Creates the cache directory and fixes the hash all tiles are keyed by.
+    Without a usable directory chunks are simply generated every time.
+*/
+
+void initTerrainCache()
+{
+    terrainNoiseHash = computeTerrainNoiseHash();
+    terrainCacheEnabled = CreateTileDirectory(TERRAIN_CACHE_DIR);
+    if (!terrainCacheEnabled) {
+        std::cerr << "Terrain tile cache disabled: cannot create " << TERRAIN_CACHE_DIR << std::endl;
+    }
+}
+
+/*
+    ---------------------------
+    computeTerrainNoiseHash
+    ---------------------------
+    Hashes every constant that shapes a tile, plus terrain heights at a few
+    probe points. The probes catch edits to configureTerrainNoise and
+    combineTerrainNoise, whose settings are not otherwise visible here.
+*/
+
+unsigned long long computeTerrainNoiseHash()
+{
+    unsigned long long hash = HashBytes(TERRAIN_LOD_GRID_SIZES, sizeof(TERRAIN_LOD_GRID_SIZES));
+    hash = HashBytes(TERRAIN_NOISE_SCALES, sizeof(TERRAIN_NOISE_SCALES), hash);
+
+    const float layout[] = {
+        static_cast<float>(GRID_SIZE), GRID_SCALE,
+        TERRAIN_HEIGHT_MIN, TERRAIN_HEIGHT_MAX,
+        static_cast<float>(sizeof(TerrainVertex))
+    };
+    hash = HashBytes(layout, sizeof(layout), hash);
+
+    for (int i = 0; i < 16; ++i) {
+        float probe = getTerrainHeight(i * 137.25f - 1000.0f, i * -91.5f + 700.0f);
+        hash = HashBytes(&probe, sizeof(probe), hash);
+    }
+
+    return hash;
+}
+
+/*
+    ---------------------------
+    reportTerrainCacheStats
+    ---------------------------
+    Prints hit rate and the average per-chunk cost of a cache load versus
+    generating from noise.
+*/
+
+void reportTerrainCacheStats()
+{
+    unsigned int hits = terrainCacheHits;
+    unsigned int misses = terrainCacheMisses;
+    unsigned int lookups = hits + misses;
+    if (lookups == 0) return;
+
+    printf("Terrain tile cache: %u/%u hits (%.1f%%), load %.3f ms/chunk, generate %.3f ms/chunk\n",
+           hits, lookups, 100.0 * hits / lookups,
+           hits ? terrainCacheLoadMicros / 1000.0 / hits : 0.0,
+           misses ? terrainGenerateMicros / 1000.0 / misses : 0.0);
+}
+
+/*
+    ---------------------------
+    prebakeTerrainRegion
+    ---------------------------
+    Fills the tile cache for the inclusive chunk rectangle using one thread
+    per core. Tiles that are already baked count as hits and are skipped.
+*/
+
+int prebakeTerrainRegion(int minChunkX, int minChunkZ, int maxChunkX, int maxChunkZ)
+{
+    if (!terrainCacheEnabled) return -1;
+    if (maxChunkX < minChunkX) std::swap(minChunkX, maxChunkX);
+    if (maxChunkZ < minChunkZ) std::swap(minChunkZ, maxChunkZ);
+
+    const int width = maxChunkX - minChunkX + 1;
+    const int total = width * (maxChunkZ - minChunkZ + 1);
+
+    std::atomic<int> nextChunk(0);
+    auto bakeTask = [&]() {
+        for (int i = nextChunk++; i < total; i = nextChunk++) {
+            loadChunkLODs(minChunkX + i % width, minChunkZ + i / width);
+        }
+    };
+
+    int threadCount = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    auto bakeStart = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> bakers;
+    for (int i = 0; i < threadCount; ++i) {
+        bakers.push_back(std::thread(bakeTask));
+    }
+    for (auto& baker : bakers) {
+        baker.join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - bakeStart).count();
+    printf("Baked %d chunks (%d..%d, %d..%d) on %d threads in %.2f s\n",
+           total, minChunkX, maxChunkX, minChunkZ, maxChunkZ, threadCount, seconds);
+    reportTerrainCacheStats();
+    return 0;
+}
+
+/*
+    ---------------------------
+    benchmarkTerrainNoise
+    ---------------------------
+    --noise-benchmark: times the runtime-dispatched FastNoiseLite paths
+    against the compile-time specialised ones on the terrain configuration,
+    for the same seeds and sample positions, and checks that both produce
+    identical values. Single-threaded; reports M samples/s.
+*/
+
+int benchmarkTerrainNoise()
+{
+    const int SEEDS[] = { 1337, 42, 2024 };
+    const int GRID = 104;                 // one padded LOD0 chunk row
+    const int GRID_REPEATS = 200;
+    const int SCALAR_SAMPLES = 1 << 20;
+
+    std::vector<float> axisX(GRID), axisZ(GRID);
+    for (int i = 0; i < GRID; ++i) {
+        axisX[i] = (i - 1) * TERRAIN_NOISE_SCALES[0] + 12.5f;
+        axisZ[i] = (i - 1) * TERRAIN_NOISE_SCALES[0] - 40.0f;
+    }
+
+    std::vector<float> sampleX(SCALAR_SAMPLES), sampleZ(SCALAR_SAMPLES);
+    for (int i = 0; i < SCALAR_SAMPLES; ++i) {
+        sampleX[i] = (i % 1024) * 0.37f - 150.0f;
+        sampleZ[i] = (i / 1024) * 0.29f + 75.0f;
+    }
+
+    // Seconds since start
+    auto seconds = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    bool identical = true;
+    double scalarRuntime = 0.0, scalarFixed = 0.0, gridRuntime = 0.0, gridFixed = 0.0;
+
+    for (int seed : SEEDS) {
+        FastNoiseLite noise(seed);
+        configureTerrainNoise(noise);
+
+        std::vector<float> runtimeOut(SCALAR_SAMPLES), fixedOut(SCALAR_SAMPLES);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < SCALAR_SAMPLES; ++i) {
+            runtimeOut[i] = noise.GetNoise(sampleX[i], sampleZ[i]);
+        }
+        scalarRuntime += seconds(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < SCALAR_SAMPLES; ++i) {
+            fixedOut[i] = noise.GetNoiseFixed<TERRAIN_NOISE_TYPE, TERRAIN_FRACTAL_TYPE, TERRAIN_NOISE_OCTAVES>(sampleX[i], sampleZ[i]);
+        }
+        scalarFixed += seconds(start);
+
+        identical = identical && std::memcmp(runtimeOut.data(), fixedOut.data(), SCALAR_SAMPLES * sizeof(float)) == 0;
+
+        std::vector<float> runtimeGrid(GRID * GRID), fixedGrid(GRID * GRID);
+
+        start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < GRID_REPEATS; ++repeat) {
+            noise.GetNoiseGrid(axisX.data(), GRID, axisZ.data(), GRID, runtimeGrid.data(), 1, GRID);
+        }
+        gridRuntime += seconds(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < GRID_REPEATS; ++repeat) {
+            noise.GetNoiseGridFixed<TERRAIN_NOISE_TYPE, TERRAIN_FRACTAL_TYPE, TERRAIN_NOISE_OCTAVES>(
+                axisX.data(), GRID, axisZ.data(), GRID, fixedGrid.data(), 1, GRID);
+        }
+        gridFixed += seconds(start);
+
+        identical = identical && std::memcmp(runtimeGrid.data(), fixedGrid.data(), GRID * GRID * sizeof(float)) == 0;
+    }
+
+    const double seedCount = sizeof(SEEDS) / sizeof(SEEDS[0]);
+    const double scalarSamples = seedCount * SCALAR_SAMPLES / 1e6;
+    const double gridSamples = seedCount * GRID * GRID * GRID_REPEATS / 1e6;
+
+    printf("Terrain noise (OpenSimplex2, FBm, %d octaves), %d seeds:\n", TERRAIN_NOISE_OCTAVES, (int)seedCount);
+    printf("  GetNoise      runtime %.2f M/s, fixed %.2f M/s (%.2fx)\n",
+           scalarSamples / scalarRuntime, scalarSamples / scalarFixed, scalarRuntime / scalarFixed);
+    printf("  GetNoiseGrid  runtime %.2f M/s, fixed %.2f M/s (%.2fx)\n",
+           gridSamples / gridRuntime, gridSamples / gridFixed, gridRuntime / gridFixed);
+    printf("  Outputs %s\n", identical ? "identical" : "DIFFER");
+
+    return identical ? 0 : 1;
+}
+
+/*
+    -----------------------------------
+    startChunkWorkers, stopChunkWorkers
+    -----------------------------------
+    Spawns the chunk worker pool (hardware_concurrency - 1 threads when
+    workerCount is 0) and shuts it down again at exit.
+*/
+
+void startChunkWorkers(int workerCount)
+{
+    if (workerCount <= 0) {
+        workerCount = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+    }
+    workerCount = std::max(workerCount, 1);
+
+    keepLoadingChunks = true;
+    for (int i = 0; i < workerCount; ++i) {
+        chunkWorkers.push_back(std::thread(chunkLoadingTask));
+    }
+}
+
+void stopChunkWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(chunkParkMutex);
+        keepLoadingChunks = false;
+    }
+    chunkRequestReady.notify_all();
+
+    for (auto& worker : chunkWorkers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    chunkWorkers.clear();
+}
 
 /*
     ----------------
@@ -1657,20 +3556,31 @@ void processInput(GLFWwindow *window, float deltaTime) {
         movement -= flatRight * movementSpeed;
     if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
         movement += flatRight * movementSpeed;
+    if (flightBenchmarkSeconds > 0.0f)
+        movement += flatForward * (flightBenchmarkSpeed * deltaTime);
 
     eye_center += movement;
+    eye_center.y = std::max(eye_center.y, terrainHeights.Height(eye_center.x, eye_center.z) + CAMERA_GROUND_CLEARANCE);
+    lookat = eye_center + forwardDirection * cameraViewDistance;
+
+    // CDLOD terrain re-selects its nodes every frame in updateCdlodTerrain
+    if (cdlodEnabled) return;
 
     float chunkSize = GRID_SIZE * GRID_SCALE;
     int newChunkX = static_cast<int>(std::floor(eye_center.x / chunkSize));
     int newChunkZ = static_cast<int>(std::floor(eye_center.z / chunkSize));
 
+    static glm::vec3 lastPriorityFocus = eye_center;
+
     if (newChunkX != currentChunkX || newChunkZ != currentChunkZ) {
         currentChunkX = newChunkX;
         currentChunkZ = newChunkZ;
         updateChunks(currentChunkX, currentChunkZ);
+        lastPriorityFocus = eye_center;
+    } else if (glm::distance(eye_center, lastPriorityFocus) > chunkSize * 0.25f) {
+        reprioritiseChunkRequests(eye_center);
+        lastPriorityFocus = eye_center;
     }
-
-    lookat = eye_center + forwardDirection * cameraViewDistance;
 }
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode) {
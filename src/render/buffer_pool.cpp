@@ -0,0 +1,101 @@
+#include "buffer_pool.h"
+
+#include <cstddef>
+
+void InitBufferPool(BufferPool& pool, GLsizeiptr slotSize, GLsizeiptr budgetBytes)
+{
+	pool.slotSize = slotSize;
+	pool.budgetBytes = budgetBytes;
+	pool.buffers.clear();
+	pool.freeSlots.clear();
+	pool.pendingSlots.clear();
+	pool.slotsInUse = 0;
+}
+
+void DestroyBufferPool(BufferPool& pool)
+{
+	for (const PendingBufferSlot& pending : pool.pendingSlots)
+	{
+		glClientWaitSync(pending.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		glDeleteSync(pending.fence);
+	}
+
+	if (!pool.buffers.empty())
+		glDeleteBuffers(static_cast<GLsizei>(pool.buffers.size()), pool.buffers.data());
+
+	InitBufferPool(pool, pool.slotSize, pool.budgetBytes);
+}
+
+int AcquireBufferSlot(BufferPool& pool, bool* created)
+{
+	if (created)
+		*created = false;
+
+	if (pool.freeSlots.empty())
+		CollectBufferSlots(pool);
+
+	if (!pool.freeSlots.empty())
+	{
+		int slot = pool.freeSlots.back();
+		pool.freeSlots.pop_back();
+		pool.slotsInUse++;
+		return slot;
+	}
+
+	GLsizeiptr allocated = static_cast<GLsizeiptr>(pool.buffers.size()) * pool.slotSize;
+	if (allocated + pool.slotSize > pool.budgetBytes)
+		return -1;
+
+	// Storage is allocated once here; chunks only ever glBufferSubData into it
+	GLuint buffer;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, pool.slotSize, nullptr, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	pool.buffers.push_back(buffer);
+	pool.slotsInUse++;
+	if (created)
+		*created = true;
+	return static_cast<int>(pool.buffers.size()) - 1;
+}
+
+void ReleaseBufferSlot(BufferPool& pool, int slot)
+{
+	PendingBufferSlot pending;
+	pending.slot = slot;
+	pending.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	pool.pendingSlots.push_back(pending);
+	pool.slotsInUse--;
+}
+
+void CollectBufferSlots(BufferPool& pool)
+{
+	size_t kept = 0;
+	for (size_t i = 0; i < pool.pendingSlots.size(); ++i)
+	{
+		const PendingBufferSlot& pending = pool.pendingSlots[i];
+		GLenum status = glClientWaitSync(pending.fence, 0, 0);
+		if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+		{
+			glDeleteSync(pending.fence);
+			pool.freeSlots.push_back(pending.slot);
+		}
+		else
+		{
+			pool.pendingSlots[kept++] = pending;
+		}
+	}
+	pool.pendingSlots.resize(kept);
+}
+
+BufferPoolOccupancy GetBufferPoolOccupancy(const BufferPool& pool)
+{
+	BufferPoolOccupancy occupancy;
+	occupancy.inUse = pool.slotsInUse;
+	occupancy.pending = static_cast<unsigned int>(pool.pendingSlots.size());
+	occupancy.free = static_cast<unsigned int>(pool.freeSlots.size());
+	occupancy.allocatedBytes = static_cast<GLsizeiptr>(pool.buffers.size()) * pool.slotSize;
+	occupancy.budgetBytes = pool.budgetBytes;
+	return occupancy;
+}
@@ -0,0 +1,52 @@
+#ifndef _BUFFER_POOL_H_
+#define _BUFFER_POOL_H_
+
+#include <glad/gl.h>
+#include <vector>
+
+// Slot returned to the pool but possibly still read by in-flight draws
+struct PendingBufferSlot
+{
+	int slot;
+	GLsync fence;
+};
+
+// Fixed-size GL_ARRAY_BUFFER slots, created lazily up to a VRAM budget.
+// Released slots are only reused once the GPU has passed their fence.
+struct BufferPool
+{
+	GLsizeiptr slotSize;
+	GLsizeiptr budgetBytes;
+	std::vector<GLuint> buffers;
+	std::vector<int> freeSlots;
+	std::vector<PendingBufferSlot> pendingSlots;
+	unsigned int slotsInUse;
+};
+
+struct BufferPoolOccupancy
+{
+	unsigned int inUse;
+	unsigned int pending;
+	unsigned int free;
+	GLsizeiptr allocatedBytes;
+	GLsizeiptr budgetBytes;
+};
+
+void InitBufferPool(BufferPool& pool, GLsizeiptr slotSize, GLsizeiptr budgetBytes);
+
+// Deletes every buffer, waiting for outstanding fences first.
+void DestroyBufferPool(BufferPool& pool);
+
+// Returns a free slot (allocating a new buffer while under budget), or -1.
+// `created` is set when the slot's buffer did not exist before this call.
+int AcquireBufferSlot(BufferPool& pool, bool* created = nullptr);
+
+// Hands a slot back; it becomes reusable after the commands issued so far complete.
+void ReleaseBufferSlot(BufferPool& pool, int slot);
+
+// Moves pending slots whose fence has signalled back to the free list.
+void CollectBufferSlots(BufferPool& pool);
+
+BufferPoolOccupancy GetBufferPoolOccupancy(const BufferPool& pool);
+
+#endif
@@ -0,0 +1,30 @@
+#include "frame_uniforms.h"
+
+static_assert(sizeof(FrameUniforms) == 5 * 64 + 4 * 16, "FrameUniforms must match the std140 block");
+
+void InitFrameUniformBuffer(FrameUniformBuffer& frameUniforms)
+{
+	frameUniforms.data = FrameUniforms();
+
+	glGenBuffers(1, &frameUniforms.buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, frameUniforms.buffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, frameUniforms.buffer);
+}
+
+void DestroyFrameUniformBuffer(FrameUniformBuffer& frameUniforms)
+{
+	if (frameUniforms.buffer)
+		glDeleteBuffers(1, &frameUniforms.buffer);
+	frameUniforms.buffer = 0;
+}
+
+void UploadFrameUniforms(FrameUniformBuffer& frameUniforms)
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, frameUniforms.buffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &frameUniforms.data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, frameUniforms.buffer);
+}
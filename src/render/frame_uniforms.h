@@ -0,0 +1,47 @@
+#ifndef _FRAME_UNIFORMS_H_
+#define _FRAME_UNIFORMS_H_
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+
+// Frame-constant shader inputs, shared by every program through one std140
+// uniform block bound at FRAME_UNIFORM_BINDING. The GLSL side is
+//
+//     layout(std140) uniform FrameUniforms {
+//         mat4 vpMatrix;
+//         mat4 lightSpaceMatrices[4];
+//         vec4 cascadeDepthBias;
+//         vec3 lightDir;
+//         vec3 lightColor;
+//         vec3 viewPos;
+//     };
+//
+// std140 pads each vec3 to 16 bytes, hence the vec4 members here; the
+// layout must be kept in step with the shaders by hand.
+const GLuint FRAME_UNIFORM_BINDING = 0;
+const int FRAME_UNIFORM_CASCADES = 4;
+
+struct FrameUniforms
+{
+	glm::mat4 vpMatrix;
+	glm::mat4 lightSpaceMatrices[FRAME_UNIFORM_CASCADES];
+	glm::vec4 cascadeDepthBias;
+	glm::vec4 lightDir;
+	glm::vec4 lightColor;
+	glm::vec4 viewPos;
+};
+
+struct FrameUniformBuffer
+{
+	GLuint buffer;
+	FrameUniforms data;
+};
+
+void InitFrameUniformBuffer(FrameUniformBuffer& frameUniforms);
+void DestroyFrameUniformBuffer(FrameUniformBuffer& frameUniforms);
+
+// Sends `data` (orphaning last frame's storage) and binds the buffer to
+// FRAME_UNIFORM_BINDING; called once per frame before the first draw.
+void UploadFrameUniforms(FrameUniformBuffer& frameUniforms);
+
+#endif
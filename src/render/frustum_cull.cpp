@@ -0,0 +1,160 @@
+#include "frustum_cull.h"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRUSTUM_CULL_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+inline bool SphereVisible(const Frustum& frustum, float x, float y, float z, float radius)
+{
+	for (int p = 0; p < 6; ++p)
+	{
+		const glm::vec4& plane = frustum.planes[p];
+		if (plane.x * x + plane.y * y + plane.z * z + plane.w < -radius)
+			return false;
+	}
+	return true;
+}
+
+// Only the corner furthest along the plane normal needs testing
+inline bool BoxVisible(const Frustum& frustum, const CullBoxList& boxes, size_t i)
+{
+	for (int p = 0; p < 6; ++p)
+	{
+		const glm::vec4& plane = frustum.planes[p];
+		float x = plane.x >= 0.0f ? boxes.maxX[i] : boxes.minX[i];
+		float y = plane.y >= 0.0f ? boxes.maxY[i] : boxes.minY[i];
+		float z = plane.z >= 0.0f ? boxes.maxZ[i] : boxes.minZ[i];
+		if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+#ifdef FRUSTUM_CULL_SSE2
+inline void AppendMask(int mask, size_t first, std::vector<unsigned int>& visible)
+{
+	while (mask)
+	{
+		int lane = 0;
+		while (!(mask & (1 << lane)))
+			++lane;
+		visible.push_back(static_cast<unsigned int>(first + lane));
+		mask &= mask - 1;
+	}
+}
+#endif
+
+} // namespace
+
+Frustum ExtractFrustum(const glm::mat4& viewProjection)
+{
+	// Row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; ++i)
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+	Frustum frustum;
+	frustum.planes[0] = rows[3] + rows[0];
+	frustum.planes[1] = rows[3] - rows[0];
+	frustum.planes[2] = rows[3] + rows[1];
+	frustum.planes[3] = rows[3] - rows[1];
+	frustum.planes[4] = rows[3] + rows[2];
+	frustum.planes[5] = rows[3] - rows[2];
+
+	for (int p = 0; p < 6; ++p)
+		frustum.planes[p] /= glm::length(glm::vec3(frustum.planes[p]));
+	return frustum;
+}
+
+void CullSpheres(const Frustum& frustum, const CullSphereList& spheres, std::vector<unsigned int>& visible)
+{
+	const size_t count = spheres.x.size();
+	size_t i = 0;
+
+#ifdef FRUSTUM_CULL_SSE2
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	for (int p = 0; p < 6; ++p)
+	{
+		planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+		planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+		planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+		planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(&spheres.x[i]);
+		__m128 y = _mm_loadu_ps(&spheres.y[i]);
+		__m128 z = _mm_loadu_ps(&spheres.z[i]);
+		__m128 negativeRadius = _mm_sub_ps(zero, _mm_loadu_ps(&spheres.radius[i]));
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < 6; ++p)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)),
+				_mm_add_ps(_mm_mul_ps(planeZ[p], z), planeW[p]));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+		}
+
+		AppendMask(_mm_movemask_ps(inside), i, visible);
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		if (SphereVisible(frustum, spheres.x[i], spheres.y[i], spheres.z[i], spheres.radius[i]))
+			visible.push_back(static_cast<unsigned int>(i));
+	}
+}
+
+void CullBoxes(const Frustum& frustum, const CullBoxList& boxes, std::vector<unsigned int>& visible)
+{
+	const size_t count = boxes.minX.size();
+	size_t i = 0;
+
+#ifdef FRUSTUM_CULL_SSE2
+	// Per plane, which bound of each axis is its furthest corner
+	const float* cornerX[6];
+	const float* cornerY[6];
+	const float* cornerZ[6];
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	for (int p = 0; p < 6; ++p)
+	{
+		const glm::vec4& plane = frustum.planes[p];
+		cornerX[p] = plane.x >= 0.0f ? boxes.maxX.data() : boxes.minX.data();
+		cornerY[p] = plane.y >= 0.0f ? boxes.maxY.data() : boxes.minY.data();
+		cornerZ[p] = plane.z >= 0.0f ? boxes.maxZ.data() : boxes.minZ.data();
+		planeX[p] = _mm_set1_ps(plane.x);
+		planeY[p] = _mm_set1_ps(plane.y);
+		planeZ[p] = _mm_set1_ps(plane.z);
+		planeW[p] = _mm_set1_ps(plane.w);
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < 6; ++p)
+		{
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(planeX[p], _mm_loadu_ps(cornerX[p] + i)), _mm_mul_ps(planeY[p], _mm_loadu_ps(cornerY[p] + i))),
+				_mm_add_ps(_mm_mul_ps(planeZ[p], _mm_loadu_ps(cornerZ[p] + i)), planeW[p]));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, zero));
+		}
+
+		AppendMask(_mm_movemask_ps(inside), i, visible);
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		if (BoxVisible(frustum, boxes, i))
+			visible.push_back(static_cast<unsigned int>(i));
+	}
+}
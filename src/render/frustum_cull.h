@@ -0,0 +1,35 @@
+#ifndef _FRUSTUM_CULL_H_
+#define _FRUSTUM_CULL_H_
+
+#include <glm/glm.hpp>
+#include <vector>
+
+// View frustum as six inward-facing planes (left, right, bottom, top, near,
+// far), each (normal, d) normalised so plane distances are in world units.
+struct Frustum
+{
+	glm::vec4 planes[6];
+};
+
+// Gribb-Hartmann extraction from a (column-major) view-projection matrix.
+Frustum ExtractFrustum(const glm::mat4& viewProjection);
+
+// Structure-of-arrays bounds, so four of them are tested per SSE operation.
+// Both tests are conservative: an object is only dropped when it lies
+// entirely behind one plane.
+struct CullSphereList
+{
+	std::vector<float> x, y, z, radius;
+};
+
+struct CullBoxList
+{
+	std::vector<float> minX, minY, minZ;
+	std::vector<float> maxX, maxY, maxZ;
+};
+
+// Append the indices of the visible spheres / boxes, in order, to `visible`.
+void CullSpheres(const Frustum& frustum, const CullSphereList& spheres, std::vector<unsigned int>& visible);
+void CullBoxes(const Frustum& frustum, const CullBoxList& boxes, std::vector<unsigned int>& visible);
+
+#endif
@@ -0,0 +1,164 @@
+#include "gl_state_cache.h"
+
+#include <cstring>
+
+void ResetGLStateCache(GLStateCache& cache)
+{
+	cache.program = ~0u;
+	cache.vertexArray = ~0u;
+	cache.activeUnit = ~0u;
+	for (int unit = 0; unit < GL_STATE_TEXTURE_UNITS; ++unit)
+	{
+		cache.textures[unit] = ~0u;
+		cache.textureTargets[unit] = GL_NONE;
+	}
+	cache.depthTest = -1;
+	cache.depthWrite = -1;
+	cache.blend = -1;
+	cache.uniformSlots.clear();
+	cache.uniformValues.clear();
+}
+
+void ResetGLStateCounters(GLStateCache& cache)
+{
+	std::memset(&cache.requested, 0, sizeof(cache.requested));
+	std::memset(&cache.issued, 0, sizeof(cache.issued));
+}
+
+void CacheUseProgram(GLStateCache& cache, GLuint program)
+{
+	cache.requested.programs++;
+	if (cache.program == program)
+		return;
+
+	glUseProgram(program);
+	cache.program = program;
+	cache.issued.programs++;
+}
+
+void CacheBindVertexArray(GLStateCache& cache, GLuint vertexArray)
+{
+	cache.requested.vertexArrays++;
+	if (cache.vertexArray == vertexArray)
+		return;
+
+	glBindVertexArray(vertexArray);
+	cache.vertexArray = vertexArray;
+	cache.issued.vertexArrays++;
+}
+
+void CacheBindTexture(GLStateCache& cache, GLuint unit, GLenum target, GLuint texture)
+{
+	cache.requested.textures++;
+	if (unit < GL_STATE_TEXTURE_UNITS && cache.textures[unit] == texture && cache.textureTargets[unit] == target)
+		return;
+
+	if (cache.activeUnit != GL_TEXTURE0 + unit)
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+		cache.activeUnit = GL_TEXTURE0 + unit;
+	}
+	glBindTexture(target, texture);
+	if (unit < GL_STATE_TEXTURE_UNITS)
+	{
+		cache.textures[unit] = texture;
+		cache.textureTargets[unit] = target;
+	}
+	cache.issued.textures++;
+}
+
+void CacheSetRenderState(GLStateCache& cache, bool depthTest, bool depthWrite, bool blend)
+{
+	cache.requested.renderStates++;
+	if (cache.depthTest == int(depthTest) && cache.depthWrite == int(depthWrite) && cache.blend == int(blend))
+		return;
+
+	if (cache.depthTest != int(depthTest))
+	{
+		if (depthTest)
+			glEnable(GL_DEPTH_TEST);
+		else
+			glDisable(GL_DEPTH_TEST);
+	}
+	if (cache.depthWrite != int(depthWrite))
+		glDepthMask(depthWrite ? GL_TRUE : GL_FALSE);
+	if (cache.blend != int(blend))
+	{
+		if (blend)
+			glEnable(GL_BLEND);
+		else
+			glDisable(GL_BLEND);
+	}
+
+	cache.depthTest = depthTest;
+	cache.depthWrite = depthWrite;
+	cache.blend = blend;
+	cache.issued.renderStates++;
+}
+
+unsigned int UniformTypeWords(GLenum type)
+{
+	switch (type)
+	{
+	case GL_FLOAT:
+	case GL_INT:
+		return 1;
+	case GL_FLOAT_VEC2:
+		return 2;
+	case GL_FLOAT_VEC3:
+		return 3;
+	case GL_FLOAT_VEC4:
+		return 4;
+	case GL_FLOAT_MAT4:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+void CacheUniform(GLStateCache& cache, GLint location, GLenum type, const unsigned int* words)
+{
+	cache.requested.uniforms++;
+	unsigned int count = UniformTypeWords(type);
+	if (location < 0 || count == 0)
+		return;
+
+	unsigned long long key = (static_cast<unsigned long long>(cache.program) << 32) | static_cast<unsigned int>(location);
+	auto found = cache.uniformSlots.find(key);
+	if (found != cache.uniformSlots.end())
+	{
+		unsigned int* cached = &cache.uniformValues[found->second];
+		if (std::memcmp(cached, words, count * sizeof(unsigned int)) == 0)
+			return;
+		std::memcpy(cached, words, count * sizeof(unsigned int));
+	}
+	else
+	{
+		cache.uniformSlots[key] = static_cast<unsigned int>(cache.uniformValues.size());
+		cache.uniformValues.insert(cache.uniformValues.end(), words, words + count);
+	}
+
+	const GLfloat* values = reinterpret_cast<const GLfloat*>(words);
+	switch (type)
+	{
+	case GL_FLOAT:
+		glUniform1fv(location, 1, values);
+		break;
+	case GL_FLOAT_VEC2:
+		glUniform2fv(location, 1, values);
+		break;
+	case GL_FLOAT_VEC3:
+		glUniform3fv(location, 1, values);
+		break;
+	case GL_FLOAT_VEC4:
+		glUniform4fv(location, 1, values);
+		break;
+	case GL_FLOAT_MAT4:
+		glUniformMatrix4fv(location, 1, GL_FALSE, values);
+		break;
+	case GL_INT:
+		glUniform1iv(location, 1, reinterpret_cast<const GLint*>(words));
+		break;
+	}
+	cache.issued.uniforms++;
+}
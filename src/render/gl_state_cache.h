@@ -0,0 +1,59 @@
+#ifndef _GL_STATE_CACHE_H_
+#define _GL_STATE_CACHE_H_
+
+#include <glad/gl.h>
+#include <unordered_map>
+#include <vector>
+
+const int GL_STATE_TEXTURE_UNITS = 16;
+
+// State changes asked for and state changes sent to GL. `requested` counts
+// every bind and uniform write a draw needs, which is what issuing each draw
+// in full would cost; `issued` only those that changed the current state.
+struct GLStateCounters
+{
+	unsigned int programs;
+	unsigned int vertexArrays;
+	unsigned int textures;
+	unsigned int uniforms;
+	unsigned int renderStates;
+};
+
+// Shadow of the GL bindings the render queue touches, so redundant binds are
+// skipped. It only knows what went through it: after any direct GL call that
+// may change these bindings, ResetGLStateCache before using it again.
+// Uniform values are remembered per (program, location) until the reset.
+struct GLStateCache
+{
+	GLuint program;
+	GLuint vertexArray;
+	GLenum activeUnit;
+	GLuint textures[GL_STATE_TEXTURE_UNITS];
+	GLenum textureTargets[GL_STATE_TEXTURE_UNITS];
+	int depthTest;                // -1 while unknown
+	int depthWrite;
+	int blend;
+
+	std::unordered_map<unsigned long long, unsigned int> uniformSlots;   // offset of the cached value in uniformValues
+	std::vector<unsigned int> uniformValues;
+
+	GLStateCounters requested;
+	GLStateCounters issued;
+};
+
+void ResetGLStateCache(GLStateCache& cache);
+void ResetGLStateCounters(GLStateCache& cache);
+
+void CacheUseProgram(GLStateCache& cache, GLuint program);
+void CacheBindVertexArray(GLStateCache& cache, GLuint vertexArray);
+void CacheBindTexture(GLStateCache& cache, GLuint unit, GLenum target, GLuint texture);
+void CacheSetRenderState(GLStateCache& cache, bool depthTest, bool depthWrite, bool blend);
+
+// Writes a uniform of the bound program unless it already holds `words`
+// (its value as 32-bit words). Supports float, vec2, vec3, vec4, int and mat4.
+void CacheUniform(GLStateCache& cache, GLint location, GLenum type, const unsigned int* words);
+
+// Number of 32-bit words of a uniform type CacheUniform accepts, 0 otherwise.
+unsigned int UniformTypeWords(GLenum type);
+
+#endif
@@ -0,0 +1,270 @@
+#include "gltf_model.h"
+
+#include <tinygltf-2.9.3/tiny_gltf.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <set>
+#include <string>
+
+namespace {
+
+// One component of an accessor element as a float, applying glTF normalisation
+float ReadComponent(const unsigned char* data, int componentType, bool normalized)
+{
+	switch (componentType)
+	{
+	case TINYGLTF_COMPONENT_TYPE_FLOAT:
+	{
+		float value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+		return normalized ? data[0] / 255.0f : data[0];
+	case TINYGLTF_COMPONENT_TYPE_BYTE:
+	{
+		float value = static_cast<signed char>(data[0]);
+		return normalized ? std::max(value / 127.0f, -1.0f) : value;
+	}
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+	{
+		unsigned short value;
+		std::memcpy(&value, data, sizeof(value));
+		return normalized ? value / 65535.0f : value;
+	}
+	case TINYGLTF_COMPONENT_TYPE_SHORT:
+	{
+		short value;
+		std::memcpy(&value, data, sizeof(value));
+		return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+	}
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+	{
+		unsigned int value;
+		std::memcpy(&value, data, sizeof(value));
+		return static_cast<float>(value);
+	}
+	default:
+		return 0.0f;
+	}
+}
+
+// Copies up to `components` components of each element of an accessor into
+// the float member at `member` (a byte offset into GltfVertex) of the
+// vertices starting at `firstVertex`
+void CopyAttribute(const tinygltf::Model& gltf, const tinygltf::Accessor& accessor,
+	std::vector<GltfVertex>& vertices, size_t firstVertex, size_t member, int components)
+{
+	if (accessor.bufferView < 0)
+		return;
+
+	const tinygltf::BufferView& view = gltf.bufferViews[accessor.bufferView];
+	const tinygltf::Buffer& buffer = gltf.buffers[view.buffer];
+	int stride = accessor.ByteStride(view);
+	int componentSize = tinygltf::GetComponentSizeInBytes(static_cast<uint32_t>(accessor.componentType));
+	int count = std::min(components, tinygltf::GetNumComponentsInType(static_cast<uint32_t>(accessor.type)));
+	if (stride <= 0 || componentSize <= 0 || count <= 0)
+		return;
+
+	const unsigned char* source = buffer.data.data() + view.byteOffset + accessor.byteOffset;
+	for (size_t i = 0; i < accessor.count; ++i)
+	{
+		float* destination = reinterpret_cast<float*>(reinterpret_cast<unsigned char*>(&vertices[firstVertex + i]) + member);
+		for (int c = 0; c < count; ++c)
+			destination[c] = ReadComponent(source + i * stride + c * componentSize, accessor.componentType, accessor.normalized);
+	}
+}
+
+void AppendIndices(const tinygltf::Model& gltf, const tinygltf::Accessor& accessor, std::vector<unsigned int>& indices)
+{
+	if (accessor.bufferView < 0)
+		return;
+
+	const tinygltf::BufferView& view = gltf.bufferViews[accessor.bufferView];
+	const tinygltf::Buffer& buffer = gltf.buffers[view.buffer];
+	int stride = accessor.ByteStride(view);
+	const unsigned char* source = buffer.data.data() + view.byteOffset + accessor.byteOffset;
+
+	for (size_t i = 0; i < accessor.count; ++i)
+	{
+		const unsigned char* element = source + i * stride;
+		switch (accessor.componentType)
+		{
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+			indices.push_back(element[0]);
+			break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+		{
+			unsigned short value;
+			std::memcpy(&value, element, sizeof(value));
+			indices.push_back(value);
+			break;
+		}
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+		{
+			unsigned int value;
+			std::memcpy(&value, element, sizeof(value));
+			indices.push_back(value);
+			break;
+		}
+		}
+	}
+}
+
+} // namespace
+
+bool LoadGltfModel(GltfModel& model, const char* path)
+{
+	model.VAO = 0;
+	model.vertexBuffer = 0;
+	model.indexBuffer = 0;
+	model.indexType = GL_UNSIGNED_SHORT;
+	model.primitives.clear();
+	model.uploadedBytes = 0;
+	model.bufferViewBytes = 0;
+	model.cpuBytes = 0;
+
+	// Only lives for this call, so its buffers and images are freed on return
+	tinygltf::Model gltf;
+	tinygltf::TinyGLTF loader;
+	std::string err, warn;
+
+	bool success = loader.LoadBinaryFromFile(&gltf, &err, &warn, path);
+	if (!warn.empty())
+		std::cerr << "Warning: " << warn << std::endl;
+	if (!success)
+	{
+		std::cerr << "Failed to load glTF model " << path << ": " << err << std::endl;
+		return false;
+	}
+
+	for (const tinygltf::Buffer& buffer : gltf.buffers)
+		model.cpuBytes += buffer.data.size();
+	for (const tinygltf::Image& image : gltf.images)
+		model.cpuBytes += image.image.size();
+
+	std::vector<GltfVertex> vertices;
+	std::vector<unsigned int> indices;
+	std::set<std::string> ignored;
+	size_t largestPrimitive = 0;
+
+	for (const tinygltf::Mesh& mesh : gltf.meshes)
+	{
+		for (const tinygltf::Primitive& primitive : mesh.primitives)
+		{
+			auto position = primitive.attributes.find("POSITION");
+			if (position == primitive.attributes.end())
+			{
+				std::cerr << "Skipping a primitive of " << path << " without POSITION." << std::endl;
+				continue;
+			}
+
+			const tinygltf::Accessor& positions = gltf.accessors[position->second];
+			size_t firstVertex = vertices.size();
+			vertices.resize(firstVertex + positions.count, GltfVertex());
+			largestPrimitive = std::max(largestPrimitive, positions.count);
+
+			for (const auto& attribute : primitive.attributes)
+			{
+				const tinygltf::Accessor& accessor = gltf.accessors[attribute.second];
+				if (accessor.bufferView >= 0)
+					model.bufferViewBytes += gltf.bufferViews[accessor.bufferView].byteLength;
+				if (accessor.sparse.isSparse)
+					std::cerr << "Warning: sparse " << attribute.first << " in " << path << " is read without its sparse values." << std::endl;
+
+				if (accessor.count != positions.count)
+					continue;
+				if (attribute.first == "POSITION")
+					CopyAttribute(gltf, accessor, vertices, firstVertex, offsetof(GltfVertex, position), 3);
+				else if (attribute.first == "NORMAL")
+					CopyAttribute(gltf, accessor, vertices, firstVertex, offsetof(GltfVertex, normal), 3);
+				else if (attribute.first == "TEXCOORD_0")
+					CopyAttribute(gltf, accessor, vertices, firstVertex, offsetof(GltfVertex, texCoord), 2);
+				else
+					ignored.insert(attribute.first);
+			}
+
+			GltfPrimitive drawn;
+			drawn.mode = primitive.mode >= 0 ? static_cast<GLenum>(primitive.mode) : GL_TRIANGLES;
+			drawn.baseVertex = static_cast<GLint>(firstVertex);
+			drawn.firstIndex = static_cast<GLintptr>(indices.size());
+
+			if (primitive.indices >= 0)
+			{
+				const tinygltf::Accessor& accessor = gltf.accessors[primitive.indices];
+				if (accessor.bufferView >= 0)
+					model.bufferViewBytes += gltf.bufferViews[accessor.bufferView].byteLength;
+				AppendIndices(gltf, accessor, indices);
+			}
+			else
+			{
+				indices.resize(indices.size() + positions.count);
+				std::iota(indices.begin() + drawn.firstIndex, indices.end(), 0u);
+			}
+			drawn.indexCount = static_cast<GLsizei>(indices.size() - drawn.firstIndex);
+
+			drawn.hasBounds = positions.minValues.size() >= 3 && positions.maxValues.size() >= 3;
+			drawn.boundsMin = drawn.hasBounds ? glm::vec3(positions.minValues[0], positions.minValues[1], positions.minValues[2]) : glm::vec3(0.0f);
+			drawn.boundsMax = drawn.hasBounds ? glm::vec3(positions.maxValues[0], positions.maxValues[1], positions.maxValues[2]) : glm::vec3(0.0f);
+
+			model.primitives.push_back(drawn);
+		}
+	}
+
+	for (const std::string& attribute : ignored)
+		std::cerr << "Warning: " << attribute << " in " << path << " is present but ignored." << std::endl;
+
+	// Indices are relative to each primitive's base vertex, so 16 bits do
+	// unless a single primitive has more vertices than that
+	model.indexType = largestPrimitive > 65536 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+	GLsizeiptr indexSize = model.indexType == GL_UNSIGNED_INT ? sizeof(unsigned int) : sizeof(unsigned short);
+	for (GltfPrimitive& primitive : model.primitives)
+		primitive.firstIndex *= indexSize;
+
+	glGenVertexArrays(1, &model.VAO);
+	glGenBuffers(1, &model.vertexBuffer);
+	glGenBuffers(1, &model.indexBuffer);
+	glBindVertexArray(model.VAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, model.vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GltfVertex), vertices.data(), GL_STATIC_DRAW);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model.indexBuffer);
+	if (model.indexType == GL_UNSIGNED_SHORT)
+	{
+		std::vector<unsigned short> shortIndices(indices.begin(), indices.end());
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(unsigned short), shortIndices.data(), GL_STATIC_DRAW);
+	}
+	else
+	{
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+	}
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GltfVertex), (void*)offsetof(GltfVertex, position));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GltfVertex), (void*)offsetof(GltfVertex, normal));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(GltfVertex), (void*)offsetof(GltfVertex, texCoord));
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	model.uploadedBytes = vertices.size() * sizeof(GltfVertex) + indices.size() * indexSize;
+	return true;
+}
+
+void DestroyGltfModel(GltfModel& model)
+{
+	glDeleteVertexArrays(1, &model.VAO);
+	glDeleteBuffers(1, &model.vertexBuffer);
+	glDeleteBuffers(1, &model.indexBuffer);
+	model.VAO = 0;
+	model.vertexBuffer = 0;
+	model.indexBuffer = 0;
+	model.primitives.clear();
+}
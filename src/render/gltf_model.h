@@ -0,0 +1,51 @@
+#ifndef _GLTF_MODEL_H_
+#define _GLTF_MODEL_H_
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Vertex layout every glTF primitive is repacked into: attribute 0 position,
+// 1 normal, 2 TEXCOORD_0. Missing attributes are zero.
+struct GltfVertex
+{
+	float position[3];
+	float normal[3];
+	float texCoord[2];
+};
+
+// One glTF primitive, drawn from its model's shared buffers with a base vertex
+struct GltfPrimitive
+{
+	GLenum mode;
+	GLsizei indexCount;
+	GLintptr firstIndex;          // byte offset into indexBuffer
+	GLint baseVertex;
+	bool hasBounds;               // POSITION min/max were present
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+};
+
+// A .glb file's primitives (every mesh's, in file order) repacked into one
+// interleaved vertex buffer and one index buffer, read through a single VAO.
+// Primitives without indices get sequential ones, so all of them are drawn
+// with glDrawElements*BaseVertex. The tinygltf model is released once the
+// buffers are uploaded; only the draw ranges and bounds are kept.
+struct GltfModel
+{
+	GLuint VAO;
+	GLuint vertexBuffer;
+	GLuint indexBuffer;
+	GLenum indexType;             // GL_UNSIGNED_SHORT unless a primitive needs 32-bit indices
+	std::vector<GltfPrimitive> primitives;
+
+	GLsizeiptr uploadedBytes;     // vertex plus index buffer
+	GLsizeiptr bufferViewBytes;   // one upload of every bufferView a primitive referenced, per reference
+	size_t cpuBytes;              // buffer and image data freed with the tinygltf model
+};
+
+// Returns false, with an empty model, when the file cannot be loaded.
+bool LoadGltfModel(GltfModel& model, const char* path);
+void DestroyGltfModel(GltfModel& model);
+
+#endif
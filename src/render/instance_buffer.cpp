@@ -0,0 +1,224 @@
+#include "instance_buffer.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+void ClearInstanceBounds(CullSphereList& bounds)
+{
+	bounds.x.clear();
+	bounds.y.clear();
+	bounds.z.clear();
+	bounds.radius.clear();
+}
+
+// Largest axis scale of the matrix bounds the transformed sphere
+void PushInstanceBounds(CullSphereList& bounds, const glm::mat4& matrix, const glm::vec4& modelBounds)
+{
+	glm::vec4 centre = matrix * glm::vec4(glm::vec3(modelBounds), 1.0f);
+	float scale = std::max(glm::length(glm::vec3(matrix[0])),
+		std::max(glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2]))));
+
+	bounds.x.push_back(centre.x);
+	bounds.y.push_back(centre.y);
+	bounds.z.push_back(centre.z);
+	bounds.radius.push_back(modelBounds.w * scale);
+}
+
+void CopyInstanceBounds(CullSphereList& bounds, unsigned int to, unsigned int from)
+{
+	bounds.x[to] = bounds.x[from];
+	bounds.y[to] = bounds.y[from];
+	bounds.z[to] = bounds.z[from];
+	bounds.radius[to] = bounds.radius[from];
+}
+
+void PopInstanceBounds(CullSphereList& bounds)
+{
+	bounds.x.pop_back();
+	bounds.y.pop_back();
+	bounds.z.pop_back();
+	bounds.radius.pop_back();
+}
+
+} // namespace
+
+void InitInstanceBuffer(InstanceBuffer& instanceBuffer, size_t initialCapacity, const glm::vec4& modelBounds)
+{
+	instanceBuffer.capacity = std::max<size_t>(initialCapacity, 1);
+	instanceBuffer.instances.clear();
+	instanceBuffer.owners.clear();
+	instanceBuffer.ownerSlots.clear();
+	instanceBuffer.ownerInstances.clear();
+	instanceBuffer.dirty.clear();
+	instanceBuffer.reallocate = false;
+	instanceBuffer.uploadedBytes = 0;
+	instanceBuffer.modelBounds = modelBounds;
+	ClearInstanceBounds(instanceBuffer.bounds);
+	instanceBuffer.visible.clear();
+
+	glGenBuffers(1, &instanceBuffer.buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer.buffer);
+	glBufferData(GL_ARRAY_BUFFER, instanceBuffer.capacity * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+
+	glGenBuffers(1, &instanceBuffer.visibleBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer.visibleBuffer);
+	glBufferData(GL_ARRAY_BUFFER, instanceBuffer.capacity * sizeof(unsigned int), nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// The view follows the buffer through every later glBufferData
+	glGenTextures(1, &instanceBuffer.texture);
+	glBindTexture(GL_TEXTURE_BUFFER, instanceBuffer.texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, instanceBuffer.buffer);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void DestroyInstanceBuffer(InstanceBuffer& instanceBuffer)
+{
+	if (instanceBuffer.texture)
+		glDeleteTextures(1, &instanceBuffer.texture);
+	if (instanceBuffer.visibleBuffer)
+		glDeleteBuffers(1, &instanceBuffer.visibleBuffer);
+	if (instanceBuffer.buffer)
+		glDeleteBuffers(1, &instanceBuffer.buffer);
+	instanceBuffer.texture = 0;
+	instanceBuffer.visibleBuffer = 0;
+	instanceBuffer.buffer = 0;
+	instanceBuffer.capacity = 0;
+	instanceBuffer.instances.clear();
+	instanceBuffer.owners.clear();
+	instanceBuffer.ownerSlots.clear();
+	instanceBuffer.ownerInstances.clear();
+	instanceBuffer.dirty.clear();
+	ClearInstanceBounds(instanceBuffer.bounds);
+	instanceBuffer.visible.clear();
+}
+
+void AddInstances(InstanceBuffer& instanceBuffer, long long owner, const std::vector<glm::mat4>& matrices)
+{
+	if (matrices.empty())
+		return;
+
+	std::vector<unsigned int>& slots = instanceBuffer.ownerInstances[owner];
+	for (const glm::mat4& matrix : matrices)
+	{
+		unsigned int index = static_cast<unsigned int>(instanceBuffer.instances.size());
+		instanceBuffer.instances.push_back(matrix);
+		PushInstanceBounds(instanceBuffer.bounds, matrix, instanceBuffer.modelBounds);
+		instanceBuffer.owners.push_back(owner);
+		instanceBuffer.ownerSlots.push_back(static_cast<unsigned int>(slots.size()));
+		instanceBuffer.dirty.push_back(index);
+		slots.push_back(index);
+	}
+
+	if (instanceBuffer.instances.size() > instanceBuffer.capacity)
+	{
+		while (instanceBuffer.capacity < instanceBuffer.instances.size())
+			instanceBuffer.capacity *= 2;
+		instanceBuffer.reallocate = true;
+	}
+}
+
+void RemoveInstances(InstanceBuffer& instanceBuffer, long long owner)
+{
+	auto found = instanceBuffer.ownerInstances.find(owner);
+	if (found == instanceBuffer.ownerInstances.end())
+		return;
+
+	// Highest first: every instance past the one being filled then belongs to
+	// another owner, whose list is pointed at the instance's new position
+	std::vector<unsigned int> removed = std::move(found->second);
+	instanceBuffer.ownerInstances.erase(found);
+	std::sort(removed.begin(), removed.end());
+
+	for (auto it = removed.rbegin(); it != removed.rend(); ++it)
+	{
+		unsigned int hole = *it;
+		unsigned int last = static_cast<unsigned int>(instanceBuffer.instances.size()) - 1;
+		if (hole != last)
+		{
+			instanceBuffer.instances[hole] = instanceBuffer.instances[last];
+			CopyInstanceBounds(instanceBuffer.bounds, hole, last);
+			instanceBuffer.owners[hole] = instanceBuffer.owners[last];
+			instanceBuffer.ownerSlots[hole] = instanceBuffer.ownerSlots[last];
+			instanceBuffer.ownerInstances[instanceBuffer.owners[hole]][instanceBuffer.ownerSlots[hole]] = hole;
+			instanceBuffer.dirty.push_back(hole);
+		}
+		instanceBuffer.instances.pop_back();
+		PopInstanceBounds(instanceBuffer.bounds);
+		instanceBuffer.owners.pop_back();
+		instanceBuffer.ownerSlots.pop_back();
+	}
+}
+
+void FlushInstanceBuffer(InstanceBuffer& instanceBuffer)
+{
+	const unsigned int count = static_cast<unsigned int>(instanceBuffer.instances.size());
+	if (!instanceBuffer.reallocate && instanceBuffer.dirty.empty())
+		return;
+
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer.buffer);
+
+	if (instanceBuffer.reallocate)
+	{
+		glBufferData(GL_ARRAY_BUFFER, instanceBuffer.capacity * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+		if (count > 0)
+			glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(glm::mat4), instanceBuffer.instances.data());
+		instanceBuffer.uploadedBytes += count * sizeof(glm::mat4);
+		instanceBuffer.reallocate = false;
+	}
+	else
+	{
+		// Consecutive indices go out as one write; holes of a removed owner
+		// and a newly added owner are usually a run each
+		std::vector<unsigned int>& dirty = instanceBuffer.dirty;
+		std::sort(dirty.begin(), dirty.end());
+		dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+		size_t i = 0;
+		while (i < dirty.size() && dirty[i] < count)
+		{
+			unsigned int first = dirty[i];
+			unsigned int end = first + 1;
+			while (++i < dirty.size() && dirty[i] == end && end < count)
+				++end;
+
+			glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(glm::mat4), (end - first) * sizeof(glm::mat4),
+				&instanceBuffer.instances[first]);
+			instanceBuffer.uploadedBytes += (end - first) * sizeof(glm::mat4);
+		}
+	}
+
+	instanceBuffer.dirty.clear();
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void CullInstances(InstanceBuffer& instanceBuffer, const Frustum* frustum)
+{
+	instanceBuffer.visible.clear();
+	if (frustum)
+	{
+		CullSpheres(*frustum, instanceBuffer.bounds, instanceBuffer.visible);
+	}
+	else
+	{
+		instanceBuffer.visible.resize(instanceBuffer.instances.size());
+		std::iota(instanceBuffer.visible.begin(), instanceBuffer.visible.end(), 0u);
+	}
+}
+
+GLsizei UploadVisibleInstances(InstanceBuffer& instanceBuffer)
+{
+	const std::vector<unsigned int>& visible = instanceBuffer.visible;
+	if (visible.empty())
+		return 0;
+
+	// The storage is sized with the matrices, so a list always fits
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer.visibleBuffer);
+	glBufferData(GL_ARRAY_BUFFER, instanceBuffer.capacity * sizeof(unsigned int), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, visible.size() * sizeof(unsigned int), visible.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	return static_cast<GLsizei>(visible.size());
+}
@@ -0,0 +1,68 @@
+#ifndef _INSTANCE_BUFFER_H_
+#define _INSTANCE_BUFFER_H_
+
+#include "frustum_cull.h"
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+// Growable GL_ARRAY_BUFFER of per-instance model matrices, grouped by owner
+// (a chunk). Owners are added and removed as a whole. Removal fills every
+// hole with the last instance, so the live instances always stay packed in
+// [0, instances.size()) and one instanced draw covers all of them.
+// Changes are made on the CPU copy and sent by FlushInstanceBuffer: storage
+// doubles when it runs out (one full upload), otherwise only the runs of
+// instances that changed are rewritten.
+//
+// Draws do not read the matrices as vertex attributes: shaders fetch them
+// through `texture` (a GL_TEXTURE_BUFFER view of `buffer`, four RGBA32F texels
+// per matrix) at the index given by a per-instance uint attribute streamed
+// from `visibleBuffer`. Each draw therefore only covers the instances listed
+// in `visible`, which CullInstances compacts from the world bounding spheres.
+struct InstanceBuffer
+{
+	GLuint buffer;
+	GLuint texture;
+	GLuint visibleBuffer;
+	size_t capacity;                             // instances the GL storage holds
+	std::vector<glm::mat4> instances;
+	std::vector<long long> owners;               // owner of each instance
+	std::vector<unsigned int> ownerSlots;        // position of each instance in its owner's list
+	std::unordered_map<long long, std::vector<unsigned int>> ownerInstances;
+	std::vector<unsigned int> dirty;             // instances written since the last flush
+	bool reallocate;
+	unsigned long long uploadedBytes;
+
+	glm::vec4 modelBounds;                       // model bounding sphere (centre, radius) before the instance matrix
+	CullSphereList bounds;                       // world bounding sphere of each instance
+	std::vector<unsigned int> visible;           // instances the next draws cover
+};
+
+void InitInstanceBuffer(InstanceBuffer& instanceBuffer, size_t initialCapacity, const glm::vec4& modelBounds);
+void DestroyInstanceBuffer(InstanceBuffer& instanceBuffer);
+
+// Appends an owner's instances (to any it already has).
+void AddInstances(InstanceBuffer& instanceBuffer, long long owner, const std::vector<glm::mat4>& matrices);
+
+// Drops every instance of an owner; unknown owners are ignored.
+void RemoveInstances(InstanceBuffer& instanceBuffer, long long owner);
+
+// Brings the GL buffer up to date; call once per frame before drawing.
+void FlushInstanceBuffer(InstanceBuffer& instanceBuffer);
+
+// Lists the instances whose bounding sphere intersects the frustum in
+// `visible`, or every instance when frustum is null.
+void CullInstances(InstanceBuffer& instanceBuffer, const Frustum* frustum);
+
+// Streams `visible` to visibleBuffer (orphaning it, so several passes a frame
+// can each upload their own list) and returns the instance count to draw.
+GLsizei UploadVisibleInstances(InstanceBuffer& instanceBuffer);
+
+inline GLsizei InstanceCount(const InstanceBuffer& instanceBuffer)
+{
+	return static_cast<GLsizei>(instanceBuffer.instances.size());
+}
+
+#endif
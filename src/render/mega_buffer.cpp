@@ -0,0 +1,187 @@
+#include "mega_buffer.h"
+
+#include <algorithm>
+
+namespace {
+
+// Adds a range to the free list, merging it with the ranges it touches
+void InsertFreeRange(MegaBuffer& megaBuffer, MegaBufferRange range)
+{
+	std::vector<MegaBufferRange>& ranges = megaBuffer.freeRanges;
+	auto next = std::lower_bound(ranges.begin(), ranges.end(), range,
+		[](const MegaBufferRange& a, const MegaBufferRange& b) { return a.first < b.first; });
+
+	if (next != ranges.end() && range.first + range.count == next->first)
+	{
+		range.count += next->count;
+		next = ranges.erase(next);
+	}
+	if (next != ranges.begin())
+	{
+		auto previous = next - 1;
+		if (previous->first + previous->count == range.first)
+		{
+			previous->count += range.count;
+			return;
+		}
+	}
+	ranges.insert(next, range);
+}
+
+bool TakeFreeRange(MegaBuffer& megaBuffer, GLuint count, MegaBufferRange& range)
+{
+	std::vector<MegaBufferRange>& ranges = megaBuffer.freeRanges;
+	for (size_t i = 0; i < ranges.size(); ++i)
+	{
+		if (ranges[i].count < count)
+			continue;
+
+		range.first = ranges[i].first;
+		range.count = count;
+		ranges[i].first += count;
+		ranges[i].count -= count;
+		if (ranges[i].count == 0)
+			ranges.erase(ranges.begin() + i);
+		return true;
+	}
+	return false;
+}
+
+// Reallocates the storage at `capacity` elements and copies the old contents over
+void ResizeStorage(MegaBuffer& megaBuffer, GLuint capacity)
+{
+	GLuint buffer;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, capacity * megaBuffer.elementSize, nullptr, GL_STATIC_DRAW);
+
+	if (megaBuffer.buffer != 0)
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, megaBuffer.buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, megaBuffer.capacity * megaBuffer.elementSize);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glDeleteBuffers(1, &megaBuffer.buffer);
+		megaBuffer.growths++;
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	MegaBufferRange added = { megaBuffer.capacity, capacity - megaBuffer.capacity };
+	megaBuffer.buffer = buffer;
+	megaBuffer.capacity = capacity;
+	InsertFreeRange(megaBuffer, added);
+}
+
+} // namespace
+
+void InitMegaBuffer(MegaBuffer& megaBuffer, GLsizeiptr elementSize, GLsizeiptr initialBytes, GLsizeiptr budgetBytes)
+{
+	megaBuffer.buffer = 0;
+	megaBuffer.elementSize = elementSize;
+	megaBuffer.capacity = 0;
+	megaBuffer.budgetElements = static_cast<GLuint>(budgetBytes / elementSize);
+	megaBuffer.freeRanges.clear();
+	megaBuffer.pendingRanges.clear();
+	megaBuffer.elementsInUse = 0;
+	megaBuffer.rangesInUse = 0;
+	megaBuffer.growths = 0;
+
+	GLuint initial = std::min(static_cast<GLuint>(initialBytes / elementSize), megaBuffer.budgetElements);
+	if (initial > 0)
+		ResizeStorage(megaBuffer, initial);
+}
+
+void DestroyMegaBuffer(MegaBuffer& megaBuffer)
+{
+	for (const PendingMegaBufferRange& pending : megaBuffer.pendingRanges)
+	{
+		glClientWaitSync(pending.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		glDeleteSync(pending.fence);
+	}
+
+	if (megaBuffer.buffer != 0)
+		glDeleteBuffers(1, &megaBuffer.buffer);
+
+	InitMegaBuffer(megaBuffer, megaBuffer.elementSize, 0, megaBuffer.budgetElements * megaBuffer.elementSize);
+}
+
+bool AllocateMegaBufferRange(MegaBuffer& megaBuffer, GLuint count, MegaBufferRange& range, bool* grew)
+{
+	if (grew)
+		*grew = false;
+
+	if (!TakeFreeRange(megaBuffer, count, range))
+	{
+		CollectMegaBufferRanges(megaBuffer);
+		if (!TakeFreeRange(megaBuffer, count, range))
+		{
+			// Only the free range at the end of the storage can be extended
+			GLuint tail = 0;
+			if (!megaBuffer.freeRanges.empty())
+			{
+				const MegaBufferRange& last = megaBuffer.freeRanges.back();
+				if (last.first + last.count == megaBuffer.capacity)
+					tail = last.count;
+			}
+
+			GLuint capacity = megaBuffer.capacity;
+			while (capacity - megaBuffer.capacity + tail < count && capacity < megaBuffer.budgetElements)
+				capacity = std::min(std::max(capacity * 2, count), megaBuffer.budgetElements);
+			if (capacity - megaBuffer.capacity + tail < count)
+				return false;
+
+			ResizeStorage(megaBuffer, capacity);
+			if (grew)
+				*grew = true;
+			TakeFreeRange(megaBuffer, count, range);
+		}
+	}
+
+	megaBuffer.elementsInUse += count;
+	megaBuffer.rangesInUse++;
+	return true;
+}
+
+void ReleaseMegaBufferRange(MegaBuffer& megaBuffer, const MegaBufferRange& range)
+{
+	PendingMegaBufferRange pending;
+	pending.range = range;
+	pending.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	megaBuffer.pendingRanges.push_back(pending);
+	megaBuffer.elementsInUse -= range.count;
+	megaBuffer.rangesInUse--;
+}
+
+void CollectMegaBufferRanges(MegaBuffer& megaBuffer)
+{
+	size_t kept = 0;
+	for (size_t i = 0; i < megaBuffer.pendingRanges.size(); ++i)
+	{
+		const PendingMegaBufferRange& pending = megaBuffer.pendingRanges[i];
+		GLenum status = glClientWaitSync(pending.fence, 0, 0);
+		if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+		{
+			glDeleteSync(pending.fence);
+			InsertFreeRange(megaBuffer, pending.range);
+		}
+		else
+		{
+			megaBuffer.pendingRanges[kept++] = pending;
+		}
+	}
+	megaBuffer.pendingRanges.resize(kept);
+}
+
+MegaBufferOccupancy GetMegaBufferOccupancy(const MegaBuffer& megaBuffer)
+{
+	GLuint pendingElements = 0;
+	for (const PendingMegaBufferRange& pending : megaBuffer.pendingRanges)
+		pendingElements += pending.range.count;
+
+	MegaBufferOccupancy occupancy;
+	occupancy.rangesInUse = megaBuffer.rangesInUse;
+	occupancy.usedBytes = megaBuffer.elementsInUse * megaBuffer.elementSize;
+	occupancy.pendingBytes = pendingElements * megaBuffer.elementSize;
+	occupancy.allocatedBytes = megaBuffer.capacity * megaBuffer.elementSize;
+	occupancy.budgetBytes = megaBuffer.budgetElements * megaBuffer.elementSize;
+	return occupancy;
+}
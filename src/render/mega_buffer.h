@@ -0,0 +1,71 @@
+#ifndef _MEGA_BUFFER_H_
+#define _MEGA_BUFFER_H_
+
+#include <glad/gl.h>
+#include <vector>
+
+// Run of elements in a MegaBuffer
+struct MegaBufferRange
+{
+	GLuint first;
+	GLuint count;
+};
+
+// Range freed but possibly still read by in-flight draws
+struct PendingMegaBufferRange
+{
+	MegaBufferRange range;
+	GLsync fence;
+};
+
+// One GL buffer shared by many owners and sub-allocated in elements of
+// `elementSize` bytes, first fit over an address-ordered free list whose
+// neighbours are merged. Ranges of one size stay aligned to multiples of it,
+// so a buffer that only hands out equal ranges is an array of slots.
+//
+// Storage starts at the initial size and doubles whenever an allocation does
+// not fit, up to the budget; the contents are copied over on the GPU and
+// `buffer` becomes a new name, so VAOs and texture buffers reading it have to
+// be pointed at it again after AllocateMegaBufferRange reports growth.
+// Like BufferPool slots, released ranges are only reused once the GPU has
+// passed their fence.
+struct MegaBuffer
+{
+	GLuint buffer;
+	GLsizeiptr elementSize;
+	GLuint capacity;                               // elements the GL storage holds
+	GLuint budgetElements;
+	std::vector<MegaBufferRange> freeRanges;       // sorted by first
+	std::vector<PendingMegaBufferRange> pendingRanges;
+	GLuint elementsInUse;
+	unsigned int rangesInUse;
+	unsigned int growths;
+};
+
+struct MegaBufferOccupancy
+{
+	unsigned int rangesInUse;
+	GLsizeiptr usedBytes;
+	GLsizeiptr pendingBytes;
+	GLsizeiptr allocatedBytes;
+	GLsizeiptr budgetBytes;
+};
+
+void InitMegaBuffer(MegaBuffer& megaBuffer, GLsizeiptr elementSize, GLsizeiptr initialBytes, GLsizeiptr budgetBytes);
+
+// Deletes the buffer, waiting for outstanding fences first.
+void DestroyMegaBuffer(MegaBuffer& megaBuffer);
+
+// Finds `count` free elements, growing the storage while under budget.
+// Returns false when they do not fit; `grew` is set when `buffer` changed.
+bool AllocateMegaBufferRange(MegaBuffer& megaBuffer, GLuint count, MegaBufferRange& range, bool* grew = nullptr);
+
+// Hands a range back; it becomes reusable after the commands issued so far complete.
+void ReleaseMegaBufferRange(MegaBuffer& megaBuffer, const MegaBufferRange& range);
+
+// Returns pending ranges whose fence has signalled to the free list.
+void CollectMegaBufferRanges(MegaBuffer& megaBuffer);
+
+MegaBufferOccupancy GetMegaBufferOccupancy(const MegaBuffer& megaBuffer);
+
+#endif
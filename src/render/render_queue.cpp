@@ -0,0 +1,240 @@
+#include "render_queue.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const unsigned long long DEPTH_MASK = (1ull << 24) - 1;
+
+unsigned long long QuantiseDepth(float depth, float depthRange)
+{
+	float t = depthRange > 0.0f ? depth / depthRange : 0.0f;
+	t = std::min(std::max(t, 0.0f), 1.0f);
+	return static_cast<unsigned long long>(t * DEPTH_MASK);
+}
+
+unsigned long long MakeSortKey(const RenderQueue& queue, int pass, GLuint program, unsigned int material,
+	GLuint vertexArray, float depth)
+{
+	unsigned long long state = (static_cast<unsigned long long>(program & 0xff) << 28) |
+		(static_cast<unsigned long long>(material & 0xfff) << 16) |
+		static_cast<unsigned long long>(vertexArray & 0xffff);
+	unsigned long long depthBits = QuantiseDepth(depth, queue.depthRange);
+	unsigned long long passBits = static_cast<unsigned long long>(pass & 0xf) << 60;
+
+	if (queue.passes[pass].backToFront)
+		return passBits | ((DEPTH_MASK - depthBits) << 36) | state;
+	return passBits | (state << 24) | depthBits;
+}
+
+void PushUniformWords(RenderQueue& queue, GLint location, GLenum type, const void* value)
+{
+	RenderUniform uniform;
+	uniform.location = location;
+	uniform.type = type;
+	uniform.firstWord = static_cast<unsigned int>(queue.uniformWords.size());
+
+	unsigned int count = UniformTypeWords(type);
+	queue.uniformWords.resize(queue.uniformWords.size() + count);
+	std::memcpy(&queue.uniformWords[uniform.firstWord], value, count * sizeof(unsigned int));
+
+	queue.uniforms.push_back(uniform);
+	queue.packets.back().uniformCount++;
+}
+
+void ApplyPacketState(RenderQueue& queue, const DrawPacket& packet)
+{
+	GLStateCache& state = queue.state;
+	const RenderPassState& pass = queue.passes[packet.key >> 60];
+
+	CacheSetRenderState(state, pass.depthTest, pass.depthWrite, pass.blend);
+	CacheUseProgram(state, packet.program);
+	CacheBindVertexArray(state, packet.vertexArray);
+
+	const RenderMaterial& material = queue.materials[packet.material];
+	for (unsigned int i = 0; i < material.bindingCount; ++i)
+	{
+		const RenderTextureBinding& binding = queue.textureBindings[material.firstBinding + i];
+		CacheBindTexture(state, binding.unit, binding.target, binding.texture);
+	}
+
+	for (unsigned int i = 0; i < packet.uniformCount; ++i)
+	{
+		const RenderUniform& uniform = queue.uniforms[packet.firstUniform + i];
+		CacheUniform(state, uniform.location, uniform.type, &queue.uniformWords[uniform.firstWord]);
+	}
+}
+
+// Whether `next` can join `packet` in one multi-draw: same state and uniform values
+bool CanBatchPackets(const RenderQueue& queue, const DrawPacket& packet, const DrawPacket& next)
+{
+	if (packet.indexType == 0 || packet.instanceCount > 0 || next.instanceCount > 0 ||
+		(packet.key >> 60) != (next.key >> 60) || packet.program != next.program ||
+		packet.material != next.material || packet.vertexArray != next.vertexArray ||
+		packet.mode != next.mode || packet.indexType != next.indexType ||
+		packet.uniformCount != next.uniformCount)
+		return false;
+
+	for (unsigned int i = 0; i < packet.uniformCount; ++i)
+	{
+		const RenderUniform& a = queue.uniforms[packet.firstUniform + i];
+		const RenderUniform& b = queue.uniforms[next.firstUniform + i];
+		if (a.location != b.location || a.type != b.type ||
+			std::memcmp(&queue.uniformWords[a.firstWord], &queue.uniformWords[b.firstWord],
+				UniformTypeWords(a.type) * sizeof(unsigned int)) != 0)
+			return false;
+	}
+	return true;
+}
+
+} // namespace
+
+void InitRenderQueue(RenderQueue& queue, float depthRange)
+{
+	for (int pass = 0; pass < RENDER_QUEUE_MAX_PASSES; ++pass)
+		queue.passes[pass] = RenderPassState{ true, true, false, false };
+	queue.depthRange = depthRange;
+	queue.submittedDraws = 0;
+	queue.issuedDraws = 0;
+	ClearRenderQueue(queue);
+	ResetGLStateCache(queue.state);
+	ResetGLStateCounters(queue.state);
+}
+
+void SetRenderPassState(RenderQueue& queue, int pass, const RenderPassState& state)
+{
+	queue.passes[pass] = state;
+}
+
+void ClearRenderQueue(RenderQueue& queue)
+{
+	queue.packets.clear();
+	queue.materials.clear();
+	queue.textureBindings.clear();
+	queue.uniforms.clear();
+	queue.uniformWords.clear();
+}
+
+unsigned int AddRenderMaterial(RenderQueue& queue, const RenderTextureBinding* bindings, unsigned int count)
+{
+	RenderMaterial material;
+	material.firstBinding = static_cast<unsigned int>(queue.textureBindings.size());
+	material.bindingCount = count;
+	queue.textureBindings.insert(queue.textureBindings.end(), bindings, bindings + count);
+	queue.materials.push_back(material);
+	return static_cast<unsigned int>(queue.materials.size() - 1);
+}
+
+DrawPacket& PushDrawPacket(RenderQueue& queue, int pass, GLuint program, unsigned int material,
+	GLuint vertexArray, float depth)
+{
+	DrawPacket packet;
+	packet.key = MakeSortKey(queue, pass, program, material, vertexArray, depth);
+	packet.program = program;
+	packet.material = material;
+	packet.vertexArray = vertexArray;
+	packet.mode = GL_TRIANGLES;
+	packet.count = 0;
+	packet.indexType = 0;
+	packet.first = 0;
+	packet.baseVertex = 0;
+	packet.instanceCount = 0;
+	packet.firstUniform = static_cast<unsigned int>(queue.uniforms.size());
+	packet.uniformCount = 0;
+	queue.packets.push_back(packet);
+	return queue.packets.back();
+}
+
+void PushDrawUniform(RenderQueue& queue, GLint location, float value)
+{
+	PushUniformWords(queue, location, GL_FLOAT, &value);
+}
+
+void PushDrawUniform(RenderQueue& queue, GLint location, int value)
+{
+	PushUniformWords(queue, location, GL_INT, &value);
+}
+
+void PushDrawUniform(RenderQueue& queue, GLint location, const glm::vec2& value)
+{
+	PushUniformWords(queue, location, GL_FLOAT_VEC2, &value[0]);
+}
+
+void PushDrawUniform(RenderQueue& queue, GLint location, const glm::vec3& value)
+{
+	PushUniformWords(queue, location, GL_FLOAT_VEC3, &value[0]);
+}
+
+void PushDrawUniform(RenderQueue& queue, GLint location, const glm::mat4& value)
+{
+	PushUniformWords(queue, location, GL_FLOAT_MAT4, &value[0][0]);
+}
+
+void SubmitRenderQueue(RenderQueue& queue)
+{
+	queue.order.clear();
+	for (size_t i = 0; i < queue.packets.size(); ++i)
+		queue.order.push_back(std::make_pair(queue.packets[i].key, static_cast<unsigned int>(i)));
+	std::sort(queue.order.begin(), queue.order.end());
+
+	GLStateCache& state = queue.state;
+	ResetGLStateCache(state);
+	ResetGLStateCounters(state);
+	queue.issuedDraws = 0;
+
+	size_t next = 0;
+	while (next < queue.order.size())
+	{
+		const DrawPacket& packet = queue.packets[queue.order[next++].second];
+		ApplyPacketState(queue, packet);
+
+		// Batched packets still go through the cache, so `requested` counts them in full
+		size_t batchEnd = next;
+		while (batchEnd < queue.order.size() &&
+			CanBatchPackets(queue, packet, queue.packets[queue.order[batchEnd].second]))
+		{
+			ApplyPacketState(queue, queue.packets[queue.order[batchEnd].second]);
+			batchEnd++;
+		}
+		queue.issuedDraws++;
+
+		if (batchEnd > next)
+		{
+			queue.batchCounts.clear();
+			queue.batchIndices.clear();
+			queue.batchBaseVertices.clear();
+			for (size_t i = next - 1; i < batchEnd; ++i)
+			{
+				const DrawPacket& batched = queue.packets[queue.order[i].second];
+				queue.batchCounts.push_back(batched.count);
+				queue.batchIndices.push_back(reinterpret_cast<const void*>(batched.first));
+				queue.batchBaseVertices.push_back(batched.baseVertex);
+			}
+			glMultiDrawElementsBaseVertex(packet.mode, queue.batchCounts.data(), packet.indexType,
+				queue.batchIndices.data(), static_cast<GLsizei>(queue.batchCounts.size()), queue.batchBaseVertices.data());
+			next = batchEnd;
+		}
+		else if (packet.indexType == 0)
+		{
+			if (packet.instanceCount > 0)
+				glDrawArraysInstanced(packet.mode, static_cast<GLint>(packet.first), packet.count, packet.instanceCount);
+			else
+				glDrawArrays(packet.mode, static_cast<GLint>(packet.first), packet.count);
+		}
+		else
+		{
+			const void* indices = reinterpret_cast<const void*>(packet.first);
+			if (packet.instanceCount > 0)
+				glDrawElementsInstancedBaseVertex(packet.mode, packet.count, packet.indexType, indices,
+					packet.instanceCount, packet.baseVertex);
+			else
+				glDrawElementsBaseVertex(packet.mode, packet.count, packet.indexType, indices, packet.baseVertex);
+		}
+	}
+
+	// Later direct GL code expects depth testing and writes on, blending off
+	CacheSetRenderState(state, true, true, false);
+	CacheBindVertexArray(state, 0);
+	queue.submittedDraws = static_cast<unsigned int>(queue.order.size());
+}
@@ -0,0 +1,120 @@
+#ifndef _RENDER_QUEUE_H_
+#define _RENDER_QUEUE_H_
+
+#include "gl_state_cache.h"
+
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Passes are submitted in order, each with its fixed depth/blend state.
+// Opaque passes sort by state and then front to back; back-to-front passes
+// (blended ones) sort by depth first.
+const int RENDER_QUEUE_MAX_PASSES = 16;
+
+struct RenderPassState
+{
+	bool depthTest;
+	bool depthWrite;
+	bool blend;
+	bool backToFront;
+};
+
+// Textures a draw needs, bound unit by unit. A material is a run of these.
+struct RenderTextureBinding
+{
+	GLuint unit;
+	GLenum target;
+	GLuint texture;
+};
+
+struct RenderMaterial
+{
+	unsigned int firstBinding;
+	unsigned int bindingCount;
+};
+
+// Per-draw uniform value, stored as 32-bit words in RenderQueue::uniformWords
+struct RenderUniform
+{
+	GLint location;
+	GLenum type;
+	unsigned int firstWord;
+};
+
+// One draw with everything it needs. indexType 0 draws arrays from `first`;
+// otherwise `first` is the byte offset into the bound element buffer and
+// baseVertex is added to every index. instanceCount 0 is a plain,
+// non-instanced draw.
+struct DrawPacket
+{
+	unsigned long long key;
+	GLuint program;
+	unsigned int material;
+	GLuint vertexArray;
+	GLenum mode;
+	GLsizei count;
+	GLenum indexType;
+	GLintptr first;
+	GLint baseVertex;
+	GLsizei instanceCount;
+	unsigned int firstUniform;
+	unsigned int uniformCount;
+};
+
+// Draws collected over a frame and submitted sorted by a 64-bit key,
+//
+//     opaque:        pass:4 | program:8 | material:12 | vertex array:16 | depth:24
+//     back to front: pass:4 | ~depth:24 | program:8 | material:12 | vertex array:16
+//
+// (GL names are truncated to their field; a collision only costs a bind)
+// through a GLStateCache. Emit order breaks ties, so equal keys keep the
+// order they were queued in. A run of non-instanced indexed packets that
+// share their pass, program, material, vertex array, primitive and uniform
+// values goes to GL as one glMultiDrawElementsBaseVertex.
+struct RenderQueue
+{
+	RenderPassState passes[RENDER_QUEUE_MAX_PASSES];
+	float depthRange;                          // depths are quantised over [0, depthRange]
+
+	std::vector<DrawPacket> packets;
+	std::vector<RenderMaterial> materials;
+	std::vector<RenderTextureBinding> textureBindings;
+	std::vector<RenderUniform> uniforms;
+	std::vector<unsigned int> uniformWords;
+	std::vector<std::pair<unsigned long long, unsigned int> > order;
+
+	GLStateCache state;
+	unsigned int submittedDraws;                // packets of the last submit
+	unsigned int issuedDraws;                   // GL draw calls they took
+
+	std::vector<GLsizei> batchCounts;           // glMultiDrawElementsBaseVertex arguments
+	std::vector<const void*> batchIndices;
+	std::vector<GLint> batchBaseVertices;
+};
+
+void InitRenderQueue(RenderQueue& queue, float depthRange);
+void SetRenderPassState(RenderQueue& queue, int pass, const RenderPassState& state);
+
+// Drops last frame's packets and materials; call before emitting a frame.
+void ClearRenderQueue(RenderQueue& queue);
+
+unsigned int AddRenderMaterial(RenderQueue& queue, const RenderTextureBinding* bindings, unsigned int count);
+
+// Starts a packet; the PushDrawUniform calls that follow attach to it.
+DrawPacket& PushDrawPacket(RenderQueue& queue, int pass, GLuint program, unsigned int material,
+	GLuint vertexArray, float depth);
+
+void PushDrawUniform(RenderQueue& queue, GLint location, float value);
+void PushDrawUniform(RenderQueue& queue, GLint location, int value);
+void PushDrawUniform(RenderQueue& queue, GLint location, const glm::vec2& value);
+void PushDrawUniform(RenderQueue& queue, GLint location, const glm::vec3& value);
+void PushDrawUniform(RenderQueue& queue, GLint location, const glm::mat4& value);
+
+// Sorts and issues every packet. The state cache is reset first, since GL
+// state may have been changed directly since the last submit, and its
+// counters then hold this submit's state changes. Leaves depth testing and
+// writes on, blending off and no vertex array bound.
+void SubmitRenderQueue(RenderQueue& queue);
+
+#endif
@@ -5,6 +5,7 @@
 #include <fstream>
 #include <sstream> 
 #include <vector>
+#include <algorithm>
 
 GLuint LoadShadersFromFile(const char *vertex_file_path, const char *fragment_file_path)
 {
@@ -177,3 +178,118 @@ GLuint LoadShadersFromString(std::string VertexShaderCode, std::string FragmentS
 
 	return ProgramID;
 }
+
+namespace {
+
+bool IsSamplerType(GLenum type)
+{
+	switch (type)
+	{
+	case GL_SAMPLER_1D:
+	case GL_SAMPLER_2D:
+	case GL_SAMPLER_3D:
+	case GL_SAMPLER_CUBE:
+	case GL_SAMPLER_2D_SHADOW:
+	case GL_SAMPLER_1D_ARRAY:
+	case GL_SAMPLER_2D_ARRAY:
+	case GL_SAMPLER_2D_ARRAY_SHADOW:
+	case GL_SAMPLER_BUFFER:
+	case GL_INT_SAMPLER_BUFFER:
+	case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+	case GL_INT_SAMPLER_2D:
+	case GL_UNSIGNED_INT_SAMPLER_2D:
+		return true;
+	default:
+		return false;
+	}
+}
+
+} // namespace
+
+ShaderProgram LoadProgramFromFile(const char *vertex_file_path, const char *fragment_file_path)
+{
+	ShaderProgram program;
+	program.id = LoadShadersFromFile(vertex_file_path, fragment_file_path);
+	if (program.id != 0)
+		ReflectProgram(program);
+	return program;
+}
+
+void ReflectProgram(ShaderProgram& program)
+{
+	program.uniforms.clear();
+	program.uniformBlocks.clear();
+
+	GLint uniformCount = 0;
+	GLint maxNameLength = 0;
+	glGetProgramiv(program.id, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(program.id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	std::vector<char> name(std::max(maxNameLength, 1));
+
+	for (GLuint i = 0; i < static_cast<GLuint>(uniformCount); ++i)
+	{
+		GLint blockIndex = -1;
+		glGetActiveUniformsiv(program.id, 1, &i, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+		if (blockIndex != -1)
+			continue;
+
+		ShaderUniform uniform;
+		GLsizei length = 0;
+		glGetActiveUniform(program.id, i, static_cast<GLsizei>(name.size()), &length, &uniform.size, &uniform.type, &name[0]);
+		std::string key(&name[0], length);
+		if (key.size() > 3 && key.compare(key.size() - 3, 3, "[0]") == 0)
+			key.resize(key.size() - 3);
+
+		uniform.location = glGetUniformLocation(program.id, key.c_str());
+		program.uniforms[key] = uniform;
+	}
+
+	GLint blockCount = 0;
+	GLint maxBlockNameLength = 0;
+	glGetProgramiv(program.id, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+	glGetProgramiv(program.id, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxBlockNameLength);
+	std::vector<char> blockName(std::max(maxBlockNameLength, 1));
+
+	for (GLuint i = 0; i < static_cast<GLuint>(blockCount); ++i)
+	{
+		GLsizei length = 0;
+		glGetActiveUniformBlockName(program.id, i, static_cast<GLsizei>(blockName.size()), &length, &blockName[0]);
+		program.uniformBlocks[std::string(&blockName[0], length)] = i;
+	}
+}
+
+void DestroyProgram(ShaderProgram& program)
+{
+	if (program.id)
+		glDeleteProgram(program.id);
+	program.id = 0;
+	program.uniforms.clear();
+	program.uniformBlocks.clear();
+}
+
+GLint UniformLocation(const ShaderProgram& program, const std::string& name)
+{
+	auto found = program.uniforms.find(name);
+	return found != program.uniforms.end() ? found->second.location : -1;
+}
+
+bool SetSamplerUnit(const ShaderProgram& program, const std::string& name, GLint unit)
+{
+	auto found = program.uniforms.find(name);
+	if (found == program.uniforms.end() || !IsSamplerType(found->second.type))
+		return false;
+
+	glUseProgram(program.id);
+	glUniform1i(found->second.location, unit);
+	return true;
+}
+
+bool SetUniformBlockBinding(const ShaderProgram& program, const std::string& name, GLuint binding)
+{
+	auto found = program.uniformBlocks.find(name);
+	if (found == program.uniformBlocks.end())
+		return false;
+
+	glUniformBlockBinding(program.id, found->second, binding);
+	return true;
+}
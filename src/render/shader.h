@@ -3,9 +3,44 @@
 
 #include <glad/gl.h>
 #include <string>
+#include <unordered_map>
 
 GLuint LoadShadersFromFile(const char *vertex_file_path, const char *fragment_file_path);
 
 GLuint LoadShadersFromString(std::string VertexShaderCode, std::string FragmentShaderCode);
 
+// Active uniform of a program's default block. Arrays are keyed by their
+// name without "[0]"; `size` is the element count.
+struct ShaderUniform
+{
+	GLint location;
+	GLenum type;
+	GLint size;
+};
+
+// Linked program with its interface reflected once at link time, so draws
+// look locations up here instead of calling glGetUniformLocation. Members of
+// uniform blocks are not in `uniforms`; the blocks are listed by name.
+struct ShaderProgram
+{
+	GLuint id;
+	std::unordered_map<std::string, ShaderUniform> uniforms;
+	std::unordered_map<std::string, GLuint> uniformBlocks;
+};
+
+// id stays 0 when loading fails, as with LoadShadersFromFile.
+ShaderProgram LoadProgramFromFile(const char *vertex_file_path, const char *fragment_file_path);
+void ReflectProgram(ShaderProgram& program);
+void DestroyProgram(ShaderProgram& program);
+
+// -1 when the program has no such active uniform (glUniform* ignores -1).
+GLint UniformLocation(const ShaderProgram& program, const std::string& name);
+
+// Point a sampler at a texture unit and a block at a binding point. Both are
+// program state, so they are set once after loading; each returns false when
+// the program does not use the sampler / block. SetSamplerUnit leaves the
+// program bound.
+bool SetSamplerUnit(const ShaderProgram& program, const std::string& name, GLint unit);
+bool SetUniformBlockBinding(const ShaderProgram& program, const std::string& name, GLuint binding);
+
 #endif
@@ -0,0 +1,62 @@
+#include "terrain_normals.h"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TERRAIN_NORMALS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// n = (h(x-1) - h(x+1), 2 * gridScale, h(z-1) - h(z+1)), normalised
+inline glm::vec3 CentralDifferenceNormal(const float* h, unsigned int rowStride, float twoScale)
+{
+	glm::vec3 n(h[-1] - h[1], twoScale, h[-(int)rowStride] - h[rowStride]);
+	return n / std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+}
+
+}
+
+void ComputeTerrainNormals(const float* heights, unsigned int rowStride,
+	unsigned int gridSize, float gridScale, glm::vec3* normals)
+{
+	const unsigned int rowLength = gridSize + 1;
+	const float twoScale = 2.0f * gridScale;
+
+#ifdef TERRAIN_NORMALS_SSE2
+	const __m128 ny = _mm_set1_ps(twoScale);
+	const __m128 nySq = _mm_mul_ps(ny, ny);
+#endif
+
+	for (unsigned int z = 0; z < rowLength; ++z)
+	{
+		const float* row = heights + z * rowStride;
+		const float* above = row - rowStride;
+		const float* below = row + rowStride;
+		glm::vec3* out = normals + z * rowLength;
+
+		unsigned int x = 0;
+#ifdef TERRAIN_NORMALS_SSE2
+		for (; x + 4 <= rowLength; x += 4)
+		{
+			__m128 nx = _mm_sub_ps(_mm_loadu_ps(row + x - 1), _mm_loadu_ps(row + x + 1));
+			__m128 nz = _mm_sub_ps(_mm_loadu_ps(above + x), _mm_loadu_ps(below + x));
+
+			__m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), nySq), _mm_mul_ps(nz, nz));
+			__m128 length = _mm_sqrt_ps(lengthSq);
+
+			// Divide each component, as the scalar tail does, so every column rounds identically
+			float lanesX[4], lanesY[4], lanesZ[4];
+			_mm_storeu_ps(lanesX, _mm_div_ps(nx, length));
+			_mm_storeu_ps(lanesY, _mm_div_ps(ny, length));
+			_mm_storeu_ps(lanesZ, _mm_div_ps(nz, length));
+
+			for (int i = 0; i < 4; ++i)
+				out[x + i] = glm::vec3(lanesX[i], lanesY[i], lanesZ[i]);
+		}
+#endif
+		for (; x < rowLength; ++x)
+			out[x] = CentralDifferenceNormal(row + x, rowStride, twoScale);
+	}
+}
@@ -0,0 +1,14 @@
+#ifndef _TERRAIN_NORMALS_H_
+#define _TERRAIN_NORMALS_H_
+
+#include <glm/glm.hpp>
+
+// Central-difference normals for a (gridSize+1)^2 block of grid vertices.
+// `heights` points at the first interior sample of a block that carries one
+// sample of apron on every side, `rowStride` is the padded row length, so
+// (x-1, x+1, z-1, z+1) are always readable and chunk edges match neighbours.
+// Writes (gridSize+1)^2 unit normals, row-major, to `normals`.
+void ComputeTerrainNormals(const float* heights, unsigned int rowStride,
+	unsigned int gridSize, float gridScale, glm::vec3* normals);
+
+#endif
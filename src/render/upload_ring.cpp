@@ -0,0 +1,114 @@
+#include "upload_ring.h"
+
+namespace {
+
+void RetireSignalledFences(StreamingUploadRing& ring)
+{
+	while (!ring.fences.empty())
+	{
+		const UploadRingFence& oldest = ring.fences.front();
+		GLenum status = glClientWaitSync(oldest.fence, 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			break;
+
+		ring.retiredPosition = oldest.end;
+		glDeleteSync(oldest.fence);
+		ring.fences.pop_front();
+	}
+}
+
+}
+
+void InitUploadRing(StreamingUploadRing& ring, GLsizeiptr size)
+{
+	glGenBuffers(1, &ring.buffer);
+	glBindBuffer(GL_COPY_READ_BUFFER, ring.buffer);
+	glBufferData(GL_COPY_READ_BUFFER, size, nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+	ring.size = size;
+	ring.writePosition = 0;
+	ring.retiredPosition = 0;
+	ring.fences.clear();
+	ring.mappedFrom = 0;
+	ring.mappedOffset = 0;
+	ring.mappedBytes = 0;
+}
+
+void DestroyUploadRing(StreamingUploadRing& ring)
+{
+	for (const UploadRingFence& pending : ring.fences)
+		glDeleteSync(pending.fence);
+	ring.fences.clear();
+
+	glDeleteBuffers(1, &ring.buffer);
+	ring.buffer = 0;
+}
+
+void* BeginStreamUpload(StreamingUploadRing& ring, GLsizeiptr bytes)
+{
+	if (bytes > ring.size)
+		return nullptr;
+
+	RetireSignalledFences(ring);
+
+	// Regions never wrap; skip the tail of the buffer when it is too short
+	unsigned long long start = ring.writePosition;
+	GLsizeiptr offset = static_cast<GLsizeiptr>(start % ring.size);
+	if (offset + bytes > ring.size)
+	{
+		start += ring.size - offset;
+		offset = 0;
+	}
+
+	if (start + bytes - ring.retiredPosition > static_cast<unsigned long long>(ring.size))
+		return nullptr;
+
+	glBindBuffer(GL_COPY_READ_BUFFER, ring.buffer);
+	void* mapped = glMapBufferRange(GL_COPY_READ_BUFFER, offset, bytes,
+		GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+	if (!mapped)
+		return nullptr;
+
+	ring.mappedFrom = ring.writePosition;
+	ring.writePosition = start + bytes;
+	ring.mappedOffset = offset;
+	ring.mappedBytes = bytes;
+	return mapped;
+}
+
+void EndStreamUpload(StreamingUploadRing& ring, GLuint destination, GLintptr destinationOffset)
+{
+	glBindBuffer(GL_COPY_READ_BUFFER, ring.buffer);
+	glUnmapBuffer(GL_COPY_READ_BUFFER);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, destination);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, ring.mappedOffset, destinationOffset, ring.mappedBytes);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	ring.mappedBytes = 0;
+}
+
+void CancelStreamUpload(StreamingUploadRing& ring)
+{
+	glBindBuffer(GL_COPY_READ_BUFFER, ring.buffer);
+	glUnmapBuffer(GL_COPY_READ_BUFFER);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+	ring.writePosition = ring.mappedFrom;
+	ring.mappedBytes = 0;
+}
+
+void FenceUploadRing(StreamingUploadRing& ring)
+{
+	if (!ring.fences.empty() && ring.fences.back().end == ring.writePosition)
+		return;
+	if (ring.writePosition == ring.retiredPosition)
+		return;
+
+	UploadRingFence pending;
+	pending.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	pending.end = ring.writePosition;
+	ring.fences.push_back(pending);
+}
@@ -0,0 +1,48 @@
+#ifndef _UPLOAD_RING_H_
+#define _UPLOAD_RING_H_
+
+#include <glad/gl.h>
+#include <deque>
+
+// Everything written before `end` (an absolute byte count) is free once `fence` signals
+struct UploadRingFence
+{
+	GLsync fence;
+	unsigned long long end;
+};
+
+// Staging buffer for streaming uploads. Regions are written through
+// unsynchronised glMapBufferRange and copied to their destination with
+// glCopyBufferSubData; the ring only reuses a region after the fence placed
+// behind it has signalled, so the CPU never stalls on the GPU.
+struct StreamingUploadRing
+{
+	GLuint buffer;
+	GLsizeiptr size;
+	unsigned long long writePosition;     // total bytes handed out, wraps modulo size
+	unsigned long long retiredPosition;   // everything before this is safe to overwrite
+	std::deque<UploadRingFence> fences;
+
+	// Region of the in-progress upload, and the write position to restore if it is cancelled
+	unsigned long long mappedFrom;
+	GLintptr mappedOffset;
+	GLsizeiptr mappedBytes;
+};
+
+void InitUploadRing(StreamingUploadRing& ring, GLsizeiptr size);
+void DestroyUploadRing(StreamingUploadRing& ring);
+
+// Maps `bytes` of free ring space for writing. Returns nullptr, without
+// waiting, when the GPU still owns too much of the ring.
+void* BeginStreamUpload(StreamingUploadRing& ring, GLsizeiptr bytes);
+
+// Unmaps the region and queues its copy into `destination` at `destinationOffset`.
+void EndStreamUpload(StreamingUploadRing& ring, GLuint destination, GLintptr destinationOffset);
+
+// Unmaps the region without copying and gives its space back.
+void CancelStreamUpload(StreamingUploadRing& ring);
+
+// Places a fence behind everything uploaded so far; call once per frame after uploading.
+void FenceUploadRing(StreamingUploadRing& ring);
+
+#endif
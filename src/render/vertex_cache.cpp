@@ -0,0 +1,238 @@
+#include "vertex_cache.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+const int CACHE_SIZE = 32;
+const float CACHE_DECAY_POWER = 1.5f;
+const float LAST_TRIANGLE_SCORE = 0.75f;
+const float VALENCE_BOOST_SCALE = 2.0f;
+const float VALENCE_BOOST_POWER = 0.5f;
+
+// Score terms are tabulated; valences past the table are rare and computed
+const int VALENCE_TABLE_SIZE = 32;
+
+// A vertex's live triangles are triangles[firstTriangle, firstTriangle + remainingTriangles)
+struct CacheVertex
+{
+	int cachePosition;
+	int remainingTriangles;
+	unsigned int firstTriangle;
+	float score;
+};
+
+struct ScoreTables
+{
+	float cachePosition[CACHE_SIZE];
+	float valence[VALENCE_TABLE_SIZE];
+
+	ScoreTables()
+	{
+		for (int i = 0; i < CACHE_SIZE; ++i)
+		{
+			if (i < 3)
+			{
+				// The three vertices of the last triangle get a fixed score so the
+				// next triangle does not simply reuse the same edge forever
+				cachePosition[i] = LAST_TRIANGLE_SCORE;
+			}
+			else
+			{
+				const float scaler = 1.0f / (CACHE_SIZE - 3);
+				cachePosition[i] = std::pow(1.0f - (i - 3) * scaler, CACHE_DECAY_POWER);
+			}
+		}
+		valence[0] = 0.0f;
+		for (int i = 1; i < VALENCE_TABLE_SIZE; ++i)
+			valence[i] = ValenceScore(i);
+	}
+
+	// Favour vertices with few triangles left so they get finished off
+	static float ValenceScore(int remainingTriangles)
+	{
+		return VALENCE_BOOST_SCALE * std::pow((float)remainingTriangles, -VALENCE_BOOST_POWER);
+	}
+};
+
+const ScoreTables SCORE_TABLES;
+
+float VertexScore(const CacheVertex &vertex)
+{
+	if (vertex.remainingTriangles == 0)
+		return -1.0f;
+
+	float score = vertex.cachePosition >= 0 ? SCORE_TABLES.cachePosition[vertex.cachePosition] : 0.0f;
+	score += vertex.remainingTriangles < VALENCE_TABLE_SIZE ? SCORE_TABLES.valence[vertex.remainingTriangles]
+		: ScoreTables::ValenceScore(vertex.remainingTriangles);
+	return score;
+}
+
+}
+
+void OptimizeVertexCache(std::vector<unsigned int> &indices, unsigned int vertexCount)
+{
+	const unsigned int triangleCount = (unsigned int)indices.size() / 3;
+	if (triangleCount == 0)
+		return;
+
+	// Vertex -> triangle adjacency in one array, each vertex's run in triangle order
+	std::vector<CacheVertex> vertices(vertexCount);
+	for (unsigned int v = 0; v < vertexCount; ++v)
+	{
+		vertices[v].cachePosition = -1;
+		vertices[v].remainingTriangles = 0;
+	}
+	for (unsigned int i = 0; i < triangleCount * 3; ++i)
+		vertices[indices[i]].remainingTriangles++;
+
+	unsigned int adjacencyOffset = 0;
+	for (unsigned int v = 0; v < vertexCount; ++v)
+	{
+		vertices[v].firstTriangle = adjacencyOffset;
+		adjacencyOffset += vertices[v].remainingTriangles;
+		vertices[v].remainingTriangles = 0;
+	}
+
+	std::vector<unsigned int> triangles(triangleCount * 3);
+	for (unsigned int t = 0; t < triangleCount; ++t)
+	{
+		for (int k = 0; k < 3; ++k)
+		{
+			CacheVertex &vertex = vertices[indices[t * 3 + k]];
+			triangles[vertex.firstTriangle + vertex.remainingTriangles++] = t;
+		}
+	}
+	for (unsigned int v = 0; v < vertexCount; ++v)
+		vertices[v].score = VertexScore(vertices[v]);
+
+	std::vector<float> triangleScore(triangleCount);
+	std::vector<bool> triangleAdded(triangleCount, false);
+	for (unsigned int t = 0; t < triangleCount; ++t)
+	{
+		triangleScore[t] = vertices[indices[t * 3]].score +
+		                   vertices[indices[t * 3 + 1]].score +
+		                   vertices[indices[t * 3 + 2]].score;
+	}
+
+	std::vector<unsigned int> output;
+	output.reserve(indices.size());
+
+	// LRU cache, with room for the three vertices pushed in front of it
+	std::vector<unsigned int> cache;
+	cache.reserve(CACHE_SIZE + 3);
+
+	unsigned int scanStart = 0;
+	int bestTriangle = -1;
+
+	for (unsigned int emitted = 0; emitted < triangleCount; ++emitted)
+	{
+		if (bestTriangle < 0)
+		{
+			// Nothing useful in the cache: fall back to the best remaining triangle
+			float bestScore = -1.0f;
+			while (scanStart < triangleCount && triangleAdded[scanStart])
+				scanStart++;
+			for (unsigned int t = scanStart; t < triangleCount; ++t)
+			{
+				if (!triangleAdded[t] && triangleScore[t] > bestScore)
+				{
+					bestScore = triangleScore[t];
+					bestTriangle = (int)t;
+				}
+			}
+		}
+
+		const unsigned int *corners = &indices[bestTriangle * 3];
+		triangleAdded[bestTriangle] = true;
+
+		for (int k = 0; k < 3; ++k)
+		{
+			unsigned int v = corners[k];
+			output.push_back(v);
+
+			CacheVertex &vertex = vertices[v];
+			unsigned int* live = &triangles[vertex.firstTriangle];
+			unsigned int* liveEnd = live + vertex.remainingTriangles;
+			unsigned int* removed = std::find(live, liveEnd, (unsigned int)bestTriangle);
+			std::copy(removed + 1, liveEnd, removed);
+			vertex.remainingTriangles--;
+
+			std::vector<unsigned int>::iterator cached = std::find(cache.begin(), cache.end(), v);
+			if (cached != cache.end())
+				cache.erase(cached);
+		}
+		cache.insert(cache.begin(), corners, corners + 3);
+
+		// Vertices pushed out of the cache lose their position score
+		for (size_t i = CACHE_SIZE; i < cache.size(); ++i)
+		{
+			CacheVertex &evicted = vertices[cache[i]];
+			evicted.cachePosition = -1;
+			evicted.score = VertexScore(evicted);
+			for (int t = 0; t < evicted.remainingTriangles; ++t)
+			{
+				unsigned int tri = triangles[evicted.firstTriangle + t];
+				triangleScore[tri] = vertices[indices[tri * 3]].score +
+				                     vertices[indices[tri * 3 + 1]].score +
+				                     vertices[indices[tri * 3 + 2]].score;
+			}
+		}
+		if (cache.size() > (size_t)CACHE_SIZE)
+			cache.resize(CACHE_SIZE);
+
+		for (size_t i = 0; i < cache.size(); ++i)
+		{
+			CacheVertex &vertex = vertices[cache[i]];
+			vertex.cachePosition = (int)i;
+			vertex.score = VertexScore(vertex);
+		}
+
+		// Rescore the triangles touching the cache and pick the next one among them
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (size_t i = 0; i < cache.size(); ++i)
+		{
+			const CacheVertex &vertex = vertices[cache[i]];
+			for (int t = 0; t < vertex.remainingTriangles; ++t)
+			{
+				unsigned int tri = triangles[vertex.firstTriangle + t];
+				float score = vertices[indices[tri * 3]].score +
+				              vertices[indices[tri * 3 + 1]].score +
+				              vertices[indices[tri * 3 + 2]].score;
+				triangleScore[tri] = score;
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestTriangle = (int)tri;
+				}
+			}
+		}
+	}
+
+	indices.swap(output);
+}
+
+float ComputeACMR(const std::vector<unsigned int> &indices, unsigned int vertexCount, unsigned int cacheSize)
+{
+	if (indices.size() < 3)
+		return 0.0f;
+
+	// FIFO model: a hit does not refresh the entry, as on most GPUs
+	std::vector<unsigned int> timestamp(vertexCount, 0);
+	unsigned int clock = cacheSize + 1;
+	unsigned int misses = 0;
+
+	for (size_t i = 0; i < indices.size(); ++i)
+	{
+		unsigned int v = indices[i];
+		if (clock - timestamp[v] > cacheSize)
+		{
+			timestamp[v] = clock++;
+			misses++;
+		}
+	}
+
+	return (float)misses / (float)(indices.size() / 3);
+}
@@ -0,0 +1,13 @@
+#ifndef _VERTEX_CACHE_H_
+#define _VERTEX_CACHE_H_
+
+#include <vector>
+
+// Reorders a triangle list for post-transform vertex cache hits using
+// Tom Forsyth's linear-speed greedy algorithm (cache model of 32 entries).
+void OptimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount);
+
+// Average cache miss ratio (transformed vertices per triangle) of a FIFO cache.
+float ComputeACMR(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize);
+
+#endif
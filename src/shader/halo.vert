@@ -5,7 +5,16 @@ layout (location = 1) in vec2 inUV;
 
 out vec2 vUV;
 
-uniform mat4 vpMatrix;
+// Frame constants shared by every program (render/frame_uniforms.h)
+layout(std140) uniform FrameUniforms {
+    mat4 vpMatrix;
+    mat4 lightSpaceMatrices[4];
+    vec4 cascadeDepthBias;
+    vec3 lightDir;
+    vec3 lightColor;
+    vec3 viewPos;
+};
+
 uniform mat4 model;
 
 void main()
@@ -1,12 +1,22 @@
 #version 330 core
 
 layout(location = 0) in vec3 inPosition;
-layout(location = 3) in mat4 instanceMatrix;
+// Index of this instance's matrix in instanceMatrices (four texels per matrix)
+layout(location = 3) in uint instanceIndex;
+uniform samplerBuffer instanceMatrices;
 
 uniform mat4 lightSpaceMatrix; 
 uniform mat4 model;
 
+mat4 fetchInstanceMatrix() {
+    int base = int(instanceIndex) * 4;
+    return mat4(texelFetch(instanceMatrices, base),
+                texelFetch(instanceMatrices, base + 1),
+                texelFetch(instanceMatrices, base + 2),
+                texelFetch(instanceMatrices, base + 3));
+}
+
 void main()
 {
-    gl_Position = lightSpaceMatrix * model * instanceMatrix * vec4(inPosition, 1.0);
+    gl_Position = lightSpaceMatrix * fetchInstanceMatrix() * model * vec4(inPosition, 1.0);
 }
\ No newline at end of file
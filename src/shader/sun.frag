@@ -3,9 +3,8 @@
 in vec3 fragNormal;
 out vec4 FragColor;
 
-uniform vec3 lightColor;
+uniform vec3 sunColor;
 uniform float intensity;
-uniform vec3 lightDir; 
 
 void main()
 {
@@ -14,6 +13,6 @@ void main()
     float alpha = clamp(rim, 0.0, 1.0);
     alpha = pow(alpha, 1.5); 
     float brightness = 10.0;
-    vec3 color = lightColor * intensity * brightness;
+    vec3 color = sunColor * intensity * brightness;
     FragColor = vec4(color, alpha);
 }
@@ -2,8 +2,17 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 
+// Frame constants shared by every program (render/frame_uniforms.h)
+layout(std140) uniform FrameUniforms {
+    mat4 vpMatrix;
+    mat4 lightSpaceMatrices[4];
+    vec4 cascadeDepthBias;
+    vec3 lightDir;
+    vec3 lightColor;
+    vec3 viewPos;
+};
+
 uniform mat4 model;
-uniform mat4 vpMatrix;
 
 out vec3 fragNormal;
 
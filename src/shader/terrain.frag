@@ -2,37 +2,47 @@
 
 in vec2 fragTexCoords;
 in vec3 fragNormal;
-in vec4 fragPosLightSpace;
+in vec3 fragWorldPos;
 
 out vec4 fragColor;
 
 uniform sampler2D terrainTexture; 
-uniform sampler2D shadowMap;
+const int NUM_SHADOW_CASCADES = 4;
+uniform sampler2DArray shadowMap;
 
-uniform mat4 lightSpaceMatrix;
-uniform vec3 lightDir;
-uniform vec3 lightColor;
-uniform vec3 viewPos;
+// Frame constants shared by every program (render/frame_uniforms.h)
+layout(std140) uniform FrameUniforms {
+    mat4 vpMatrix;
+    mat4 lightSpaceMatrices[4];
+    vec4 cascadeDepthBias;
+    vec3 lightDir;
+    vec3 lightColor;
+    vec3 viewPos;
+};
 
-float ShadowCalculation(vec4 fragPosLightSpace)
+// Cascades are tried nearest first; the first whose map covers the fragment decides
+float ShadowCalculation(vec3 worldPos)
 {
-    vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
-    projCoords = projCoords * 0.5 + 0.5;
-
-    if (projCoords.x < 0.0 || projCoords.x > 1.0 ||
-        projCoords.y < 0.0 || projCoords.y > 1.0 ||
-        projCoords.z < 0.0 || projCoords.z > 1.0)
-    {
-        return 0.0;
-    }
+    for (int cascade = 0; cascade < NUM_SHADOW_CASCADES; ++cascade) {
+        vec4 fragPosLightSpace = lightSpaceMatrices[cascade] * vec4(worldPos, 1.0);
+        vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
+        projCoords = projCoords * 0.5 + 0.5;
 
-    float currentDepth = projCoords.z;
-    float closestDepth = texture(shadowMap, projCoords.xy).r;
+        if (projCoords.x < 0.0 || projCoords.x > 1.0 ||
+            projCoords.y < 0.0 || projCoords.y > 1.0 ||
+            projCoords.z < 0.0 || projCoords.z > 1.0)
+        {
+            continue;
+        }
 
-    float bias = 0.005;  
+        float currentDepth = projCoords.z;
+        float closestDepth = texture(shadowMap, vec3(projCoords.xy, float(cascade))).r;
 
-    float shadow = (currentDepth - bias > closestDepth) ? 1.0 : 0.0;
-    return shadow;
+        float bias = cascadeDepthBias[cascade];
+        float shadow = (currentDepth - bias > closestDepth) ? 1.0 : 0.0;
+        return shadow;
+    }
+    return 0.0;
 }
 
 void main()
@@ -43,7 +53,7 @@ void main()
     vec3 L = normalize(-lightDir);     
     float diff = max(dot(normal, L), 0.0);
     
-    float shadow = ShadowCalculation(fragPosLightSpace);
+    float shadow = ShadowCalculation(fragWorldPos);
 
     float ambientStrength = 0.2;
     vec3 ambient = ambientStrength * albedo;
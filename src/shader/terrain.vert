@@ -1,26 +1,53 @@
 #version 330 core
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
-layout(location = 2) in vec2 inTexCoords;
-
-uniform mat4 vpMatrix;         
-uniform mat4 modelMatrix;      
-uniform mat4 lightSpaceMatrix; 
+// Compact terrain stream: X/Z and UV come from the grid index, only the
+// quantised height and a hemi-octahedral normal are stored per vertex.
+// Chunks are base-vertex draws into slots of slotVertices vertices in one
+// vertex buffer; gl_VertexID includes the base vertex, so it gives the slot
+// (and with it the chunk origin) as well as the grid index.
+layout(location = 0) in uint inHeight;
+layout(location = 1) in ivec2 inNormalOct;
+
+// Frame constants shared by every program (render/frame_uniforms.h)
+layout(std140) uniform FrameUniforms {
+    mat4 vpMatrix;
+    mat4 lightSpaceMatrices[4];
+    vec4 cascadeDepthBias;
+    vec3 lightDir;
+    vec3 lightColor;
+    vec3 viewPos;
+};
+
+uniform samplerBuffer chunkOrigins;    // chunk origin (x, z) per slot
+
+uniform int slotVertices;
+uniform int lodVertexOffset;
+uniform int gridSize;
+uniform float gridScale;
+uniform vec2 heightRange;
 
 out vec2 fragTexCoords;
 out vec3 fragNormal;
-out vec4 fragPosLightSpace;
+out vec3 fragWorldPos;
 
 void main()
 {
-    vec4 worldPos = modelMatrix * vec4(inPosition, 1.0);
+    int slot = gl_VertexID / slotVertices;
+    int vertex = gl_VertexID - slot * slotVertices - lodVertexOffset;
+    int row = vertex / (gridSize + 1);
+    int col = vertex - row * (gridSize + 1);
+
+    vec2 origin = texelFetch(chunkOrigins, slot).xy;
+    float height = heightRange.x + float(inHeight) / 65535.0 * heightRange.y;
+    vec4 worldPos = vec4(origin.x + float(col) * gridScale, height, origin.y + float(row) * gridScale, 1.0);
 
-    fragNormal = mat3(transpose(inverse(modelMatrix))) * inNormal;
+    // Chunks are only translated, so the normal needs no transform
+    vec2 oct = vec2(inNormalOct) / 127.0;
+    fragNormal = normalize(vec3(oct.x, 1.0 - abs(oct.x) - abs(oct.y), oct.y));
 
-    fragPosLightSpace = lightSpaceMatrix * worldPos;
+    fragWorldPos = worldPos.xyz;
 
-    fragTexCoords = inTexCoords;
+    fragTexCoords = vec2(float(col), float(row)) / float(gridSize);
 
     gl_Position = vpMatrix * worldPos;
-}
\ No newline at end of file
+}
@@ -0,0 +1,65 @@
+#version 330 core
+
+// CDLOD node stream: every vertex stores its own height and normal plus those
+// of the even grid vertex it merges with at the parent level. X/Z and UV come
+// from the grid index and the node's placement uniforms.
+layout(location = 0) in uvec2 inHeights;
+layout(location = 1) in ivec4 inNormalOcts;
+
+// Frame constants shared by every program (render/frame_uniforms.h)
+layout(std140) uniform FrameUniforms {
+    mat4 vpMatrix;
+    mat4 lightSpaceMatrices[4];
+    vec4 cascadeDepthBias;
+    vec3 lightDir;
+    vec3 lightColor;
+    vec3 viewPos;
+};
+
+
+uniform int gridSize;
+uniform vec2 nodeOrigin;
+uniform float nodeSpacing;
+uniform vec2 morphRange;       // camera distances where morphing starts and completes
+uniform vec2 heightRange;
+uniform float texCoordScale;
+
+out vec2 fragTexCoords;
+out vec3 fragNormal;
+out vec3 fragWorldPos;
+
+vec3 decodeNormal(vec2 octNormal)
+{
+    vec2 oct = octNormal / 127.0;
+    return normalize(vec3(oct.x, 1.0 - abs(oct.x) - abs(oct.y), oct.y));
+}
+
+void main()
+{
+    int row = gl_VertexID / (gridSize + 1);
+    int col = gl_VertexID - row * (gridSize + 1);
+    vec2 gridPos = vec2(float(col), float(row));
+
+    vec2 heights = heightRange.x + vec2(inHeights) / 65535.0 * heightRange.y;
+    vec2 worldXZ = nodeOrigin + gridPos * nodeSpacing;
+
+    // The morph factor only depends on the unmorphed position, so vertices
+    // shared by neighbouring nodes move identically; at the end of a level's
+    // range odd vertices sit on their even neighbour and the node matches its
+    // parent's mesh exactly.
+    float distanceToCamera = distance(viewPos, vec3(worldXZ.x, heights.x, worldXZ.y));
+    float morphK = clamp((distanceToCamera - morphRange.x) / (morphRange.y - morphRange.x), 0.0, 1.0);
+
+    vec2 morphedGridPos = gridPos - mod(gridPos, 2.0) * morphK;
+    worldXZ = nodeOrigin + morphedGridPos * nodeSpacing;
+
+    vec4 worldPos = vec4(worldXZ.x, mix(heights.x, heights.y, morphK), worldXZ.y, 1.0);
+
+    fragNormal = normalize(mix(decodeNormal(vec2(inNormalOcts.xy)), decodeNormal(vec2(inNormalOcts.zw)), morphK));
+
+    fragWorldPos = worldPos.xyz;
+
+    fragTexCoords = worldXZ * texCoordScale;
+
+    gl_Position = vpMatrix * worldPos;
+}
@@ -0,0 +1,32 @@
+#version 330 core
+
+// Depth-only version of terrain_cdlod.vert: same placement and morph, so the
+// shadow caster matches the geometry that is shaded
+layout(location = 0) in uvec2 inHeights;
+
+uniform mat4 lightSpaceMatrix;
+
+uniform int gridSize;
+uniform vec2 nodeOrigin;
+uniform float nodeSpacing;
+uniform vec2 morphRange;
+uniform vec3 cameraPos;
+uniform vec2 heightRange;
+
+void main()
+{
+    int row = gl_VertexID / (gridSize + 1);
+    int col = gl_VertexID - row * (gridSize + 1);
+    vec2 gridPos = vec2(float(col), float(row));
+
+    vec2 heights = heightRange.x + vec2(inHeights) / 65535.0 * heightRange.y;
+    vec2 worldXZ = nodeOrigin + gridPos * nodeSpacing;
+
+    float distanceToCamera = distance(cameraPos, vec3(worldXZ.x, heights.x, worldXZ.y));
+    float morphK = clamp((distanceToCamera - morphRange.x) / (morphRange.y - morphRange.x), 0.0, 1.0);
+
+    vec2 morphedGridPos = gridPos - mod(gridPos, 2.0) * morphK;
+    worldXZ = nodeOrigin + morphedGridPos * nodeSpacing;
+
+    gl_Position = lightSpaceMatrix * vec4(worldXZ.x, mix(heights.x, heights.y, morphK), worldXZ.y, 1.0);
+}
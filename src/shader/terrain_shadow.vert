@@ -0,0 +1,25 @@
+#version 330 core
+
+// Depth-only version of terrain.vert: rebuilds the position from the slot and grid index
+layout(location = 0) in uint inHeight;
+
+uniform mat4 lightSpaceMatrix; 
+uniform samplerBuffer chunkOrigins;
+
+uniform int slotVertices;
+uniform int lodVertexOffset;
+uniform int gridSize;
+uniform float gridScale;
+uniform vec2 heightRange;
+
+void main()
+{
+    int slot = gl_VertexID / slotVertices;
+    int vertex = gl_VertexID - slot * slotVertices - lodVertexOffset;
+    int row = vertex / (gridSize + 1);
+    int col = vertex - row * (gridSize + 1);
+
+    vec2 origin = texelFetch(chunkOrigins, slot).xy;
+    float height = heightRange.x + float(inHeight) / 65535.0 * heightRange.y;
+    gl_Position = lightSpaceMatrix * vec4(origin.x + float(col) * gridScale, height, origin.y + float(row) * gridScale, 1.0);
+}
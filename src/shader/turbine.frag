@@ -3,34 +3,44 @@
 in vec3 fragPosition;
 in vec3 fragNormal;
 
-uniform vec3 lightColor;
-uniform vec3 lightDir;
-uniform vec3 viewPos;
+// Frame constants shared by every program (render/frame_uniforms.h)
+layout(std140) uniform FrameUniforms {
+    mat4 vpMatrix;
+    mat4 lightSpaceMatrices[4];
+    vec4 cascadeDepthBias;
+    vec3 lightDir;
+    vec3 lightColor;
+    vec3 viewPos;
+};
 
-uniform sampler2D shadowMap;
-uniform mat4 lightSpaceMatrix;
+const int NUM_SHADOW_CASCADES = 4;
+uniform sampler2DArray shadowMap;
 
 out vec4 fragColor;
 
-float ShadowCalculation(vec4 fragPosLightSpace)
+// Cascades are tried nearest first; the first whose map covers the fragment decides
+float ShadowCalculation(vec3 worldPos)
 {
-    vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
-    projCoords = projCoords * 0.5 + 0.5;
-
-    if(projCoords.x < 0.0 || projCoords.x > 1.0 ||
-       projCoords.y < 0.0 || projCoords.y > 1.0 ||
-       projCoords.z < 0.0 || projCoords.z > 1.0)
-    {
-       return 0.0;
-    }
+    for (int cascade = 0; cascade < NUM_SHADOW_CASCADES; ++cascade) {
+        vec4 fragPosLightSpace = lightSpaceMatrices[cascade] * vec4(worldPos, 1.0);
+        vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
+        projCoords = projCoords * 0.5 + 0.5;
 
-    float currentDepth = projCoords.z;
-    float closestDepth = texture(shadowMap, projCoords.xy).r;
+        if (projCoords.x < 0.0 || projCoords.x > 1.0 ||
+            projCoords.y < 0.0 || projCoords.y > 1.0 ||
+            projCoords.z < 0.0 || projCoords.z > 1.0)
+        {
+            continue;
+        }
 
+        float currentDepth = projCoords.z;
+        float closestDepth = texture(shadowMap, vec3(projCoords.xy, float(cascade))).r;
 
-    float bias = 0.005;
-    float shadow = currentDepth - bias > closestDepth ? 1.0 : 0.0;
-    return shadow;
+        float bias = cascadeDepthBias[cascade];
+        float shadow = (currentDepth - bias > closestDepth) ? 1.0 : 0.0;
+        return shadow;
+    }
+    return 0.0;
 }
 
 void main() 
@@ -45,8 +55,7 @@ void main()
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0);
     vec3 specular = spec * lightColor;
 
-    vec4 fragPosLightSpace = lightSpaceMatrix * vec4(fragPosition, 1.0);
-    float shadow = ShadowCalculation(fragPosLightSpace);
+    float shadow = ShadowCalculation(fragPosition);
 
     vec3 color = (1.0 - shadow) * (diffuse + specular);
     color += 0.2 * lightColor * (1.0 - shadow);
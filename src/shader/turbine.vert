@@ -3,16 +3,35 @@
 layout(location = 0) in vec3 aPos;            
 layout(location = 1) in vec3 aNormal;         
 layout(location = 2) in vec2 aTexCoords;      
-layout(location = 3) in mat4 instanceMatrix;  
+// Index of this instance's matrix in instanceMatrices (four texels per matrix)
+layout(location = 3) in uint instanceIndex;
+uniform samplerBuffer instanceMatrices;
 
 out vec3 fragPosition;   
 out vec3 fragNormal;     
 
+// Frame constants shared by every program (render/frame_uniforms.h)
+layout(std140) uniform FrameUniforms {
+    mat4 vpMatrix;
+    mat4 lightSpaceMatrices[4];
+    vec4 cascadeDepthBias;
+    vec3 lightDir;
+    vec3 lightColor;
+    vec3 viewPos;
+};
+
 uniform mat4 model;
-uniform mat4 vpMatrix;
+
+mat4 fetchInstanceMatrix() {
+    int base = int(instanceIndex) * 4;
+    return mat4(texelFetch(instanceMatrices, base),
+                texelFetch(instanceMatrices, base + 1),
+                texelFetch(instanceMatrices, base + 2),
+                texelFetch(instanceMatrices, base + 3));
+}
 
 void main() {
-    mat4 worldMatrix = instanceMatrix * model;
+    mat4 worldMatrix = fetchInstanceMatrix() * model;
     vec4 worldPos = worldMatrix * vec4(aPos, 1.0);
 
     fragPosition = worldPos.xyz;
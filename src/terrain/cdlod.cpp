@@ -0,0 +1,110 @@
+#include "cdlod.h"
+
+#include <cmath>
+
+namespace {
+
+struct SelectionContext
+{
+	const CdlodSettings& settings;
+	glm::vec3 camera;
+	const std::function<bool(const CdlodNode&)>& isResident;
+	std::vector<CdlodSelectedNode>& selection;
+	std::vector<CdlodNode>& missing;
+};
+
+bool NodeIntersectsSphere(const CdlodSettings& settings, const CdlodNode& node, const glm::vec3& center, float radius)
+{
+	float size = CdlodNodeSize(settings, node.level);
+	glm::vec3 boxMin(node.x * size, settings.minHeight, node.z * size);
+	glm::vec3 boxMax(boxMin.x + size, settings.maxHeight, boxMin.z + size);
+
+	glm::vec3 closest = glm::clamp(center, boxMin, boxMax);
+	glm::vec3 offset = closest - center;
+	return glm::dot(offset, offset) <= radius * radius;
+}
+
+void AddNode(SelectionContext& context, const CdlodNode& node, unsigned char quadrantMask)
+{
+	CdlodSelectedNode selected;
+	selected.node = node;
+	selected.quadrantMask = quadrantMask;
+	selected.morphRange = CdlodMorphRange(context.settings, node.level);
+	context.selection.push_back(selected);
+}
+
+// Returns false when the node was not used, leaving its area to the parent
+bool SelectNode(SelectionContext& context, const CdlodNode& node)
+{
+	if (!NodeIntersectsSphere(context.settings, node, context.camera, CdlodLevelRange(context.settings, node.level)))
+		return false;
+
+	if (!context.isResident(node))
+	{
+		context.missing.push_back(node);
+		return false;
+	}
+
+	if (node.level == 0 ||
+		!NodeIntersectsSphere(context.settings, node, context.camera, CdlodLevelRange(context.settings, node.level - 1)))
+	{
+		AddNode(context, node, CDLOD_ALL_QUADRANTS);
+		return true;
+	}
+
+	unsigned char quadrantMask = 0;
+	for (int quadrant = 0; quadrant < 4; ++quadrant)
+	{
+		CdlodNode child = { node.level - 1, node.x * 2 + (quadrant & 1), node.z * 2 + (quadrant >> 1) };
+		if (!SelectNode(context, child))
+			quadrantMask |= 1 << quadrant;
+	}
+
+	if (quadrantMask)
+		AddNode(context, node, quadrantMask);
+	return true;
+}
+
+} // namespace
+
+float CdlodNodeSize(const CdlodSettings& settings, int level)
+{
+	return std::ldexp(settings.leafNodeSize, level);
+}
+
+float CdlodLevelRange(const CdlodSettings& settings, int level)
+{
+	return std::ldexp(settings.leafRange, level);
+}
+
+glm::vec2 CdlodMorphRange(const CdlodSettings& settings, int level)
+{
+	float rangeEnd = CdlodLevelRange(settings, level);
+	float rangeBegin = level > 0 ? CdlodLevelRange(settings, level - 1) : 0.0f;
+	return glm::vec2(rangeBegin + (rangeEnd - rangeBegin) * settings.morphStartRatio, rangeEnd);
+}
+
+void SelectCdlodNodes(const CdlodSettings& settings, const glm::vec3& camera,
+	const std::function<bool(const CdlodNode&)>& isResident,
+	std::vector<CdlodSelectedNode>& selection, std::vector<CdlodNode>& missing)
+{
+	SelectionContext context = { settings, camera, isResident, selection, missing };
+
+	const int rootLevel = settings.levelCount - 1;
+	const float rootSize = CdlodNodeSize(settings, rootLevel);
+	const float rootRange = CdlodLevelRange(settings, rootLevel);
+
+	int minX = static_cast<int>(std::floor((camera.x - rootRange) / rootSize));
+	int maxX = static_cast<int>(std::floor((camera.x + rootRange) / rootSize));
+	int minZ = static_cast<int>(std::floor((camera.z - rootRange) / rootSize));
+	int maxZ = static_cast<int>(std::floor((camera.z + rootRange) / rootSize));
+
+	for (int z = minZ; z <= maxZ; ++z)
+	{
+		for (int x = minX; x <= maxX; ++x)
+		{
+			CdlodNode root = { rootLevel, x, z };
+			SelectNode(context, root);
+		}
+	}
+}
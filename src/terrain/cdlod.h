@@ -0,0 +1,55 @@
+#ifndef _CDLOD_H_
+#define _CDLOD_H_
+
+#include <glm/glm.hpp>
+#include <functional>
+#include <vector>
+
+// Quadtree layout for continuous-LOD (CDLOD) terrain. A node at `level` covers
+// the square [x, x+1) * size by [z, z+1) * size, where size doubles per level
+// and level 0 is the finest. Every node is drawn with the same grid mesh, so a
+// node's triangle count is fixed and its detail follows from its size.
+struct CdlodSettings
+{
+	int levelCount;
+	float leafNodeSize;      // world size of a level 0 node
+	float leafRange;         // level 0 LOD range; every level doubles it
+	float morphStartRatio;   // where in its range band a level starts morphing, in [0, 1)
+	float minHeight;
+	float maxHeight;
+};
+
+struct CdlodNode
+{
+	int level;
+	int x;
+	int z;
+};
+
+// A node picked for drawing. Bit i of quadrantMask is set when child quadrant i
+// (x + (i & 1), z + (i >> 1) at level - 1) is drawn by this node; the other
+// quadrants are covered by finer nodes.
+struct CdlodSelectedNode
+{
+	CdlodNode node;
+	unsigned char quadrantMask;
+	glm::vec2 morphRange;    // camera distances where morphing starts and completes
+};
+
+const unsigned char CDLOD_ALL_QUADRANTS = 0xF;
+
+float CdlodNodeSize(const CdlodSettings& settings, int level);
+float CdlodLevelRange(const CdlodSettings& settings, int level);
+glm::vec2 CdlodMorphRange(const CdlodSettings& settings, int level);
+
+// Walks the quadtree from the roots around `camera` and appends the nodes to
+// draw. A node is refined while its children are within their LOD range and
+// resident; a child that is wanted but not resident is added to `missing` and
+// its quadrant is drawn by the parent instead, so streaming only costs detail.
+// The walk does not descend below a missing node, so only the coarsest
+// missing nodes are listed.
+void SelectCdlodNodes(const CdlodSettings& settings, const glm::vec3& camera,
+	const std::function<bool(const CdlodNode&)>& isResident,
+	std::vector<CdlodSelectedNode>& selection, std::vector<CdlodNode>& missing);
+
+#endif
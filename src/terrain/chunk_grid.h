@@ -0,0 +1,107 @@
+#ifndef _CHUNK_GRID_H_
+#define _CHUNK_GRID_H_
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+// Active-chunk container keyed by chunk coordinate. Cells form a torus of
+// `dimension` x `dimension` (coordinates wrap modulo the dimension), so any
+// window of at most `dimension` chunks per side maps each chunk to its own
+// cell. A cell stores the index of its chunk in a dense array, giving O(1)
+// lookup, insert and evict while iteration only touches live chunks.
+// T needs int members chunkX and chunkZ.
+template <typename T>
+class ChunkGrid
+{
+public:
+	typedef typename std::vector<T>::iterator iterator;
+	typedef typename std::vector<T>::const_iterator const_iterator;
+
+	explicit ChunkGrid(int dimension = 1) { Reset(dimension); }
+
+	// Drops all chunks and resizes the torus.
+	void Reset(int dimension)
+	{
+		this->dimension = dimension;
+		cells.assign(dimension * dimension, -1);
+		chunks.clear();
+	}
+
+	int Dimension() const { return dimension; }
+	size_t size() const { return chunks.size(); }
+	bool empty() const { return chunks.empty(); }
+
+	iterator begin() { return chunks.begin(); }
+	iterator end() { return chunks.end(); }
+	const_iterator begin() const { return chunks.begin(); }
+	const_iterator end() const { return chunks.end(); }
+
+	T* Find(int chunkX, int chunkZ)
+	{
+		int index = cells[Cell(chunkX, chunkZ)];
+		if (index < 0 || chunks[index].chunkX != chunkX || chunks[index].chunkZ != chunkZ)
+			return nullptr;
+		return &chunks[index];
+	}
+
+	const T* Find(int chunkX, int chunkZ) const
+	{
+		return const_cast<ChunkGrid*>(this)->Find(chunkX, chunkZ);
+	}
+
+	// Chunk currently occupying the cell a coordinate maps to, whatever its
+	// own coordinate is (it may be a chunk one torus period away).
+	T* Occupant(int chunkX, int chunkZ)
+	{
+		int index = cells[Cell(chunkX, chunkZ)];
+		return index < 0 ? nullptr : &chunks[index];
+	}
+
+	// Fails if the cell is occupied; the caller evicts the occupant first.
+	bool Insert(T&& chunk)
+	{
+		int& cell = cells[Cell(chunk.chunkX, chunk.chunkZ)];
+		if (cell >= 0)
+			return false;
+		cell = static_cast<int>(chunks.size());
+		chunks.push_back(std::move(chunk));
+		return true;
+	}
+
+	// Removes the chunk at a coordinate by moving the last dense entry into
+	// its place. Returns false if the chunk is not present.
+	bool Evict(int chunkX, int chunkZ)
+	{
+		int& cell = cells[Cell(chunkX, chunkZ)];
+		int index = cell;
+		if (index < 0 || chunks[index].chunkX != chunkX || chunks[index].chunkZ != chunkZ)
+			return false;
+
+		int last = static_cast<int>(chunks.size()) - 1;
+		if (index != last)
+		{
+			chunks[index] = std::move(chunks[last]);
+			cells[Cell(chunks[index].chunkX, chunks[index].chunkZ)] = index;
+		}
+		chunks.pop_back();
+		cell = -1;
+		return true;
+	}
+
+private:
+	int Cell(int chunkX, int chunkZ) const
+	{
+		int x = chunkX % dimension;
+		int z = chunkZ % dimension;
+		if (x < 0) x += dimension;
+		if (z < 0) z += dimension;
+		return z * dimension + x;
+	}
+
+	int dimension;
+	std::vector<int> cells;
+	std::vector<T> chunks;
+};
+
+#endif
@@ -0,0 +1,194 @@
+#include "height_query.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+// Same decoding as terrain.vert
+glm::vec3 DecodeNormal(const signed char* octNormal)
+{
+	glm::vec2 oct(octNormal[0] / 127.0f, octNormal[1] / 127.0f);
+	return glm::normalize(glm::vec3(oct.x, 1.0f - std::fabs(oct.x) - std::fabs(oct.y), oct.y));
+}
+
+// Step of the finite-difference normal on the noise fallback
+const float FALLBACK_NORMAL_STEP = 0.5f;
+
+} // namespace
+
+TerrainHeightQuery::TerrainHeightQuery(float chunkSize, FallbackHeight fallback)
+	: chunkSize(chunkSize), fallback(fallback), residentQueries(0), fallbackQueries(0)
+{
+}
+
+void TerrainHeightQuery::AddTile(int chunkX, int chunkZ, HeightTile&& tile)
+{
+	std::shared_ptr<const HeightTile> shared = std::make_shared<HeightTile>(std::move(tile));
+
+	long long key = Key(chunkX, chunkZ);
+	Shard& shard = ShardFor(key);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	shard.tiles[key] = shared;
+}
+
+void TerrainHeightQuery::RemoveTile(int chunkX, int chunkZ)
+{
+	long long key = Key(chunkX, chunkZ);
+	Shard& shard = ShardFor(key);
+
+	// Readers holding the tile keep it alive; it is freed outside the lock
+	std::shared_ptr<const HeightTile> removed;
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		auto it = shard.tiles.find(key);
+		if (it == shard.tiles.end())
+			return;
+		removed.swap(it->second);
+		shard.tiles.erase(it);
+	}
+}
+
+void TerrainHeightQuery::Clear()
+{
+	for (int i = 0; i < SHARD_COUNT; ++i)
+	{
+		std::lock_guard<std::mutex> lock(shards[i].mutex);
+		shards[i].tiles.clear();
+	}
+}
+
+float TerrainHeightQuery::Height(float x, float z, glm::vec3* normal) const
+{
+	int chunkX = static_cast<int>(std::floor(x / chunkSize));
+	int chunkZ = static_cast<int>(std::floor(z / chunkSize));
+
+	std::shared_ptr<const HeightTile> tile = FindTile(chunkX, chunkZ);
+	if (!tile)
+	{
+		fallbackQueries++;
+		return SampleFallback(x, z, normal);
+	}
+
+	residentQueries++;
+	return SampleHeightTile(*tile, x - chunkX * chunkSize, z - chunkZ * chunkSize, normal);
+}
+
+void TerrainHeightQuery::Heights(const float* x, const float* z, float* heights, glm::vec3* normals, int count) const
+{
+	std::shared_ptr<const HeightTile> tile;
+	int tileX = 0, tileZ = 0;
+	bool looked = false;
+	unsigned long long resident = 0;
+
+	for (int i = 0; i < count; ++i)
+	{
+		int chunkX = static_cast<int>(std::floor(x[i] / chunkSize));
+		int chunkZ = static_cast<int>(std::floor(z[i] / chunkSize));
+		if (!looked || chunkX != tileX || chunkZ != tileZ)
+		{
+			tile = FindTile(chunkX, chunkZ);
+			tileX = chunkX;
+			tileZ = chunkZ;
+			looked = true;
+		}
+
+		glm::vec3* normal = normals ? &normals[i] : nullptr;
+		if (tile)
+		{
+			heights[i] = SampleHeightTile(*tile, x[i] - chunkX * chunkSize, z[i] - chunkZ * chunkSize, normal);
+			resident++;
+		}
+		else
+		{
+			heights[i] = SampleFallback(x[i], z[i], normal);
+		}
+	}
+
+	residentQueries += resident;
+	fallbackQueries += count - resident;
+}
+
+long long TerrainHeightQuery::Key(int chunkX, int chunkZ) const
+{
+	return (static_cast<long long>(chunkX) << 32) | static_cast<unsigned int>(chunkZ);
+}
+
+TerrainHeightQuery::Shard& TerrainHeightQuery::ShardFor(long long key) const
+{
+	unsigned long long mixed = static_cast<unsigned long long>(key) * 0x9E3779B97F4A7C15ULL;
+	return shards[mixed >> 60];
+}
+
+std::shared_ptr<const HeightTile> TerrainHeightQuery::FindTile(int chunkX, int chunkZ) const
+{
+	long long key = Key(chunkX, chunkZ);
+	Shard& shard = ShardFor(key);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	auto it = shard.tiles.find(key);
+	return it != shard.tiles.end() ? it->second : std::shared_ptr<const HeightTile>();
+}
+
+// Interpolates over the cell's triangle as the chunk index buffer splits it:
+// (x,z) (x,z+1) (x+1,z) and (x+1,z) (x,z+1) (x+1,z+1), i.e. along the
+// diagonal from the top-right to the bottom-left corner.
+float SampleHeightTile(const HeightTile& tile, float localX, float localZ, glm::vec3* normal)
+{
+	const unsigned int rowLength = tile.gridSize + 1;
+
+	float gridX = glm::clamp(localX / tile.gridScale, 0.0f, static_cast<float>(tile.gridSize));
+	float gridZ = glm::clamp(localZ / tile.gridScale, 0.0f, static_cast<float>(tile.gridSize));
+	unsigned int cellX = std::min(static_cast<unsigned int>(gridX), tile.gridSize - 1);
+	unsigned int cellZ = std::min(static_cast<unsigned int>(gridZ), tile.gridSize - 1);
+	float u = gridX - cellX;
+	float v = gridZ - cellZ;
+
+	unsigned int topLeft = cellZ * rowLength + cellX;
+	unsigned int topRight = topLeft + 1;
+	unsigned int bottomLeft = topLeft + rowLength;
+	unsigned int bottomRight = bottomLeft + 1;
+
+	// Corner weights; in the second triangle the far corner is bottomRight
+	unsigned int corners[3];
+	float weights[3];
+	if (u + v <= 1.0f)
+	{
+		corners[0] = topLeft;    weights[0] = 1.0f - u - v;
+		corners[1] = topRight;   weights[1] = u;
+		corners[2] = bottomLeft; weights[2] = v;
+	}
+	else
+	{
+		corners[0] = bottomRight; weights[0] = u + v - 1.0f;
+		corners[1] = topRight;    weights[1] = 1.0f - v;
+		corners[2] = bottomLeft;  weights[2] = 1.0f - u;
+	}
+
+	float height = 0.0f;
+	glm::vec3 blended(0.0f);
+	for (int i = 0; i < 3; ++i)
+	{
+		float cornerHeight = tile.heightMin + tile.heights[corners[i]] / 65535.0f * tile.heightRange;
+		height += weights[i] * cornerHeight;
+		if (normal)
+			blended += weights[i] * DecodeNormal(&tile.normals[corners[i] * 2]);
+	}
+
+	if (normal)
+		*normal = glm::normalize(blended);
+	return height;
+}
+
+float TerrainHeightQuery::SampleFallback(float x, float z, glm::vec3* normal) const
+{
+	float height = fallback(x, z);
+
+	if (normal)
+	{
+		const float step = FALLBACK_NORMAL_STEP;
+		float dx = fallback(x - step, z) - fallback(x + step, z);
+		float dz = fallback(x, z - step) - fallback(x, z + step);
+		*normal = glm::normalize(glm::vec3(dx, 2.0f * step, dz));
+	}
+	return height;
+}
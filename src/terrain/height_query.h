@@ -0,0 +1,81 @@
+#ifndef _HEIGHT_QUERY_H_
+#define _HEIGHT_QUERY_H_
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Full-resolution samples of one resident chunk in the GPU's quantised form:
+// (gridSize+1)^2 row-major 16-bit heights over [heightMin, heightMin + heightRange]
+// and hemi-octahedral normals as (x, z) signed byte pairs.
+struct HeightTile
+{
+	unsigned int gridSize;
+	float gridScale;
+	float heightMin;
+	float heightRange;
+	std::vector<unsigned short> heights;
+	std::vector<signed char> normals;
+};
+
+// Height (and, when normal is not null, the shading normal) at a position
+// relative to the tile's corner, interpolated over the same two triangles per
+// cell the chunk mesh is drawn with. Positions outside the tile are clamped.
+float SampleHeightTile(const HeightTile& tile, float localX, float localZ, glm::vec3* normal = nullptr);
+
+// Terrain height and normal lookups for gameplay and placement code. Chunks
+// that are resident answer from their HeightTile, interpolated over the same
+// two triangles per cell the chunk mesh is drawn with, so a query lands
+// exactly on the rendered LOD0 surface. Anywhere else the fallback (noise)
+// is evaluated. Every method may be called from any thread: tiles are
+// immutable and shared, and each shard of the tile map has its own lock.
+class TerrainHeightQuery
+{
+public:
+	typedef std::function<float(float x, float z)> FallbackHeight;
+
+	TerrainHeightQuery(float chunkSize, FallbackHeight fallback);
+
+	// Makes a chunk's samples queryable, replacing any older tile for it.
+	void AddTile(int chunkX, int chunkZ, HeightTile&& tile);
+	void RemoveTile(int chunkX, int chunkZ);
+	void Clear();
+
+	// normal may be null. The normal is the interpolated vertex normal the
+	// terrain is shaded with, or a finite-difference normal on the fallback.
+	float Height(float x, float z, glm::vec3* normal = nullptr) const;
+
+	// Batched Height: consecutive positions in the same chunk share one tile
+	// lookup. normals may be null.
+	void Heights(const float* x, const float* z, float* heights, glm::vec3* normals, int count) const;
+
+	unsigned long long ResidentQueries() const { return residentQueries; }
+	unsigned long long FallbackQueries() const { return fallbackQueries; }
+
+private:
+	static const int SHARD_COUNT = 16;
+
+	struct Shard
+	{
+		mutable std::mutex mutex;
+		std::unordered_map<long long, std::shared_ptr<const HeightTile>> tiles;
+	};
+
+	long long Key(int chunkX, int chunkZ) const;
+	Shard& ShardFor(long long key) const;
+	std::shared_ptr<const HeightTile> FindTile(int chunkX, int chunkZ) const;
+
+	float SampleFallback(float x, float z, glm::vec3* normal) const;
+
+	float chunkSize;
+	FallbackHeight fallback;
+	mutable Shard shards[SHARD_COUNT];
+	mutable std::atomic<unsigned long long> residentQueries;
+	mutable std::atomic<unsigned long long> fallbackQueries;
+};
+
+#endif
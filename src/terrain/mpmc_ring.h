@@ -0,0 +1,114 @@
+#ifndef _MPMC_RING_H_
+#define _MPMC_RING_H_
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+// Bounded lock-free multi-producer/multi-consumer ring (Dmitry Vyukov's
+// sequence-numbered design). Each cell's sequence number tells producers
+// and consumers whether it is free or filled for their lap, so a push or
+// pop is one CAS on the shared position plus one release store. Values are
+// moved in and out. Capacity is rounded up to a power of two.
+template <typename T>
+class MpmcRing
+{
+public:
+	explicit MpmcRing(size_t capacity)
+	{
+		size_t size = 2;
+		while (size < capacity)
+			size <<= 1;
+
+		mask = size - 1;
+		cells = std::vector<Cell>(size);
+		for (size_t i = 0; i < size; ++i)
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		enqueuePos.store(0, std::memory_order_relaxed);
+		dequeuePos.store(0, std::memory_order_relaxed);
+	}
+
+	size_t Capacity() const { return mask + 1; }
+
+	// Returns false, leaving `value` untouched, when the ring is full.
+	bool TryPush(T&& value)
+	{
+		size_t pos = enqueuePos.load(std::memory_order_relaxed);
+		Cell* cell;
+		while (true)
+		{
+			cell = &cells[pos & mask];
+			size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			std::ptrdiff_t difference = (std::ptrdiff_t)sequence - (std::ptrdiff_t)pos;
+			if (difference == 0)
+			{
+				if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (difference < 0)
+				return false;
+			else
+				pos = enqueuePos.load(std::memory_order_relaxed);
+		}
+
+		cell->value = std::move(value);
+		cell->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Returns false when the ring is empty.
+	bool TryPop(T& value)
+	{
+		size_t pos = dequeuePos.load(std::memory_order_relaxed);
+		Cell* cell;
+		while (true)
+		{
+			cell = &cells[pos & mask];
+			size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			std::ptrdiff_t difference = (std::ptrdiff_t)sequence - (std::ptrdiff_t)(pos + 1);
+			if (difference == 0)
+			{
+				if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (difference < 0)
+				return false;
+			else
+				pos = dequeuePos.load(std::memory_order_relaxed);
+		}
+
+		value = std::move(cell->value);
+		cell->value = T();
+		cell->sequence.store(pos + mask + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		T value;
+
+		Cell() : sequence(0), value() {}
+		Cell(Cell&& other) : sequence(other.sequence.load(std::memory_order_relaxed)), value(std::move(other.value)) {}
+		Cell& operator=(Cell&& other)
+		{
+			sequence.store(other.sequence.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			value = std::move(other.value);
+			return *this;
+		}
+	};
+
+	// Producers and consumers each get their own cache line
+	char padding0[64];
+	std::vector<Cell> cells;
+	size_t mask;
+	char padding1[64];
+	std::atomic<size_t> enqueuePos;
+	char padding2[64];
+	std::atomic<size_t> dequeuePos;
+	char padding3[64];
+};
+
+#endif
@@ -0,0 +1,217 @@
+#include "rtin.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <mutex>
+
+namespace {
+
+// Triangles whose corners all lie inside the bounds take part in an error pass
+struct TileBounds
+{
+	int minX, minZ, maxX, maxZ;
+};
+
+// Hypotenuse a-b and right-angle corner c of bintree triangle `index`; 0 and 1
+// are the two roots split along the (0,0)-(gridSize,gridSize) diagonal, and a
+// triangle's children follow all triangles of its level.
+void TriangleCorners(int gridSize, unsigned int index, int& ax, int& az, int& bx, int& bz, int& cx, int& cz)
+{
+	unsigned int id = index + 2;
+	ax = az = bx = bz = cx = cz = 0;
+	if (id & 1)
+	{
+		bx = bz = cx = gridSize;
+	}
+	else
+	{
+		ax = az = cz = gridSize;
+	}
+
+	while ((id >>= 1) > 1)
+	{
+		int mx = (ax + bx) >> 1;
+		int mz = (az + bz) >> 1;
+		if (id & 1)
+		{
+			bx = ax; bz = az;
+			ax = cx; az = cz;
+		}
+		else
+		{
+			ax = bx; az = bz;
+			bx = cx; bz = cz;
+		}
+		cx = mx; cz = mz;
+	}
+}
+
+// Corners of every bintree triangle as (ax, az, bx, bz, cx, cz), built once per
+// grid size and shared by all threads; the error passes walk it many times
+const std::vector<unsigned short>& TriangleTable(int gridSize)
+{
+	static std::mutex tablesMutex;
+	static std::map<int, std::vector<unsigned short>> tables;
+
+	std::lock_guard<std::mutex> lock(tablesMutex);
+	std::vector<unsigned short>& table = tables[gridSize];
+	if (table.empty())
+	{
+		const unsigned int triangleCount = gridSize * gridSize * 2 - 2;
+		table.resize(triangleCount * 6);
+		for (unsigned int i = 0; i < triangleCount; ++i)
+		{
+			int corners[6];
+			TriangleCorners(gridSize, i, corners[0], corners[1], corners[2], corners[3], corners[4], corners[5]);
+			std::copy(corners, corners + 6, &table[i * 6]);
+		}
+	}
+	return table;
+}
+
+bool OnTileEdge(int gridSize, int x, int z)
+{
+	return x == 0 || z == 0 || x == gridSize || z == gridSize;
+}
+
+// Martini's bottom-up pass: every hypotenuse midpoint takes the interpolation
+// error at that point and the errors of its children, finest level first, so
+// a vertex's error bounds every vertex that depends on it. Existing values in
+// `errors` are kept as lower bounds. edgeErrors (may be null) collects the
+// largest tile-edge vertex error the same way.
+void AccumulateErrors(const float* heights, int rowStride, int gridSize, const TileBounds& bounds,
+	float* errors, float* edgeErrors)
+{
+	const int rowLength = gridSize + 1;
+	const unsigned int smallestTriangles = gridSize * gridSize;
+	const unsigned int triangleCount = smallestTriangles * 2 - 2;
+	const unsigned int lastLevelStart = triangleCount - smallestTriangles;
+	const std::vector<unsigned short>& table = TriangleTable(gridSize);
+
+	for (unsigned int i = triangleCount; i-- > 0;)
+	{
+		const unsigned short* corners = &table[i * 6];
+		int ax = corners[0], az = corners[1], bx = corners[2], bz = corners[3], cx = corners[4], cz = corners[5];
+
+		if (std::min(std::min(ax, bx), cx) < bounds.minX || std::max(std::max(ax, bx), cx) > bounds.maxX ||
+			std::min(std::min(az, bz), cz) < bounds.minZ || std::max(std::max(az, bz), cz) > bounds.maxZ)
+			continue;
+
+		int mx = (ax + bx) >> 1;
+		int mz = (az + bz) >> 1;
+		int middle = mz * rowLength + mx;
+
+		float interpolated = 0.5f * (heights[az * rowStride + ax] + heights[bz * rowStride + bx]);
+		float error = std::max(errors[middle], std::fabs(interpolated - heights[mz * rowStride + mx]));
+
+		float edgeError = edgeErrors ? edgeErrors[middle] : 0.0f;
+		if (i < lastLevelStart)
+		{
+			int leftChild = ((az + cz) >> 1) * rowLength + ((ax + cx) >> 1);
+			int rightChild = ((bz + cz) >> 1) * rowLength + ((bx + cx) >> 1);
+			error = std::max(error, std::max(errors[leftChild], errors[rightChild]));
+			if (edgeErrors)
+				edgeError = std::max(edgeError, std::max(edgeErrors[leftChild], edgeErrors[rightChild]));
+		}
+		errors[middle] = error;
+
+		if (edgeErrors)
+		{
+			if (OnTileEdge(gridSize, mx, mz))
+				edgeError = std::max(edgeError, error);
+			edgeErrors[middle] = edgeError;
+		}
+	}
+}
+
+// Whether the edge vertex at distance t along its edge is always kept
+bool EdgeVertexForced(int gridSize, int t)
+{
+	int segment = 2 * (t & -t);
+	return segment > (int)RTIN_EDGE_SEGMENT ||
+		t < (int)RTIN_CORNER_GUARD || t > gridSize - (int)RTIN_CORNER_GUARD;
+}
+
+void EmitTriangle(const RtinErrorMap& map, float maxError, float edgeMaxError,
+	int ax, int az, int bx, int bz, int cx, int cz, std::vector<unsigned int>& indices)
+{
+	const int rowLength = map.gridSize + 1;
+	int mx = (ax + bx) >> 1;
+	int mz = (az + bz) >> 1;
+
+	if (std::abs(ax - cx) + std::abs(az - cz) > 1)
+	{
+		int middle = mz * rowLength + mx;
+		if (map.errors[middle] > maxError || map.edgeErrors[middle] > edgeMaxError)
+		{
+			EmitTriangle(map, maxError, edgeMaxError, cx, cz, ax, az, mx, mz, indices);
+			EmitTriangle(map, maxError, edgeMaxError, bx, bz, cx, cz, mx, mz, indices);
+			return;
+		}
+	}
+
+	// Counter-clockwise seen from +Y, like the regular grid
+	bool counterClockwise = (bz - az) * (cx - ax) - (bx - ax) * (cz - az) > 0;
+	indices.push_back(az * rowLength + ax);
+	indices.push_back(counterClockwise ? bz * rowLength + bx : cz * rowLength + cx);
+	indices.push_back(counterClockwise ? cz * rowLength + cx : bz * rowLength + bx);
+}
+
+} // namespace
+
+void BuildRtinErrorMap(const float* heights, unsigned int rowStride, unsigned int gridSize, RtinErrorMap& map)
+{
+	const int size = static_cast<int>(gridSize);
+	const int rowLength = size + 1;
+	const int stride = static_cast<int>(rowStride);
+	const int apron = static_cast<int>(RTIN_APRON);
+
+	map.gridSize = gridSize;
+	map.errors.assign(rowLength * rowLength, 0.0f);
+	map.edgeErrors.assign(rowLength * rowLength, 0.0f);
+
+	// West, east, north and south neighbour: its origin relative to this tile,
+	// the band of it along the shared edge, and which of its edges is shared
+	struct Neighbour
+	{
+		int offsetX, offsetZ;
+		TileBounds band;
+		int ownEdge, theirEdge;     // x (or z) of the shared edge in this tile and in the neighbour
+		bool alongZ;                // the shared edge runs along z
+	};
+	const Neighbour neighbours[4] = {
+		{ -size, 0, { size - apron, 0, size, size }, 0, size, true },
+		{ size, 0, { 0, 0, apron, size }, size, 0, true },
+		{ 0, -size, { 0, size - apron, size, size }, 0, size, false },
+		{ 0, size, { 0, 0, size, apron }, size, 0, false },
+	};
+
+	const float forced = std::numeric_limits<float>::infinity();
+	std::vector<float> neighbourErrors(rowLength * rowLength);
+
+	for (const Neighbour& neighbour : neighbours)
+	{
+		std::fill(neighbourErrors.begin(), neighbourErrors.end(), 0.0f);
+		AccumulateErrors(heights + neighbour.offsetZ * stride + neighbour.offsetX, stride, size,
+			neighbour.band, neighbourErrors.data(), nullptr);
+
+		for (int t = 1; t < size; ++t)
+		{
+			int own = neighbour.alongZ ? t * rowLength + neighbour.ownEdge : neighbour.ownEdge * rowLength + t;
+			int theirs = neighbour.alongZ ? t * rowLength + neighbour.theirEdge : neighbour.theirEdge * rowLength + t;
+			map.errors[own] = EdgeVertexForced(size, t) ? forced : neighbourErrors[theirs];
+		}
+	}
+
+	TileBounds whole = { 0, 0, size, size };
+	AccumulateErrors(heights, stride, size, whole, map.errors.data(), map.edgeErrors.data());
+}
+
+void BuildRtinMesh(const RtinErrorMap& map, float maxError, float edgeMaxError, std::vector<unsigned int>& indices)
+{
+	const int size = static_cast<int>(map.gridSize);
+	EmitTriangle(map, maxError, edgeMaxError, 0, 0, size, size, size, 0, indices);
+	EmitTriangle(map, maxError, edgeMaxError, size, size, 0, 0, 0, size, indices);
+}
@@ -0,0 +1,46 @@
+#ifndef _RTIN_H_
+#define _RTIN_H_
+
+#include <vector>
+
+// Right-triangulated irregular network (RTIN) meshing of one square terrain
+// tile, after Martini: the tile is a bintree of right triangles, split at the
+// midpoint of their hypotenuse. A vertex's error is the height error of
+// leaving it out, raised to at least the error of every vertex that depends on
+// it, so a mesh for tolerance E that splits every triangle whose hypotenuse
+// midpoint has an error above E is always conforming.
+//
+// Tile edges are shared with the neighbouring tiles, so their vertices are
+// decided by both sides: an edge vertex takes the larger of its error in this
+// tile and in the neighbour (read from the apron), and vertices whose edge
+// segment is longer than RTIN_EDGE_SEGMENT or that lie within
+// RTIN_CORNER_GUARD of a corner are always kept. Both tiles then keep exactly
+// the same edge vertices and the seam has no T-junctions.
+
+// Longest edge segment left to the error test
+const unsigned int RTIN_EDGE_SEGMENT = 8;
+// Edge vertices this close to a corner are always kept
+const unsigned int RTIN_CORNER_GUARD = 8;
+// Samples of neighbouring terrain the heights must carry beyond every edge;
+// the edge vertices left to the error test depend on no farther samples
+const unsigned int RTIN_APRON = 8;
+
+struct RtinErrorMap
+{
+	unsigned int gridSize;
+	std::vector<float> errors;        // per vertex, row-major (gridSize+1)^2
+	std::vector<float> edgeErrors;    // largest tile-edge vertex error at or below each vertex
+};
+
+// `heights` points at the tile's first sample inside a block that carries
+// RTIN_APRON samples beyond every edge, `rowStride` floats per row. gridSize
+// must be a power of two of at least 2 * RTIN_CORNER_GUARD.
+void BuildRtinErrorMap(const float* heights, unsigned int rowStride, unsigned int gridSize, RtinErrorMap& map);
+
+// Appends the triangles of the mesh with interior tolerance maxError, counter-
+// clockwise seen from +Y. Edges always use edgeMaxError, so tiles meshed with
+// different maxError (distance LODs) still meet without cracks as long as
+// they share edgeMaxError.
+void BuildRtinMesh(const RtinErrorMap& map, float maxError, float edgeMaxError, std::vector<unsigned int>& indices);
+
+#endif
@@ -0,0 +1,82 @@
+#include "scatter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+unsigned long long MixBits(unsigned long long x)
+{
+	// splitmix64 finaliser
+	x += 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+// Small counter-based generator: the stream of a cell only depends on its key
+struct CellRandom
+{
+	unsigned long long state;
+
+	float Next()
+	{
+		state = MixBits(state);
+		return (state >> 40) * (1.0f / 16777216.0f);
+	}
+};
+
+CellRandom CellStream(unsigned int seed, int chunkX, int chunkZ, int cellX, int cellZ)
+{
+	unsigned long long key = MixBits(seed);
+	key = MixBits(key ^ static_cast<unsigned int>(chunkX));
+	key = MixBits(key ^ static_cast<unsigned int>(chunkZ));
+	key = MixBits(key ^ ((static_cast<unsigned long long>(cellX) << 32) | static_cast<unsigned int>(cellZ)));
+	CellRandom random = { key };
+	return random;
+}
+
+} // namespace
+
+void ScatterChunk(const HeightTile& tile, int chunkX, int chunkZ, float chunkSize, const ScatterRule& rule,
+	std::vector<ScatterInstance>& instances)
+{
+	const int cells = std::max(1, static_cast<int>(chunkSize / rule.cellSize));
+	const float cellSize = chunkSize / cells;
+	const float radius = rule.hilltopRadius;
+
+	for (int cellZ = 0; cellZ < cells; ++cellZ)
+	{
+		for (int cellX = 0; cellX < cells; ++cellX)
+		{
+			// Always draw all four numbers, so one test never shifts another's
+			CellRandom random = CellStream(rule.seed, chunkX, chunkZ, cellX, cellZ);
+			float chance = random.Next();
+			float localX = (cellX + random.Next()) * cellSize;
+			float localZ = (cellZ + random.Next()) * cellSize;
+			float yaw = rule.baseYaw + (random.Next() * 2.0f - 1.0f) * rule.yawJitter;
+
+			if (chance >= rule.probability)
+				continue;
+
+			glm::vec3 normal;
+			float height = SampleHeightTile(tile, localX, localZ, &normal);
+			if (height < rule.minHeight || height > rule.maxHeight || normal.y < rule.minNormalY)
+				continue;
+
+			if (radius > 0.0f)
+			{
+				float around = SampleHeightTile(tile, localX - radius, localZ) + SampleHeightTile(tile, localX + radius, localZ) +
+					SampleHeightTile(tile, localX, localZ - radius) + SampleHeightTile(tile, localX, localZ + radius);
+				if (height < around * 0.25f)
+					continue;
+			}
+
+			ScatterInstance instance;
+			instance.position = glm::vec3(chunkX * chunkSize + localX, height, chunkZ * chunkSize + localZ);
+			instance.normal = normal;
+			instance.yaw = yaw;
+			instances.push_back(instance);
+		}
+	}
+}
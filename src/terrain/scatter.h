@@ -0,0 +1,40 @@
+#ifndef _SCATTER_H_
+#define _SCATTER_H_
+
+#include "height_query.h"
+
+#include <glm/glm.hpp>
+#include <vector>
+
+// Deterministic object placement on one chunk. The chunk is divided into
+// square cells of cellSize; every cell holds one candidate at a jittered
+// position, drawn from a hash of (seed, chunk, cell), and the candidate is
+// kept if it passes the rule's chance, height and slope tests on the chunk's
+// HeightTile. The same chunk therefore always gets the same objects, on any
+// thread and in any load order, and neighbouring chunks never overlap.
+struct ScatterRule
+{
+	unsigned int seed;
+	float cellSize;         // world units; one candidate per cell
+	float probability;      // chance a candidate is tested at all
+	float minHeight;
+	float maxHeight;
+	float minNormalY;       // steepest slope allowed, as the normal's y
+	float hilltopRadius;    // > 0: the candidate must not be lower than the mean height this far around it
+	float baseYaw;          // radians around +Y
+	float yawJitter;        // yaw is baseYaw +- yawJitter
+};
+
+struct ScatterInstance
+{
+	glm::vec3 position;     // on the LOD0 surface
+	glm::vec3 normal;
+	float yaw;
+};
+
+// Appends the instances of `rule` on chunk (chunkX, chunkZ); tile holds that
+// chunk's samples and chunkSize is its side in world units.
+void ScatterChunk(const HeightTile& tile, int chunkX, int chunkZ, float chunkSize, const ScatterRule& rule,
+	std::vector<ScatterInstance>& instances);
+
+#endif
@@ -0,0 +1,547 @@
+#include "terrain_generator.h"
+
+#include <render/terrain_normals.h>
+#include <render/vertex_cache.h>
+#include <terrain/rtin.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+float rtinMaxError = 0.0f;
+std::atomic<unsigned int> rtinChunksMeshed(0);
+std::atomic<unsigned long long> rtinTrianglesKept(0);
+std::atomic<long long> rtinMeshingMicros(0);
+float scatterDensity = 1.0f;
+
+/*
+    ---------------------
+    getTerrainHeight
+    ---------------------
+    A quick utility for sampling the same noise function used for the terrain, 
+    allowing objects (turbines, panels) to be placed on the ground.
+*/
+
+float getTerrainHeight(float globalX, float globalZ)
+{
+    // Initialised once (thread-safe static init) and only read afterwards,
+    // so concurrent callers are fine
+    static const FastNoiseLite noise = [] {
+        FastNoiseLite terrainNoise;
+        configureTerrainNoise(terrainNoise);
+        return terrainNoise;
+    }();
+
+    // The four layers of one point fill exactly one SSE lane group
+    float sampleX[NUM_TERRAIN_NOISE_LAYERS];
+    float sampleZ[NUM_TERRAIN_NOISE_LAYERS];
+    for (int layer = 0; layer < NUM_TERRAIN_NOISE_LAYERS; ++layer) {
+        sampleX[layer] = globalX * TERRAIN_NOISE_SCALES[layer];
+        sampleZ[layer] = globalZ * TERRAIN_NOISE_SCALES[layer];
+    }
+
+    float layerNoise[NUM_TERRAIN_NOISE_LAYERS];
+    noise.GetNoiseBatchFixed<TERRAIN_NOISE_TYPE, TERRAIN_FRACTAL_TYPE, TERRAIN_NOISE_OCTAVES>(
+        sampleX, sampleZ, layerNoise, NUM_TERRAIN_NOISE_LAYERS);
+
+    return combineTerrainNoise(layerNoise);
+}
+
+/*
+    ------------------------------------------
+    configureTerrainNoise, combineTerrainNoise
+    ------------------------------------------
+    The terrain is a blend of three detail layers (low/mid/high frequency)
+    scaled by a slowly varying biome layer. Every noise sample is taken at
+    the world position multiplied by TERRAIN_NOISE_SCALES[layer].
+*/
+
+void configureTerrainNoise(FastNoiseLite& noise)
+{
+    noise.SetNoiseType(TERRAIN_NOISE_TYPE);
+    noise.SetFractalType(TERRAIN_FRACTAL_TYPE);
+    noise.SetFractalOctaves(TERRAIN_NOISE_OCTAVES);
+    noise.SetFrequency(0.02f);
+    noise.SetFractalLacunarity(2.0f);
+    noise.SetFractalGain(0.5f);
+}
+
+float combineTerrainNoise(const float* layerNoise)
+{
+    float lowFrequencyNoise  = layerNoise[0];
+    float midFrequencyNoise  = layerNoise[1];
+    float highFrequencyNoise = layerNoise[2];
+
+    float biomeFactor = (layerNoise[3] + 1.0f) * 0.5f;
+    float biomeHeightScale = glm::mix(20.0f, 60.0f, biomeFactor);
+
+    float height = ((lowFrequencyNoise * 0.5f +
+                     midFrequencyNoise * 0.3f +
+                     highFrequencyNoise * 0.2f) + 1.0f) * 0.5f 
+                     * biomeHeightScale;
+
+    return height;
+}
+
+/*
+    -------------------------
+    generateTerrain
+    -------------------------
+    Uses FastNoiseLite to generate a heightmap for a given chunk. 
+    We produce (gridSize+1)*(gridSize+1) vertices, forming a grid. 
+    Then we build the index list for triangle rendering.
+*/
+
+std::vector<Vertex> generateTerrain(unsigned int gridSize, float gridScale, float heightScale, 
+                                    std::vector<unsigned int>& indices, int chunkX, int chunkZ)
+{
+    TerrainHeightfield heightfield = sampleTerrainHeightfield(gridSize, gridScale, chunkX, chunkZ);
+    indices = buildTerrainIndices(gridSize);
+    return buildTerrainVertices(heightfield, gridScale);
+}
+
+/*
+    ---------------------------
+    sampleTerrainHeights
+    ---------------------------
+    Evaluates the terrain noise on a square block of rowLength^2 samples,
+    `spacing` apart, whose first sample sits `apron` samples before the world
+    offset on both axes. Rows are widened to rowStride, a multiple of 8
+    samples, so the noise kernel never drops to its scalar tail; the extra
+    columns are simply never read.
+*/
+
+std::vector<float> sampleTerrainHeights(float worldOffsetX, float worldOffsetZ, float spacing, int apron,
+                                        unsigned int rowLength, unsigned int& rowStride)
+{
+    FastNoiseLite noise;
+    configureTerrainNoise(noise);
+
+    // Each noise layer only depends on X along a row and Z down a column, so the
+    // sample coordinates are built once per axis and the whole block is filled
+    // by the batched (SIMD) noise entry point.
+    rowStride = (rowLength + 7) & ~7u;
+    std::vector<float> axisX(rowStride * NUM_TERRAIN_NOISE_LAYERS);
+    std::vector<float> axisZ(rowLength * NUM_TERRAIN_NOISE_LAYERS);
+    for (int i = -apron; i + apron < (int)rowStride; ++i) {
+        float globalX = worldOffsetX + i * spacing;
+        float globalZ = worldOffsetZ + i * spacing;
+        for (int layer = 0; layer < NUM_TERRAIN_NOISE_LAYERS; ++layer) {
+            axisX[layer * rowStride + (i + apron)] = globalX * TERRAIN_NOISE_SCALES[layer];
+            if (i + apron < (int)rowLength)
+                axisZ[layer * rowLength + (i + apron)] = globalZ * TERRAIN_NOISE_SCALES[layer];
+        }
+    }
+
+    std::vector<float> layerNoise(rowStride * rowLength * NUM_TERRAIN_NOISE_LAYERS);
+    for (int layer = 0; layer < NUM_TERRAIN_NOISE_LAYERS; ++layer) {
+        noise.GetNoiseGridFixed<TERRAIN_NOISE_TYPE, TERRAIN_FRACTAL_TYPE, TERRAIN_NOISE_OCTAVES>(
+            &axisX[layer * rowStride], rowStride,
+            &axisZ[layer * rowLength], rowLength,
+            &layerNoise[layer], NUM_TERRAIN_NOISE_LAYERS,
+            rowStride * NUM_TERRAIN_NOISE_LAYERS);
+    }
+
+    std::vector<float> heights(rowStride * rowLength);
+    for (unsigned int i = 0; i < rowStride * rowLength; ++i) {
+        heights[i] = combineTerrainNoise(&layerNoise[i * NUM_TERRAIN_NOISE_LAYERS]);
+    }
+
+    return heights;
+}
+
+/*
+    ---------------------------
+    sampleTerrainHeightfield
+    ---------------------------
+    Evaluates the terrain noise on a (gridSize+1)^2 grid of one chunk, plus a
+    one-sample apron around it so the central-difference normals on the chunk
+    edges see the neighbouring chunk's heights and shade without seams.
+*/
+
+TerrainHeightfield sampleTerrainHeightfield(unsigned int gridSize, float gridScale, int chunkX, int chunkZ)
+{
+    float worldOffsetX = chunkX * (float)gridSize * gridScale;
+    float worldOffsetZ = chunkZ * (float)gridSize * gridScale;
+
+    const unsigned int rowLength = gridSize + 1;
+    unsigned int paddedStride = 0;
+    std::vector<float> paddedHeights = sampleTerrainHeights(worldOffsetX, worldOffsetZ, gridScale, 1,
+                                                            rowLength + 2, paddedStride);
+
+    const float* interior = &paddedHeights[paddedStride + 1];
+
+    TerrainHeightfield heightfield;
+    heightfield.gridSize = gridSize;
+    heightfield.heights.resize(rowLength * rowLength);
+    for (unsigned int z = 0; z < rowLength; ++z) {
+        std::copy(interior + z * paddedStride, interior + z * paddedStride + rowLength,
+                  heightfield.heights.begin() + z * rowLength);
+    }
+
+    heightfield.normals.resize(rowLength * rowLength);
+    ComputeTerrainNormals(interior, paddedStride, gridSize, gridScale, heightfield.normals.data());
+
+    return heightfield;
+}
+
+/*
+    -----------------------
+    decimateHeightfield
+    -----------------------
+    Builds a coarser LOD by keeping every step-th sample of a finer heightfield.
+    Normals are carried over from the finer grid, so lighting detail survives.
+    The kept samples sit on exactly the world positions a direct noise
+    evaluation at the coarse grid would use, so the result is identical to
+    regenerating it, and chunk borders still line up with every neighbour.
+*/
+
+TerrainHeightfield decimateHeightfield(const TerrainHeightfield& source, unsigned int step)
+{
+    TerrainHeightfield coarse;
+    coarse.gridSize = source.gridSize / step;
+
+    const unsigned int sourceRow = source.gridSize + 1;
+    const unsigned int coarseRow = coarse.gridSize + 1;
+    coarse.heights.resize(coarseRow * coarseRow);
+    coarse.normals.resize(coarseRow * coarseRow);
+
+    for (unsigned int z = 0; z < coarseRow; ++z) {
+        for (unsigned int x = 0; x < coarseRow; ++x) {
+            coarse.heights[z * coarseRow + x] = source.heights[(z * step) * sourceRow + x * step];
+            coarse.normals[z * coarseRow + x] = source.normals[(z * step) * sourceRow + x * step];
+        }
+    }
+
+    return coarse;
+}
+
+/*
+    -----------------------
+    buildTerrainVertices
+    -----------------------
+    Turns a heightfield into grid vertices, local to the chunk.
+*/
+
+std::vector<Vertex> buildTerrainVertices(const TerrainHeightfield& heightfield, float gridScale)
+{
+    const unsigned int gridSize = heightfield.gridSize;
+
+    std::vector<Vertex> vertices;
+    vertices.reserve((gridSize + 1) * (gridSize + 1));
+
+    for (unsigned int z = 0; z <= gridSize; ++z) {
+        for (unsigned int x = 0; x <= gridSize; ++x) {
+            float localX = x * gridScale;
+            float localZ = z * gridScale;
+
+            float height = heightfield.heights[z * (gridSize + 1) + x];
+
+            Vertex vertex;
+            vertex.Position = glm::vec3(localX, height, localZ);
+            vertex.Normal = heightfield.normals[z * (gridSize + 1) + x];
+            vertex.TexCoords = glm::vec2((float)x / gridSize, (float)z / gridSize);
+
+            vertices.push_back(vertex);
+        }
+    }
+
+    return vertices;
+}
+
+/*
+    ------------------------------
+    buildCompactTerrainVertices
+    ------------------------------
+    Same grid as buildTerrainVertices, but in the 4-byte GPU layout that
+    terrain.vert expands again. Positions and UVs are implied by the vertex index.
+*/
+
+std::vector<TerrainVertex> buildCompactTerrainVertices(const TerrainHeightfield& heightfield)
+{
+    std::vector<TerrainVertex> vertices;
+    vertices.reserve(heightfield.heights.size());
+
+    for (size_t i = 0; i < heightfield.heights.size(); ++i) {
+        vertices.push_back(packTerrainVertex(heightfield.heights[i], heightfield.normals[i]));
+    }
+
+    return vertices;
+}
+
+/*
+    ---------------------
+    packTerrainVertex
+    ---------------------
+    Quantises a height to 16 bits over the fixed terrain range and packs an
+    upward-facing normal as hemi-octahedral (x, z) in two signed bytes.
+*/
+
+TerrainVertex packTerrainVertex(float height, const glm::vec3& normal)
+{
+    float t = (height - TERRAIN_HEIGHT_MIN) / (TERRAIN_HEIGHT_MAX - TERRAIN_HEIGHT_MIN);
+    t = glm::clamp(t, 0.0f, 1.0f);
+
+    glm::vec3 n = normal / (std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z));
+
+    TerrainVertex vertex;
+    vertex.height = static_cast<unsigned short>(t * 65535.0f + 0.5f);
+    vertex.normalOct[0] = static_cast<signed char>(std::floor(glm::clamp(n.x, -1.0f, 1.0f) * 127.0f + 0.5f));
+    vertex.normalOct[1] = static_cast<signed char>(std::floor(glm::clamp(n.z, -1.0f, 1.0f) * 127.0f + 0.5f));
+    return vertex;
+}
+
+/*
+    ----------------------
+    buildTerrainIndices
+    ----------------------
+    Triangle list for a (gridSize+1)^2 vertex grid, two triangles per cell in row order.
+*/
+
+std::vector<unsigned int> buildTerrainIndices(unsigned int gridSize)
+{
+    std::vector<unsigned int> indices;
+    indices.reserve(gridSize * gridSize * 6);
+    for (unsigned int z = 0; z < gridSize; ++z) {
+        for (unsigned int x = 0; x < gridSize; ++x) {
+            unsigned int topLeft = z * (gridSize + 1) + x;
+            unsigned int topRight = topLeft + 1;
+            unsigned int bottomLeft = (z + 1) * (gridSize + 1) + x;
+            unsigned int bottomRight = bottomLeft + 1;
+
+            indices.push_back(topLeft);
+            indices.push_back(bottomLeft);
+            indices.push_back(topRight);
+
+            indices.push_back(topRight);
+            indices.push_back(bottomLeft);
+            indices.push_back(bottomRight);
+        }
+    }
+
+    return indices;
+}
+
+/*
+    ----------------------------
+    terrainLODGridSize
+    ----------------------------
+    Grid resolution the vertices of a chunk LOD are laid out on, for the
+    gridSize/gridScale uniforms of terrain.vert.
+*/
+
+unsigned int terrainLODGridSize(int lod)
+{
+    return rtinMaxError > 0.0f ? RTIN_GRID_SIZE : TERRAIN_LOD_GRID_SIZES[lod];
+}
+
+/*
+    ----------------------
+    buildChunkHeightTile
+    ----------------------
+    Copies a chunk's LOD0 stream into the form terrainHeights samples, so
+    height queries see exactly the quantised values the GPU draws. RTIN
+    chunks answer from their full grid, within rtinMaxError of the mesh.
+*/
+
+HeightTile buildChunkHeightTile(const ChunkData& fullResolution)
+{
+    HeightTile tile;
+    tile.gridSize = terrainLODGridSize(0);
+    tile.gridScale = GRID_SCALE * (static_cast<float>(GRID_SIZE) / terrainLODGridSize(0));
+    tile.heightMin = TERRAIN_HEIGHT_MIN;
+    tile.heightRange = TERRAIN_HEIGHT_MAX - TERRAIN_HEIGHT_MIN;
+
+    const std::vector<TerrainVertex>& vertices = fullResolution.vertices;
+    tile.heights.resize(vertices.size());
+    tile.normals.resize(vertices.size() * 2);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        tile.heights[i] = vertices[i].height;
+        tile.normals[i * 2] = vertices[i].normalOct[0];
+        tile.normals[i * 2 + 1] = vertices[i].normalOct[1];
+    }
+
+    return tile;
+}
+
+/*
+    ----------------------
+    chunkHeightBounds
+    ----------------------
+    Decoded range (min, max) of a chunk's quantised LOD0 heights. The coarser
+    LODs are decimated from or meshed on the same samples, so it bounds them too.
+*/
+
+glm::vec2 chunkHeightBounds(const ChunkData& fullResolution)
+{
+    unsigned short low = 65535;
+    unsigned short high = 0;
+    for (const TerrainVertex& vertex : fullResolution.vertices) {
+        low = std::min(low, vertex.height);
+        high = std::max(high, vertex.height);
+    }
+    if (low > high)
+        return glm::vec2(TERRAIN_HEIGHT_MIN, TERRAIN_HEIGHT_MAX);
+
+    const float scale = (TERRAIN_HEIGHT_MAX - TERRAIN_HEIGHT_MIN) / 65535.0f;
+    return glm::vec2(TERRAIN_HEIGHT_MIN + low * scale, TERRAIN_HEIGHT_MIN + high * scale);
+}
+
+/*
+    ----------------------
+    buildChunkLODs
+    ----------------------
+    Generates every LOD vertex grid for one chunk. Safe to call from any thread.
+    Noise is only evaluated for LOD0; the coarser LODs are decimated from it.
+    Indices are not built here, every chunk uses terrainLODIndices.
+*/
+
+std::vector<ChunkData> buildChunkLODs(int x, int z)
+{
+    glm::vec2 chunkPos(
+        x * GRID_SIZE * GRID_SCALE,
+        z * GRID_SIZE * GRID_SCALE
+    );
+
+    std::vector<ChunkData> allLODData;
+    allLODData.reserve(NUM_TERRAIN_LODS);
+
+    TerrainHeightfield fullResolution = sampleTerrainHeightfield(
+        TERRAIN_LOD_GRID_SIZES[0],
+        GRID_SCALE * (static_cast<float>(GRID_SIZE) / TERRAIN_LOD_GRID_SIZES[0]),
+        x, z
+    );
+
+    for (auto lodGrid : TERRAIN_LOD_GRID_SIZES)
+    {
+        unsigned int step = TERRAIN_LOD_GRID_SIZES[0] / lodGrid;
+
+        std::vector<TerrainVertex> vertices;
+        if (step == 1)
+            vertices = buildCompactTerrainVertices(fullResolution);
+        else
+            vertices = buildCompactTerrainVertices(decimateHeightfield(fullResolution, step));
+
+        ChunkData cd;
+        cd.vertices  = std::move(vertices);
+        cd.position  = chunkPos;
+        cd.chunkX    = x;
+        cd.chunkZ    = z;
+
+        allLODData.push_back(std::move(cd));
+    }
+
+    return allLODData;
+}
+
+/*
+    ----------------------
+    buildRtinChunkLODs
+    ----------------------
+    Adaptive counterpart of buildChunkLODs for --rtin-error. Samples the chunk
+    on the RTIN_GRID_SIZE grid with RTIN_APRON samples of its neighbours, builds
+    the RTIN error map from the heights as the GPU will see them (quantised, so
+    both sides of a seam compare identical values) and meshes every LOD from
+    it. LOD0 holds the vertices, every LOD its vertex-cache ordered indices.
+    Meshing time excludes the noise and is added to the RTIN counters; it is
+    also returned through meshingMs when that is not null.
+*/
+
+std::vector<ChunkData> buildRtinChunkLODs(int x, int z, double* meshingMs)
+{
+    const float chunkSize = GRID_SIZE * GRID_SCALE;
+    const float spacing = chunkSize / RTIN_GRID_SIZE;
+    const unsigned int rowLength = RTIN_GRID_SIZE + 1;
+    const int apron = static_cast<int>(RTIN_APRON);
+
+    unsigned int rowStride = 0;
+    std::vector<float> block = sampleTerrainHeights(x * chunkSize, z * chunkSize, spacing, apron,
+                                                    rowLength + 2 * apron, rowStride);
+    const float* interior = &block[apron * rowStride + apron];
+
+    TerrainHeightfield heightfield;
+    heightfield.gridSize = RTIN_GRID_SIZE;
+    heightfield.heights.resize(rowLength * rowLength);
+    for (unsigned int row = 0; row < rowLength; ++row) {
+        std::copy(interior + row * rowStride, interior + row * rowStride + rowLength,
+                  heightfield.heights.begin() + row * rowLength);
+    }
+    heightfield.normals.resize(rowLength * rowLength);
+    ComputeTerrainNormals(interior, rowStride, RTIN_GRID_SIZE, spacing, heightfield.normals.data());
+
+    auto meshStart = std::chrono::steady_clock::now();
+
+    const float heightRange = TERRAIN_HEIGHT_MAX - TERRAIN_HEIGHT_MIN;
+    for (float& height : block) {
+        height = TERRAIN_HEIGHT_MIN + packTerrainVertex(height, glm::vec3(0.0f, 1.0f, 0.0f)).height / 65535.0f * heightRange;
+    }
+
+    RtinErrorMap errorMap;
+    BuildRtinErrorMap(interior, rowStride, RTIN_GRID_SIZE, errorMap);
+
+    std::vector<ChunkData> allLODData(NUM_TERRAIN_LODS);
+    for (int lod = 0; lod < NUM_TERRAIN_LODS; ++lod) {
+        std::vector<unsigned int> indices;
+        BuildRtinMesh(errorMap, rtinMaxError * RTIN_LOD_ERROR_SCALES[lod], rtinMaxError, indices);
+        OptimizeVertexCache(indices, rowLength * rowLength);
+
+        ChunkData& cd = allLODData[lod];
+        cd.indices.assign(indices.begin(), indices.end());
+        cd.position = glm::vec2(x * chunkSize, z * chunkSize);
+        cd.chunkX   = x;
+        cd.chunkZ   = z;
+    }
+
+    long long micros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - meshStart).count();
+    rtinChunksMeshed++;
+    rtinTrianglesKept += allLODData[0].indices.size() / 3;
+    rtinMeshingMicros += micros;
+    if (meshingMs) *meshingMs = micros / 1000.0;
+
+    allLODData[0].vertices = buildCompactTerrainVertices(heightfield);
+    return allLODData;
+}
+
+/*
+    ----------------------
+    scatterChunkObjects
+    ----------------------
+    Places one chunk's turbines and solar panels on its LOD0 height tile, so
+    they stand on the surface that is drawn, and builds their model matrices.
+    Turbines get a random heading; panels face the sun, tilted by 30 degrees.
+    Runs on the chunk workers; the result only depends on the chunk, so a
+    chunk that streams back in gets the same objects.
+*/
+
+void scatterChunkObjects(int chunkX, int chunkZ, const HeightTile& tile, std::vector<glm::mat4>& turbines, std::vector<glm::mat4>& solarPanels)
+{
+    const float chunkSize = GRID_SIZE * GRID_SCALE;
+    const float cellScale = 1.0f / std::sqrt(scatterDensity);
+
+    std::vector<ScatterInstance> placed;
+    ScatterRule rule = TURBINE_SCATTER;
+    rule.cellSize *= cellScale;
+    ScatterChunk(tile, chunkX, chunkZ, chunkSize, rule, placed);
+
+    turbines.reserve(placed.size());
+    for (const ScatterInstance& instance : placed) {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), instance.position);
+        model = glm::rotate(model, instance.yaw, glm::vec3(0, 1, 0));
+        turbines.push_back(model);
+    }
+
+    placed.clear();
+    rule = SOLAR_PANEL_SCATTER;
+    rule.cellSize *= cellScale;
+    ScatterChunk(tile, chunkX, chunkZ, chunkSize, rule, placed);
+
+    solarPanels.reserve(placed.size());
+    for (const ScatterInstance& instance : placed) {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), instance.position + glm::vec3(0.0f, SOLAR_PANEL_HEIGHT_OFFSET, 0.0f));
+        model = glm::rotate(model, instance.yaw, glm::vec3(0, 1, 0));
+        model = glm::rotate(model, glm::radians(-30.0f), glm::vec3(1, 0, 0));
+        model = glm::scale(model, glm::vec3(0.5f));
+        solarPanels.push_back(model);
+    }
+}
@@ -0,0 +1,123 @@
+#ifndef _TERRAIN_GENERATOR_H_
+#define _TERRAIN_GENERATOR_H_
+
+#include <external/FastNoiseLite.h>
+#include <terrain/height_query.h>
+#include <terrain/scatter.h>
+#include <glm/glm.hpp>
+#include <atomic>
+#include <vector>
+
+// CPU side of the terrain: noise sampling, the chunk LOD builders, height
+// tiles and the object scatter. Nothing here touches GL, so the chunk
+// workers and the headless bench target can call all of it from any thread.
+
+// Data structures for storing vertex, mesh, and object data
+struct Vertex {
+    glm::vec3 Position;
+    glm::vec3 Normal;
+    glm::vec2 TexCoords;
+};
+
+// Compact terrain vertex (4 bytes). X/Z and UV follow from the grid index and are
+// rebuilt in terrain.vert; the height is quantised to 16 bits over
+// [TERRAIN_HEIGHT_MIN, TERRAIN_HEIGHT_MAX] and the normal is hemi-octahedral.
+struct TerrainVertex {
+    unsigned short height;
+    signed char normalOct[2];
+};
+
+// RTIN chunks keep their vertices in LOD0 only (every LOD meshes the same grid)
+// and carry their own indices; regular chunks leave indices empty and use
+// terrainLODIndices.
+struct ChunkData {
+    std::vector<TerrainVertex> vertices;
+    std::vector<unsigned short> indices;
+    glm::vec2 position;
+    int chunkX;
+    int chunkZ;
+};
+
+// Row-major (gridSize+1)^2 terrain heights and normals for one chunk at one resolution
+struct TerrainHeightfield {
+    unsigned int gridSize;
+    std::vector<float> heights;
+    std::vector<glm::vec3> normals;
+};
+
+// Constants for grid size and scaling
+const unsigned int GRID_SIZE = 100;
+const float GRID_SCALE = 1.0f;
+const float HEIGHT_SCALE = 50.0f;
+
+// Terrain LOD grids: LOD0 is sampled from noise, the others are decimated from it
+const int NUM_TERRAIN_LODS = 3;
+const unsigned int TERRAIN_LOD_GRID_SIZES[NUM_TERRAIN_LODS] = { 100, 50, 25 };
+
+// Bounds of combineTerrainNoise: detail noise in [-1,1], biome scale at most 60.
+// One fixed range keeps shared chunk-border vertices quantised identically.
+const float TERRAIN_HEIGHT_MIN = 0.0f;
+const float TERRAIN_HEIGHT_MAX = 60.0f;
+
+// Terrain noise layers: low, mid and high frequency detail, then the biome mask.
+// Every layer uses the same fractal, which the hot paths evaluate through the
+// compile-time specialised FastNoiseLite kernels (GetNoise*Fixed).
+const FastNoiseLite::NoiseType TERRAIN_NOISE_TYPE = FastNoiseLite::NoiseType_OpenSimplex2;
+const FastNoiseLite::FractalType TERRAIN_FRACTAL_TYPE = FastNoiseLite::FractalType_FBm;
+const int TERRAIN_NOISE_OCTAVES = 6;
+const int NUM_TERRAIN_NOISE_LAYERS = 4;
+const float TERRAIN_NOISE_SCALES[NUM_TERRAIN_NOISE_LAYERS] = { 0.05f, 0.2f, 0.8f, 0.01f };
+
+// Adaptive chunks (--rtin-error E): every chunk is sampled on an
+// RTIN_GRID_SIZE grid (RTIN needs a power of two) and each LOD is an RTIN mesh
+// of it with an interior tolerance of E * RTIN_LOD_ERROR_SCALES[lod] world
+// units. Chunk edges always use E, so chunks meet without cracks at any mix of
+// LODs. 0 keeps the regular grids. The counters sum over every meshed chunk.
+const unsigned int RTIN_GRID_SIZE = 128;
+const float RTIN_LOD_ERROR_SCALES[NUM_TERRAIN_LODS] = { 1.0f, 4.0f, 16.0f };
+extern float rtinMaxError;
+extern std::atomic<unsigned int> rtinChunksMeshed;
+extern std::atomic<unsigned long long> rtinTrianglesKept;     // LOD0 triangles over all meshed chunks
+extern std::atomic<long long> rtinMeshingMicros;
+
+// Object scatter: the chunk workers place turbines and solar panels on each
+// chunk they build, from a hash of the chunk, so the objects follow the chunk
+// window and a chunk always gets the same ones. Turbines stand on high ground
+// of moderate slope; panels only on flat hilltops, facing the sun (which
+// shines from +X+Z). --scatter-density D scales the candidates per area.
+const ScatterRule TURBINE_SCATTER = {
+    0x5475u, 50.0f, 0.6f, 20.0f, TERRAIN_HEIGHT_MAX, 0.85f, 0.0f, 0.0f, 3.14159265f
+};
+const ScatterRule SOLAR_PANEL_SCATTER = {
+    0x50a1u, 6.0f, 1.0f, 25.0f, TERRAIN_HEIGHT_MAX, 0.97f, 8.0f, 0.78539816f, 0.05f
+};
+const float SOLAR_PANEL_HEIGHT_OFFSET = 25.0f;
+extern float scatterDensity;
+
+// - getTerrainHeight, configureTerrainNoise, combineTerrainNoise: Point samples and the shared noise setup and layer blend.
+// - sampleTerrainHeights, sampleTerrainHeightfield, decimateHeightfield, buildTerrainVertices: Heightfield pyramid stages behind generateTerrain and the chunk LODs.
+// - buildCompactTerrainVertices, packTerrainVertex: 4-byte GPU terrain stream (quantised height + packed normal).
+// - buildTerrainIndices: Triangle list of a regular LOD grid.
+// - buildChunkLODs, buildRtinChunkLODs, terrainLODGridSize: Every LOD of one chunk, regular or adaptive (RTIN).
+// - buildChunkHeightTile: A chunk's LOD0 samples in the form terrainHeights answers queries from.
+// - chunkHeightBounds: Lowest and highest LOD0 height of a chunk, for its culling box.
+// - scatterChunkObjects: Per-chunk deterministic turbine and solar panel placement.
+float getTerrainHeight(float globalX, float globalZ);
+void configureTerrainNoise(FastNoiseLite& noise);
+float combineTerrainNoise(const float* layerNoise);
+std::vector<Vertex> generateTerrain(unsigned int gridSize, float gridScale, float heightScale, std::vector<unsigned int>& indices, int chunkX, int chunkZ);
+std::vector<float> sampleTerrainHeights(float worldOffsetX, float worldOffsetZ, float spacing, int apron, unsigned int rowLength, unsigned int& rowStride);
+TerrainHeightfield sampleTerrainHeightfield(unsigned int gridSize, float gridScale, int chunkX, int chunkZ);
+TerrainHeightfield decimateHeightfield(const TerrainHeightfield& source, unsigned int step);
+std::vector<Vertex> buildTerrainVertices(const TerrainHeightfield& heightfield, float gridScale);
+std::vector<TerrainVertex> buildCompactTerrainVertices(const TerrainHeightfield& heightfield);
+TerrainVertex packTerrainVertex(float height, const glm::vec3& normal);
+std::vector<unsigned int> buildTerrainIndices(unsigned int gridSize);
+std::vector<ChunkData> buildChunkLODs(int chunkX, int chunkZ);
+std::vector<ChunkData> buildRtinChunkLODs(int chunkX, int chunkZ, double* meshingMs);
+unsigned int terrainLODGridSize(int lod);
+HeightTile buildChunkHeightTile(const ChunkData& fullResolution);
+glm::vec2 chunkHeightBounds(const ChunkData& fullResolution);
+void scatterChunkObjects(int chunkX, int chunkZ, const HeightTile& tile, std::vector<glm::mat4>& turbines, std::vector<glm::mat4>& solarPanels);
+
+#endif
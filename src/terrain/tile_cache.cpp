@@ -0,0 +1,205 @@
+#include "tile_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <functional>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <direct.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char TILE_MAGIC[4] = { 'T', 'I', 'L', 'E' };
+const unsigned int TILE_VERSION = 1;
+
+struct TileHeader
+{
+	char magic[4];
+	unsigned int version;
+	unsigned long long noiseHash;
+	int chunkX;
+	int chunkZ;
+	unsigned int lod;
+	unsigned int payloadSize;
+	unsigned long long payloadHash;
+};
+
+std::string TilePath(const std::string& directory, const TileKey& key)
+{
+	char name[96];
+	snprintf(name, sizeof(name), "/%016llx_%d_%d_%u.tile", key.noiseHash, key.chunkX, key.chunkZ, key.lod);
+	return directory + name;
+}
+
+bool HeaderMatches(const TileHeader& header, const TileKey& key, size_t payloadSize)
+{
+	return std::memcmp(header.magic, TILE_MAGIC, sizeof(TILE_MAGIC)) == 0 &&
+		header.version == TILE_VERSION &&
+		header.noiseHash == key.noiseHash &&
+		header.chunkX == key.chunkX &&
+		header.chunkZ == key.chunkZ &&
+		header.lod == key.lod &&
+		header.payloadSize == payloadSize;
+}
+
+// Read-only mapping of a whole file; empty on failure
+class MappedFile
+{
+public:
+	explicit MappedFile(const std::string& path) : data(nullptr), size(0)
+	{
+#ifdef _WIN32
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		mapping = NULL;
+		if (file == INVALID_HANDLE_VALUE)
+			return;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+			return;
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping == NULL)
+			return;
+		data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		if (data)
+			size = static_cast<size_t>(fileSize.QuadPart);
+#else
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			return;
+		struct stat info;
+		if (fstat(fd, &info) == 0 && info.st_size > 0)
+		{
+			void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mapped != MAP_FAILED)
+			{
+				data = static_cast<const unsigned char*>(mapped);
+				size = static_cast<size_t>(info.st_size);
+			}
+		}
+		close(fd);
+#endif
+	}
+
+	~MappedFile()
+	{
+#ifdef _WIN32
+		if (data)
+			UnmapViewOfFile(data);
+		if (mapping)
+			CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+#else
+		if (data)
+			munmap(const_cast<unsigned char*>(data), size);
+#endif
+	}
+
+	const unsigned char* data;
+	size_t size;
+
+private:
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+#ifdef _WIN32
+	HANDLE file;
+	HANDLE mapping;
+#endif
+};
+
+}
+
+unsigned long long HashBytes(const void* data, size_t size, unsigned long long seed)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	unsigned long long hash = seed;
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+bool CreateTileDirectory(const std::string& directory)
+{
+#ifdef _WIN32
+	if (_mkdir(directory.c_str()) == 0)
+		return true;
+	DWORD attributes = GetFileAttributesA(directory.c_str());
+	return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+	if (mkdir(directory.c_str(), 0755) == 0)
+		return true;
+	struct stat info;
+	return stat(directory.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+}
+
+bool ReadTile(const std::string& directory, const TileKey& key, void* payload, size_t payloadSize)
+{
+	MappedFile file(TilePath(directory, key));
+	if (file.size != sizeof(TileHeader) + payloadSize)
+		return false;
+
+	TileHeader header;
+	std::memcpy(&header, file.data, sizeof(header));
+	if (!HeaderMatches(header, key, payloadSize))
+		return false;
+
+	const unsigned char* body = file.data + sizeof(TileHeader);
+	if (HashBytes(body, payloadSize) != header.payloadHash)
+		return false;
+
+	std::memcpy(payload, body, payloadSize);
+	return true;
+}
+
+bool WriteTile(const std::string& directory, const TileKey& key, const void* payload, size_t payloadSize)
+{
+	TileHeader header;
+	std::memcpy(header.magic, TILE_MAGIC, sizeof(TILE_MAGIC));
+	header.version = TILE_VERSION;
+	header.noiseHash = key.noiseHash;
+	header.chunkX = key.chunkX;
+	header.chunkZ = key.chunkZ;
+	header.lod = key.lod;
+	header.payloadSize = static_cast<unsigned int>(payloadSize);
+	header.payloadHash = HashBytes(payload, payloadSize);
+
+	std::string path = TilePath(directory, key);
+
+	// Unique per writer thread so two workers baking the same tile do not collide
+	char suffix[32];
+	snprintf(suffix, sizeof(suffix), ".%zx.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+	std::string temporaryPath = path + suffix;
+
+	FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+	if (!file)
+		return false;
+
+	bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+		std::fwrite(payload, 1, payloadSize, file) == payloadSize;
+	written = (std::fclose(file) == 0) && written;
+
+#ifdef _WIN32
+	if (written && !MoveFileExA(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+		written = false;
+#else
+	if (written && std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+		written = false;
+#endif
+	if (!written)
+		std::remove(temporaryPath.c_str());
+	return written;
+}
@@ -0,0 +1,31 @@
+#ifndef _TILE_CACHE_H_
+#define _TILE_CACHE_H_
+
+#include <string>
+#include <cstddef>
+
+// Identifies one baked terrain tile. noiseHash covers every parameter that
+// affects the payload, so tiles from older settings are never picked up.
+struct TileKey
+{
+	int chunkX;
+	int chunkZ;
+	unsigned int lod;
+	unsigned long long noiseHash;
+};
+
+// 64-bit FNV-1a, chainable through `seed`.
+unsigned long long HashBytes(const void* data, size_t size, unsigned long long seed = 14695981039346656037ULL);
+
+// Creates the cache directory if needed. Returns false if it cannot be used.
+bool CreateTileDirectory(const std::string& directory);
+
+// Maps the tile file and copies its payload into `payload` when the header
+// matches `key` and the payload is exactly `payloadSize` bytes.
+bool ReadTile(const std::string& directory, const TileKey& key, void* payload, size_t payloadSize);
+
+// Writes the tile to a temporary file and renames it into place, so readers
+// on other threads or processes never see a partially written tile.
+bool WriteTile(const std::string& directory, const TileKey& key, const void* payload, size_t payloadSize);
+
+#endif